@@ -0,0 +1,25 @@
+/**************************************************************************
+ *   Created: 2026/10/19 19:07
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+namespace boost {
+
+	void assertion_failed(
+			char const *expr,
+			char const *function,
+			char const *file,
+			long line) {
+		std::cerr
+			<< "Assertion failed: \"" << expr << "\""
+			<< " in function \"" << function << "\""
+			<< " (file " << file << ":" << line << ")" << std::endl;
+	}
+
+}
@@ -0,0 +1,186 @@
+/**************************************************************************
+ *   Created: 2026/10/19 19:52
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Scenario.hpp"
+#include "Microbenchmarks.hpp"
+
+#include "Core/Log.hpp"
+
+namespace tex = TunnelEx;
+
+using namespace Benchmark;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	void XmlErrorsNull(void *, const char *, ...) {
+		//...//
+	}
+
+	template<typename T>
+	bool ParseArg(const std::string &arg, const char *name, T &result) {
+		const std::string prefix = std::string(name) + "=";
+		if (!boost::istarts_with(arg, prefix)) {
+			return false;
+		}
+		result = boost::lexical_cast<T>(arg.substr(prefix.size()));
+		return true;
+	}
+
+	void WriteResults(
+				const Settings &settings,
+				const std::vector<Result> &results,
+				const MicroSettings &microSettings,
+				const std::vector<MicroResult> &microResults,
+				std::ostream &os) {
+		os.imbue(std::locale::classic());
+		os.setf(std::ios::fixed);
+		os.precision(2);
+		os
+			<< "{" << std::endl
+			<< "\t\"version\": \"" << TUNNELEX_VERSION_FULL << "\"," << std::endl
+			<< "\t\"build\": \"" << TUNNELEX_BUILD_IDENTITY << "\"," << std::endl
+			<< "\t\"messageSize\": " << settings.messageSize << "," << std::endl
+			<< "\t\"streamSize\": " << settings.streamSize << "," << std::endl
+			<< "\t\"roundTripsNumber\": " << settings.roundTripsNumber << "," << std::endl
+			<< "\t\"microIterationsNumber\": " << microSettings.iterationsNumber << "," << std::endl
+			<< "\t\"scenarios\": [";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result &result = results[i];
+			os
+				<< (i > 0 ? "," : "") << std::endl
+				<< "\t\t{" << std::endl
+				<< "\t\t\t\"name\": \"" << result.name << "\"," << std::endl
+				<< "\t\t\t\"connections\": " << result.connectionsNumber << "," << std::endl
+				<< "\t\t\t\"setupRate\": " << result.setupRate << "," << std::endl
+				<< "\t\t\t\"throughput\": " << result.throughput << "," << std::endl
+				<< "\t\t\t\"roundTripP50\": " << result.roundTripP50 << "," << std::endl
+				<< "\t\t\t\"roundTripP99\": " << result.roundTripP99 << "," << std::endl
+				<< "\t\t\t\"errors\": " << result.errorsNumber << std::endl
+				<< "\t\t}";
+		}
+		os << std::endl << "\t]," << std::endl << "\t\"microbenchmarks\": [";
+		for (size_t i = 0; i < microResults.size(); ++i) {
+			const MicroResult &result = microResults[i];
+			os
+				<< (i > 0 ? "," : "") << std::endl
+				<< "\t\t{" << std::endl
+				<< "\t\t\t\"name\": \"" << result.name << "\"," << std::endl
+				<< "\t\t\t\"threads\": " << result.threadsNumber << "," << std::endl
+				<< "\t\t\t\"operationTime\": " << result.operationTime << "," << std::endl
+				<< "\t\t\t\"operationsRate\": " << result.operationsRate << "," << std::endl
+				<< "\t\t\t\"errors\": " << result.errorsNumber << std::endl
+				<< "\t\t}";
+		}
+		os << std::endl << "\t]" << std::endl << "}" << std::endl;
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv) {
+
+	Settings settings;
+	MicroSettings microSettings;
+	// "tunnel", "micro" or "all"
+	std::string suite = "tunnel";
+	std::string scenarioFilter;
+	std::string outputPath;
+
+	try {
+		for (auto i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			if (	!ParseArg(arg, "connections", settings.connectionsNumber)
+					&& !ParseArg(arg, "size", settings.messageSize)
+					&& !ParseArg(arg, "stream", settings.streamSize)
+					&& !ParseArg(arg, "roundtrips", settings.roundTripsNumber)
+					&& !ParseArg(arg, "iterations", microSettings.iterationsNumber)
+					&& !ParseArg(arg, "threads", microSettings.maxThreadsNumber)
+					&& !ParseArg(arg, "suite", suite)
+					&& !ParseArg(arg, "scenario", scenarioFilter)
+					&& !ParseArg(arg, "output", outputPath)) {
+				std::cerr << "Unknown argument \"" << arg << "\"." << std::endl;
+				return 1;
+			}
+		}
+	} catch (const boost::bad_lexical_cast &) {
+		std::cerr << "Wrong argument value." << std::endl;
+		return 1;
+	}
+	if (settings.connectionsNumber == 0 || settings.messageSize == 0) {
+		std::cerr << "Connections number and message size can't be zero." << std::endl;
+		return 1;
+	}
+	if (microSettings.iterationsNumber == 0 || microSettings.maxThreadsNumber == 0) {
+		std::cerr << "Iterations and threads numbers can't be zero." << std::endl;
+		return 1;
+	}
+	const bool isTunnelSuite
+		= boost::iequals(suite, "tunnel") || boost::iequals(suite, "all");
+	const bool isMicroSuite
+		= boost::iequals(suite, "micro") || boost::iequals(suite, "all");
+	if (!isTunnelSuite && !isMicroSuite) {
+		std::cerr << "Unknown suite \"" << suite << "\"." << std::endl;
+		return 1;
+	}
+
+	// benchmark measures data path, not logging
+	tex::Log::GetInstance().SetMinimumRegistrationLevel(tex::LOG_LEVEL_ERROR);
+	OpenSSL_add_all_algorithms();
+	xmlInitParser();
+	tex::Helpers::Xml::SetErrorsHandler(&XmlErrorsNull);
+
+	std::vector<Result> results;
+	if (isTunnelSuite) {
+		boost::ptr_vector<Scenario> scenarios;
+		CreateScenarios(scenarios);
+		foreach (const Scenario &scenario, scenarios) {
+			if (	!scenarioFilter.empty()
+					&& !boost::iequals(scenario.GetName(), scenarioFilter)) {
+				continue;
+			}
+			std::cerr << "Running \"" << scenario.GetName() << "\"..." << std::endl;
+			results.push_back(scenario.Run(settings));
+		}
+	}
+
+	std::vector<MicroResult> microResults;
+	if (isMicroSuite) {
+		RunMicrobenchmarks(microSettings, scenarioFilter, microResults);
+	}
+
+	if (outputPath.empty()) {
+		WriteResults(settings, results, microSettings, microResults, std::cout);
+	} else {
+		std::ofstream f(outputPath.c_str(), std::ios::trunc);
+		if (!f) {
+			std::cerr << "Failed to open \"" << outputPath << "\"." << std::endl;
+			return 1;
+		}
+		WriteResults(settings, results, microSettings, microResults, f);
+	}
+
+	EVP_cleanup();
+
+	size_t errorsNumber = 0;
+	foreach (const Result &result, results) {
+		errorsNumber += result.errorsNumber;
+	}
+	foreach (const MicroResult &result, microResults) {
+		errorsNumber += result.errorsNumber;
+	}
+	return errorsNumber == 0 ? 0 : 2;
+
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,469 @@
+/**************************************************************************
+ *   Created: 2026/10/19 21:20
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Microbenchmark.hpp"
+
+#include "Core/MessagesAllocator.hpp"
+#include "Core/MessageBlockHolder.hpp"
+#include "Core/MessageBlocksLatencyStat.hpp"
+#include "Core/TunnelConnectionSignal.hpp"
+#include "Core/Locking.hpp"
+#include "Core/String.hpp"
+#include "Core/Exceptions.hpp"
+
+using namespace TunnelEx;
+using namespace Benchmark;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Allocator as connection creates it for default data block size.
+	boost::shared_ptr<MessagesAllocator> CreateAllocator(size_t threadsNumber) {
+		// each thread holds not more than one block at the same time
+		const auto blocksNumber = threadsNumber + 1;
+		return boost::shared_ptr<MessagesAllocator>(
+			new MessagesAllocator(
+				blocksNumber + 1,
+				blocksNumber,
+				UniqueMessageBlockHolder::GetMessageMemorySize(
+					MessagesAllocator::DefautDataBlockSize)));
+	}
+
+	//! Creates message block for each thread.
+	void CreateMessages(
+				size_t threadsNumber,
+				const boost::shared_ptr<MessagesAllocator> &allocator,
+				boost::ptr_vector<UniqueMessageBlockHolder> &result) {
+		boost::ptr_vector<UniqueMessageBlockHolder> messages;
+		for (size_t i = 0; i < threadsNumber; ++i) {
+			messages.push_back(
+				new UniqueMessageBlockHolder(
+					UniqueMessageBlockHolder::Create(
+						MessagesAllocator::DefautDataBlockSize,
+						allocator,
+						false)));
+			messages.back().SetReceivingStartTimePoint();
+			messages.back().SetReceivingTimePoint();
+			messages.back().SetSendingStartTimePoint();
+			messages.back().SetSendingTimePoint();
+		}
+		messages.swap(result);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class MessageBlockCreateDelete : public Microbenchmark {
+	public:
+		virtual const char * GetName() const throw() {
+			return "UniqueMessageBlockHolder Create/Delete";
+		}
+		virtual void Prepare(size_t threadsNumber) {
+			m_allocator = CreateAllocator(threadsNumber);
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				ACE_Message_Block *const message = UniqueMessageBlockHolder::Create(
+					MessagesAllocator::DefautDataBlockSize,
+					m_allocator,
+					false);
+				if (!message) {
+					throw InsufficientMemoryException(
+						L"Failed to allocate message block for microbenchmark");
+				}
+				UniqueMessageBlockHolder::Delete(*message);
+			}
+		}
+		virtual void Cleanup() throw() {
+			m_allocator.reset();
+		}
+	private:
+		boost::shared_ptr<MessagesAllocator> m_allocator;
+	};
+
+	class MessagesAllocatorMessageBlocks : public Microbenchmark {
+	public:
+		virtual const char * GetName() const throw() {
+			return "MessagesAllocator message blocks pool";
+		}
+		virtual void Prepare(size_t threadsNumber) {
+			m_allocator = CreateAllocator(threadsNumber);
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			auto &pool = m_allocator->GetMessageBlocksAllocator();
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				void *const block = pool.malloc(sizeof(ACE_Message_Block));
+				if (!block) {
+					throw InsufficientMemoryException(
+						L"Failed to allocate message block for microbenchmark");
+				}
+				pool.free(block);
+			}
+		}
+		virtual void Cleanup() throw() {
+			m_allocator.reset();
+		}
+	private:
+		boost::shared_ptr<MessagesAllocator> m_allocator;
+	};
+
+	class MessagesAllocatorDataBuffers : public Microbenchmark {
+	public:
+		virtual const char * GetName() const throw() {
+			return "MessagesAllocator data buffers pool";
+		}
+		virtual void Prepare(size_t threadsNumber) {
+			m_allocator = CreateAllocator(threadsNumber);
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			auto &pool = m_allocator->GetDataBlocksBufferAllocator();
+			const auto size = m_allocator->GetDataBlockSize();
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				void *const buffer = pool.malloc(size);
+				if (!buffer) {
+					throw InsufficientMemoryException(
+						L"Failed to allocate data buffer for microbenchmark");
+				}
+				pool.free(buffer);
+			}
+		}
+		virtual void Cleanup() throw() {
+			m_allocator.reset();
+		}
+	private:
+		boost::shared_ptr<MessagesAllocator> m_allocator;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Tunnel and its server for the new message block signal.
+	/** Real tunnel requires server and connections, the signal uses only
+	  * tunnel closing.
+	  */
+	class TunnelDouble : private boost::noncopyable {
+	public:
+		TunnelDouble()
+				: m_closesNumber(0) {
+			//...//
+		}
+	public:
+		TunnelDouble & GetServer() {
+			return *this;
+		}
+		Instance::Id GetInstanceId() const {
+			return 0;
+		}
+		void CloseTunnel(Instance::Id) {
+			Interlocked::Increment(m_closesNumber);
+		}
+		long GetClosesNumber() const {
+			return m_closesNumber;
+		}
+	private:
+		volatile long m_closesNumber;
+	};
+
+	//! Measures the same signal, that TunnelConnectionSignal::OnNewMessageBlock
+	//! calls.
+	class TunnelConnectionSignalDispatch : public Microbenchmark {
+	public:
+		typedef boost::signals2::signal<
+				TunnelConnectionSignal::OnNewMessageBlockSlotSignature,
+				MessageBlockHandlingCombiner<TunnelDouble> >
+			Signal;
+	public:
+		virtual const char * GetName() const throw() {
+			return "TunnelConnectionSignal OnNewMessageBlock";
+		}
+		virtual void Prepare(size_t threadsNumber) {
+			m_tunnel.reset(new TunnelDouble);
+			m_signal.reset(
+				new Signal(MessageBlockHandlingCombiner<TunnelDouble>(*m_tunnel)));
+			m_signal->connect(&SendPacket);
+			m_allocator = CreateAllocator(threadsNumber);
+			CreateMessages(threadsNumber, m_allocator, m_messages);
+		}
+		virtual void Run(size_t threadIndex, size_t iterationsNumber) {
+			MessageBlock &message = m_messages[threadIndex];
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				(*m_signal)(message);
+			}
+			if (m_tunnel->GetClosesNumber() != 0) {
+				throw LogicalException(
+					L"Tunnel has been closed by microbenchmark signal");
+			}
+		}
+		virtual void Cleanup() throw() {
+			m_signal.reset();
+			m_tunnel.reset();
+			m_messages.clear();
+			m_allocator.reset();
+		}
+	private:
+		static DataTransferCommand SendPacket(MessageBlock &) {
+			return DATA_TRANSFER_CMD_SEND_PACKET;
+		}
+	private:
+		std::unique_ptr<TunnelDouble> m_tunnel;
+		std::unique_ptr<Signal> m_signal;
+		boost::shared_ptr<MessagesAllocator> m_allocator;
+		boost::ptr_vector<UniqueMessageBlockHolder> m_messages;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class SpinMutexLock : public Microbenchmark {
+	public:
+		SpinMutexLock()
+				: m_counter(0) {
+			//...//
+		}
+		virtual const char * GetName() const throw() {
+			return "SpinMutex";
+		}
+		virtual void Prepare(size_t) {
+			m_counter = 0;
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				const Lock<SpinMutex> lock(m_mutex);
+				++m_counter;
+			}
+		}
+		virtual void Cleanup() throw() {
+			//...//
+		}
+	private:
+		SpinMutex m_mutex;
+		volatile size_t m_counter;
+	};
+
+	class ReadWriteSpinMutexRead : public Microbenchmark {
+	public:
+		ReadWriteSpinMutexRead()
+				: m_value(0),
+				m_sum(0) {
+			//...//
+		}
+		virtual const char * GetName() const throw() {
+			return "ReadWriteSpinMutex read";
+		}
+		virtual void Prepare(size_t) {
+			//...//
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			size_t sum = 0;
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				const ReadLock<ReadWriteSpinMutex> lock(m_mutex);
+				sum += m_value;
+			}
+			m_sum = sum;
+		}
+		virtual void Cleanup() throw() {
+			//...//
+		}
+	private:
+		ReadWriteSpinMutex m_mutex;
+		volatile size_t m_value;
+		volatile size_t m_sum;
+	};
+
+	class ReadWriteSpinMutexWrite : public Microbenchmark {
+	public:
+		ReadWriteSpinMutexWrite()
+				: m_counter(0) {
+			//...//
+		}
+		virtual const char * GetName() const throw() {
+			return "ReadWriteSpinMutex write";
+		}
+		virtual void Prepare(size_t) {
+			m_counter = 0;
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				const WriteLock<ReadWriteSpinMutex> lock(m_mutex);
+				++m_counter;
+			}
+		}
+		virtual void Cleanup() throw() {
+			//...//
+		}
+	private:
+		ReadWriteSpinMutex m_mutex;
+		volatile size_t m_counter;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class InterlockedIncrement : public Microbenchmark {
+	public:
+		InterlockedIncrement()
+				: m_counter(0) {
+			//...//
+		}
+		virtual const char * GetName() const throw() {
+			return "Interlocked Increment";
+		}
+		virtual void Prepare(size_t) {
+			m_counter = 0;
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				Interlocked::Increment(m_counter);
+			}
+		}
+		virtual void Cleanup() throw() {
+			//...//
+		}
+	private:
+		volatile long m_counter;
+	};
+
+	class InterlockedExchangeAdd : public Microbenchmark {
+	public:
+		InterlockedExchangeAdd()
+				: m_counter(0) {
+			//...//
+		}
+		virtual const char * GetName() const throw() {
+			return "Interlocked ExchangeAdd 64";
+		}
+		virtual void Prepare(size_t) {
+			m_counter = 0;
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				Interlocked::ExchangeAdd(m_counter, 1024);
+			}
+		}
+		virtual void Cleanup() throw() {
+			//...//
+		}
+	private:
+		volatile long long m_counter;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class ConvertWStringToUString : public Microbenchmark {
+	public:
+		ConvertWStringToUString()
+				: m_source(L"tcp://tunnelex-benchmark.example.com:22331") {
+			//...//
+		}
+		virtual const char * GetName() const throw() {
+			return "ConvertString WString to UString";
+		}
+		virtual void Prepare(size_t) {
+			//...//
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			UString destination;
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				ConvertString(m_source, destination);
+			}
+		}
+		virtual void Cleanup() throw() {
+			//...//
+		}
+	private:
+		const WString m_source;
+	};
+
+	class ConvertUStringToString : public Microbenchmark {
+	public:
+		ConvertUStringToString() {
+			ConvertString(L"tcp://tunnelex-benchmark.example.com:22331", m_source);
+		}
+		virtual const char * GetName() const throw() {
+			return "ConvertString UString to String";
+		}
+		virtual void Prepare(size_t) {
+			//...//
+		}
+		virtual void Run(size_t, size_t iterationsNumber) {
+			String destination;
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				ConvertString(m_source, destination);
+			}
+		}
+		virtual void Cleanup() throw() {
+			//...//
+		}
+	private:
+		UString m_source;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class LatencyStatAccumulate : public Microbenchmark {
+	public:
+		virtual const char * GetName() const throw() {
+			return "MessageBlocksLatencyStat Accumulate";
+		}
+		virtual void Prepare(size_t threadsNumber) {
+			// period is long enough to not start new one during the run
+			m_stat.reset(new MessageBlocksLatencyStat(0, 60 * 60));
+			m_allocator = CreateAllocator(threadsNumber);
+			CreateMessages(threadsNumber, m_allocator, m_messages);
+		}
+		virtual void Run(size_t threadIndex, size_t iterationsNumber) {
+			const auto &message = m_messages[threadIndex];
+			for (size_t i = 0; i < iterationsNumber; ++i) {
+				m_stat->Accumulate(message, 50.0);
+			}
+		}
+		virtual void Cleanup() throw() {
+			m_stat.reset();
+			m_messages.clear();
+			m_allocator.reset();
+		}
+	private:
+		std::unique_ptr<MessageBlocksLatencyStat> m_stat;
+		boost::shared_ptr<MessagesAllocator> m_allocator;
+		boost::ptr_vector<UniqueMessageBlockHolder> m_messages;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+Microbenchmark::Microbenchmark() {
+	//...//
+}
+
+Microbenchmark::~Microbenchmark() throw() {
+	//...//
+}
+
+void Benchmark::CreateMicrobenchmarks(boost::ptr_vector<Microbenchmark> &result) {
+	boost::ptr_vector<Microbenchmark> microbenchmarks;
+	microbenchmarks.push_back(new MessageBlockCreateDelete);
+	microbenchmarks.push_back(new MessagesAllocatorMessageBlocks);
+	microbenchmarks.push_back(new MessagesAllocatorDataBuffers);
+	microbenchmarks.push_back(new TunnelConnectionSignalDispatch);
+	microbenchmarks.push_back(new SpinMutexLock);
+	microbenchmarks.push_back(new ReadWriteSpinMutexRead);
+	microbenchmarks.push_back(new ReadWriteSpinMutexWrite);
+	microbenchmarks.push_back(new InterlockedIncrement);
+	microbenchmarks.push_back(new InterlockedExchangeAdd);
+	microbenchmarks.push_back(new ConvertWStringToUString);
+	microbenchmarks.push_back(new ConvertUStringToString);
+	microbenchmarks.push_back(new LatencyStatAccumulate);
+	microbenchmarks.swap(result);
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,55 @@
+/**************************************************************************
+ *   Created: 2026/10/19 21:14
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__Microbenchmark_hpp__2610192114
+#define INCLUDED_FILE__TUNNELEX__Microbenchmark_hpp__2610192114
+
+namespace Benchmark {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Microbenchmark of the core hot-path primitive.
+	/** Most of the measured primitives are not exported from the core, so
+	  * its sources are built into the benchmark. The runner calls Prepare,
+	  * then Run concurrently from each of the threads and then Cleanup.
+	  */
+	class Microbenchmark {
+
+	public:
+
+		Microbenchmark();
+		virtual ~Microbenchmark() throw();
+
+	private:
+
+		Microbenchmark(const Microbenchmark &);
+		const Microbenchmark & operator =(const Microbenchmark &);
+
+	public:
+
+		virtual const char * GetName() const throw() = 0;
+
+		//! Creates state, shared by all threads of the run.
+		virtual void Prepare(size_t threadsNumber) = 0;
+		//! Executes iterations in the thread with given index.
+		virtual void Run(size_t threadIndex, size_t iterationsNumber) = 0;
+		//! Destroys state, created by Prepare.
+		virtual void Cleanup() throw() = 0;
+
+	};
+
+	//! Creates all microbenchmarks in fixed order.
+	void CreateMicrobenchmarks(
+			boost::ptr_vector<Microbenchmark> &);
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__Microbenchmark_hpp__2610192114
@@ -0,0 +1,137 @@
+/**************************************************************************
+ *   Created: 2026/10/19 21:52
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Microbenchmarks.hpp"
+#include "Microbenchmark.hpp"
+#include "Stopwatch.hpp"
+
+#include "Core/String.hpp"
+#include "Core/Exceptions.hpp"
+
+namespace tex = TunnelEx;
+
+using namespace Benchmark;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	void ReportError(const Microbenchmark &microbenchmark, const char *what) {
+		std::cerr
+			<< "Microbenchmark \"" << microbenchmark.GetName() << "\" error: "
+			<< what << "." << std::endl;
+	}
+
+	void RunThread(
+				Microbenchmark &microbenchmark,
+				size_t threadIndex,
+				size_t iterationsNumber,
+				boost::barrier &start,
+				size_t &errorsNumber) {
+		start.wait();
+		try {
+			microbenchmark.Run(threadIndex, iterationsNumber);
+		} catch (const tex::LocalException &ex) {
+			ReportError(
+				microbenchmark,
+				tex::ConvertString<tex::String>(ex.GetWhat()).GetCStr());
+			++errorsNumber;
+		} catch (const std::exception &ex) {
+			ReportError(microbenchmark, ex.what());
+			++errorsNumber;
+		}
+	}
+
+	MicroResult Run(
+				Microbenchmark &microbenchmark,
+				size_t threadsNumber,
+				const MicroSettings &settings) {
+
+		MicroResult result;
+		result.name = microbenchmark.GetName();
+		result.threadsNumber = threadsNumber;
+
+		try {
+			microbenchmark.Prepare(threadsNumber);
+			// warming up caches and pools before measuring
+			for (size_t i = 0; i < threadsNumber; ++i) {
+				microbenchmark.Run(
+					i,
+					std::max<size_t>(1, settings.iterationsNumber / 100));
+			}
+		} catch (const tex::LocalException &ex) {
+			ReportError(
+				microbenchmark,
+				tex::ConvertString<tex::String>(ex.GetWhat()).GetCStr());
+			microbenchmark.Cleanup();
+			++result.errorsNumber;
+			return result;
+		}
+
+		std::vector<size_t> errors(threadsNumber, 0);
+		// all threads start together, the main thread releases them
+		boost::barrier start(threadsNumber + 1);
+		boost::thread_group threads;
+		for (size_t i = 0; i < threadsNumber; ++i) {
+			threads.create_thread(
+				boost::bind(
+					&RunThread,
+					boost::ref(microbenchmark),
+					i,
+					settings.iterationsNumber,
+					boost::ref(start),
+					boost::ref(errors[i])));
+		}
+		start.wait();
+		Stopwatch stopwatch;
+		threads.join_all();
+		const auto time = stopwatch.GetMicroseconds();
+
+		microbenchmark.Cleanup();
+
+		foreach (size_t threadErrors, errors) {
+			result.errorsNumber += threadErrors;
+		}
+		if (settings.iterationsNumber > 0 && time > 0) {
+			result.operationTime = time * 1000 / settings.iterationsNumber;
+			result.operationsRate
+				= double(settings.iterationsNumber * threadsNumber) * 1000000 / time;
+		}
+
+		return result;
+
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void Benchmark::RunMicrobenchmarks(
+			const MicroSettings &settings,
+			const std::string &filter,
+			std::vector<MicroResult> &result) {
+	boost::ptr_vector<Microbenchmark> microbenchmarks;
+	CreateMicrobenchmarks(microbenchmarks);
+	foreach (Microbenchmark &microbenchmark, microbenchmarks) {
+		if (	!filter.empty()
+				&& !boost::icontains(std::string(microbenchmark.GetName()), filter)) {
+			continue;
+		}
+		std::cerr << "Running \"" << microbenchmark.GetName() << "\"..." << std::endl;
+		for (	size_t threadsNumber = 1;
+				threadsNumber <= settings.maxThreadsNumber;
+				threadsNumber *= 2) {
+			result.push_back(Run(microbenchmark, threadsNumber, settings));
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
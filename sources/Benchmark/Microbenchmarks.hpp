@@ -0,0 +1,66 @@
+/**************************************************************************
+ *   Created: 2026/10/19 21:45
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__Microbenchmarks_hpp__2610192145
+#define INCLUDED_FILE__TUNNELEX__Microbenchmarks_hpp__2610192145
+
+namespace Benchmark {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct MicroSettings {
+
+		MicroSettings()
+				: iterationsNumber(1000000),
+				maxThreadsNumber(
+					std::max<size_t>(1, boost::thread::hardware_concurrency())) {
+			//...//
+		}
+
+		//! Iterations number for each thread.
+		size_t iterationsNumber;
+		//! Each microbenchmark runs with 1, 2, 4... threads up to this number.
+		size_t maxThreadsNumber;
+
+	};
+
+	struct MicroResult {
+
+		MicroResult()
+				: threadsNumber(0),
+				operationTime(0),
+				operationsRate(0),
+				errorsNumber(0) {
+			//...//
+		}
+
+		std::string name;
+		size_t threadsNumber;
+		//! Nanoseconds per one operation in one thread.
+		double operationTime;
+		//! Operations per second, all threads.
+		double operationsRate;
+		size_t errorsNumber;
+
+	};
+
+	//! Runs core primitives microbenchmarks.
+	/** Each microbenchmark runs with 1 thread and then with contention by
+	  * increasing threads number.
+	  */
+	void RunMicrobenchmarks(
+			const MicroSettings &,
+			const std::string &filter,
+			std::vector<MicroResult> &);
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__Microbenchmarks_hpp__2610192145
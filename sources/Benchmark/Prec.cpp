@@ -0,0 +1,10 @@
+/**************************************************************************
+ *   Created: 2026/10/19 19:05
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
@@ -0,0 +1,62 @@
+/**************************************************************************
+ *   Created: 2026/10/19 19:05
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__Prec_h__2610191905
+#define INCLUDED_FILE__Prec_h__2610191905
+
+#include "CompileConfig.h"
+#include "Constants.h"
+#include "LocalAssert.hpp"
+
+#include "Xml.hpp"
+#include "Format.hpp"
+
+#include "Licensing/Prec.h"
+
+#include <Winsock2.h>
+
+#include "CompileWarningsAce.h"
+#	include <ace/Guard_T.h>
+#	include <ace/Thread_Mutex.h>
+#	include <ace/Null_Mutex.h>
+#	include <ace/Message_Block.h>
+#	include <ace/Malloc_T.h>
+#	include <ace/Singleton.h>
+#include "CompileWarningsAce.h"
+
+#include "CompileWarningsBoost.h"
+#	include <boost/shared_ptr.hpp>
+#	include <boost/function.hpp>
+#	include <boost/bind.hpp>
+#	include <boost/foreach.hpp>
+#	include <boost/date_time.hpp>
+#	include <boost/thread.hpp>
+#	include <boost/ptr_container/ptr_vector.hpp>
+#	include <boost/signals2.hpp>
+#	include <boost/accumulators/accumulators.hpp>
+#	include <boost/accumulators/statistics/stats.hpp>
+#	include <boost/accumulators/statistics/mean.hpp>
+#	include <boost/accumulators/statistics/min.hpp>
+#	include <boost/accumulators/statistics/max.hpp>
+#include "CompileWarningsBoost.h"
+
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#endif
+
+#include "TestUtils/Prec.h"
+
+#include "LocalAssert.hpp"
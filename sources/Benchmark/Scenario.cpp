@@ -0,0 +1,419 @@
+/**************************************************************************
+ *   Created: 2026/10/19 19:24
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Scenario.hpp"
+#include "Stopwatch.hpp"
+
+#include "TestUtils/InetServer.hpp"
+#include "TestUtils/InetClient.hpp"
+#include "TestUtils/PipeServer.hpp"
+#include "TestUtils/PipeClient.hpp"
+
+#include "Core/Server.hpp"
+#include "Core/Rule.hpp"
+#include "Core/Endpoint.hpp"
+#include "Core/SslCertificatesStorage.hpp"
+#include "Core/String.hpp"
+#include "Core/Exceptions.hpp"
+
+namespace pt = boost::posix_time;
+namespace tex = TunnelEx;
+
+using namespace Benchmark;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//! @todo: hardcoded benchmark endpoints
+	const char *const host = "127.0.0.1";
+	const unsigned short inputPort = 22331;
+	const unsigned short sslPort = 22332;
+	const unsigned short backendPort = 22333;
+	const char *const inputPipe = "TunnelExBenchmarkInput";
+	const char *const backendPipe = "TunnelExBenchmarkBackend";
+	//! Inet module magic name for generated certificate.
+	const char *const sslCertificate = "anonymous";
+
+	double GetPercentile(std::vector<double> &samples, double percentile) {
+		if (samples.empty()) {
+			return 0;
+		}
+		const size_t index = std::min(
+			samples.size() - 1,
+			size_t(double(samples.size()) * percentile / 100));
+		std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+		return samples[index];
+	}
+
+	double GetRate(double number, double microseconds) {
+		return microseconds > 0 ? number * 1000000 / microseconds : 0;
+	}
+
+	void ReportError(const std::string &scenario, const char *stage, const char *what) {
+		std::cerr
+			<< "Scenario \"" << scenario << "\" " << stage << " error: "
+			<< what << "." << std::endl;
+	}
+
+	void AppendRule(
+				tex::RuleSet &rules,
+				const std::string &input,
+				const std::string &destination) {
+		tex::TunnelRule rule;
+		tex::RuleEndpointCollection inputs(1);
+		inputs.Append(
+			tex::RuleEndpoint(
+				tex::ConvertString<tex::WString>(input.c_str()),
+				true));
+		rule.SetInputs(inputs);
+		tex::RuleEndpointCollection destinations(1);
+		destinations.Append(
+			tex::RuleEndpoint(
+				tex::ConvertString<tex::WString>(destination.c_str()),
+				false));
+		rule.SetDestinations(destinations);
+		rules.Append(rule);
+	}
+
+	std::string GetInetAddress(
+				const char *proto,
+				const char *hostName,
+				unsigned short port) {
+		std::ostringstream result;
+		result << proto << "://" << hostName << ":" << port;
+		return result.str();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class TcpScenario : public Scenario {
+	public:
+		explicit TcpScenario(const std::string &name = "tcp")
+				: Scenario(name) {
+			//...//
+		}
+		virtual ~TcpScenario() {
+			//...//
+		}
+	protected:
+		virtual void CreateRules(tex::RuleSet &rules) const {
+			AppendRule(
+				rules,
+				GetInetAddress("tcp", "*", inputPort),
+				GetInetAddress("tcp", host, backendPort));
+		}
+		virtual std::auto_ptr<TestUtil::Server> CreateServer(
+					const pt::time_duration &waitTime)
+				const {
+			std::auto_ptr<TestUtil::Server> result(
+				new TestUtil::TcpServer(backendPort, waitTime));
+			return result;
+		}
+		virtual std::auto_ptr<TestUtil::Client> CreateClient(
+					const pt::time_duration &waitTime)
+				const {
+			std::auto_ptr<TestUtil::Client> result(
+				new TestUtil::TcpClient(host, inputPort, waitTime));
+			return result;
+		}
+	};
+
+	//! Plain client, SSL between two tunnels, plain backend.
+	class SslScenario : public TcpScenario {
+	public:
+		SslScenario()
+				: TcpScenario("ssl") {
+			//...//
+		}
+		virtual ~SslScenario() {
+			//...//
+		}
+	protected:
+		virtual void CreateRules(tex::RuleSet &rules) const {
+			const std::string certificate
+				= std::string("?certificate=") + sslCertificate;
+			AppendRule(
+				rules,
+				GetInetAddress("tcp", "*", inputPort),
+				GetInetAddress("tcp", host, sslPort) + certificate);
+			AppendRule(
+				rules,
+				GetInetAddress("tcp", "*", sslPort) + certificate,
+				GetInetAddress("tcp", host, backendPort));
+		}
+	};
+
+	class UdpScenario : public Scenario {
+	public:
+		UdpScenario()
+				: Scenario("udp") {
+			//...//
+		}
+		virtual ~UdpScenario() {
+			//...//
+		}
+	protected:
+		virtual void CreateRules(tex::RuleSet &rules) const {
+			AppendRule(
+				rules,
+				GetInetAddress("udp", "*", inputPort),
+				GetInetAddress("udp", host, backendPort));
+		}
+		virtual std::auto_ptr<TestUtil::Server> CreateServer(
+					const pt::time_duration &waitTime)
+				const {
+			std::auto_ptr<TestUtil::Server> result(
+				new TestUtil::UdpServer(backendPort, waitTime));
+			return result;
+		}
+		virtual std::auto_ptr<TestUtil::Client> CreateClient(
+					const pt::time_duration &waitTime)
+				const {
+			std::auto_ptr<TestUtil::Client> result(
+				new TestUtil::UdpClient(host, inputPort, waitTime));
+			return result;
+		}
+	};
+
+	class PipeScenario : public Scenario {
+	public:
+		PipeScenario()
+				: Scenario("pipe") {
+			//...//
+		}
+		virtual ~PipeScenario() {
+			//...//
+		}
+	protected:
+		virtual void CreateRules(tex::RuleSet &rules) const {
+			AppendRule(
+				rules,
+				std::string("pipe://") + inputPipe,
+				std::string("pipe://") + backendPipe);
+		}
+		virtual std::auto_ptr<TestUtil::Server> CreateServer(
+					const pt::time_duration &waitTime)
+				const {
+			std::auto_ptr<TestUtil::Server> result(
+				new TestUtil::PipeServer(backendPipe, waitTime));
+			return result;
+		}
+		virtual std::auto_ptr<TestUtil::Client> CreateClient(
+					const pt::time_duration &waitTime)
+				const {
+			std::auto_ptr<TestUtil::Client> result(
+				new TestUtil::PipeClient(inputPipe, waitTime));
+			return result;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void Stream(
+				const std::string &scenario,
+				TestUtil::Client &client,
+				TestUtil::Server &server,
+				size_t connectionIndex,
+				const Settings &settings,
+				size_t &errorsNumber) {
+		try {
+			const size_t messagesNumber = settings.streamSize / settings.messageSize;
+			for (size_t i = 0; i < messagesNumber; ++i) {
+				client.Send(
+					std::auto_ptr<TestUtil::Buffer>(
+						new TestUtil::Buffer(settings.messageSize, 'D')));
+			}
+			TestUtil::Buffer received;
+			server.WaitAndTakeAnyData(
+				connectionIndex,
+				messagesNumber * settings.messageSize,
+				false,
+				received);
+		} catch (const std::exception &ex) {
+			ReportError(scenario, "throughput", ex.what());
+			++errorsNumber;
+		}
+	}
+
+	void RoundTrip(
+				const std::string &scenario,
+				TestUtil::Client &client,
+				TestUtil::Server &server,
+				size_t connectionIndex,
+				const Settings &settings,
+				std::vector<double> &samples,
+				size_t &errorsNumber) {
+		try {
+			samples.reserve(settings.roundTripsNumber);
+			TestUtil::Buffer received;
+			Stopwatch stopwatch;
+			for (size_t i = 0; i < settings.roundTripsNumber; ++i) {
+				stopwatch.Restart();
+				client.Send(
+					std::auto_ptr<TestUtil::Buffer>(
+						new TestUtil::Buffer(settings.messageSize, 'R')));
+				server.WaitAndTakeAnyData(
+					connectionIndex,
+					settings.messageSize,
+					true,
+					received);
+				server.Send(
+					connectionIndex,
+					std::auto_ptr<TestUtil::Buffer>(new TestUtil::Buffer(received)));
+				client.WaitAndTakeAnyData(settings.messageSize, true, received);
+				samples.push_back(stopwatch.GetMicroseconds());
+			}
+		} catch (const std::exception &ex) {
+			ReportError(scenario, "round trip", ex.what());
+			++errorsNumber;
+		}
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+Scenario::Scenario(const std::string &name)
+		: m_name(name) {
+	//...//
+}
+
+Scenario::~Scenario() {
+	//...//
+}
+
+Result Scenario::Run(const Settings &settings) const {
+
+	Result result;
+	result.name = m_name;
+	result.connectionsNumber = settings.connectionsNumber;
+
+	std::auto_ptr<TestUtil::Server> server(CreateServer(settings.waitTime));
+
+	const tex::SslCertificatesStorage certificates(L"", 0, 0);
+	try {
+		tex::RuleSet rules;
+		CreateRules(rules);
+		tex::Server::GetInstance().Start(rules, certificates);
+	} catch (const tex::LocalException &ex) {
+		ReportError(
+			m_name,
+			"start",
+			tex::ConvertString<tex::String>(ex.GetWhat()).GetCStr());
+		++result.errorsNumber;
+		return result;
+	}
+
+	boost::ptr_vector<TestUtil::Client> clients;
+
+	// connections are opened one by one, so the backend connection index
+	// is the same as the client index
+	try {
+		const std::string hello(1, 'H');
+		TestUtil::Buffer received;
+		Stopwatch stopwatch;
+		for (size_t i = 0; i < settings.connectionsNumber; ++i) {
+			clients.push_back(CreateClient(settings.waitTime).release());
+			if (!clients.back().WaitConnect(false)) {
+				throw TestUtil::Timeout();
+			}
+			clients.back().Send(hello);
+			if (!server->WaitConnect(i + 1, false)) {
+				throw TestUtil::Timeout();
+			}
+			server->WaitAndTakeAnyData(i, hello.size(), true, received);
+		}
+		result.setupRate = GetRate(
+			double(settings.connectionsNumber),
+			stopwatch.GetMicroseconds());
+	} catch (const std::exception &ex) {
+		ReportError(m_name, "setup", ex.what());
+		++result.errorsNumber;
+	}
+
+	if (clients.size() == settings.connectionsNumber) {
+
+		std::vector<size_t> errors(clients.size(), 0);
+
+		{
+			boost::thread_group threads;
+			Stopwatch stopwatch;
+			for (size_t i = 0; i < clients.size(); ++i) {
+				threads.create_thread(
+					boost::bind(
+						&Stream,
+						boost::cref(m_name),
+						boost::ref(clients[i]),
+						boost::ref(*server),
+						i,
+						boost::cref(settings),
+						boost::ref(errors[i])));
+			}
+			threads.join_all();
+			const size_t messagesNumber = settings.streamSize / settings.messageSize;
+			result.throughput = GetRate(
+				double(messagesNumber * settings.messageSize * clients.size()),
+				stopwatch.GetMicroseconds());
+		}
+
+		std::vector<std::vector<double> > samples(clients.size());
+		{
+			boost::thread_group threads;
+			for (size_t i = 0; i < clients.size(); ++i) {
+				threads.create_thread(
+					boost::bind(
+						&RoundTrip,
+						boost::cref(m_name),
+						boost::ref(clients[i]),
+						boost::ref(*server),
+						i,
+						boost::cref(settings),
+						boost::ref(samples[i]),
+						boost::ref(errors[i])));
+			}
+			threads.join_all();
+		}
+		std::vector<double> allSamples;
+		foreach (const std::vector<double> &connectionSamples, samples) {
+			allSamples.insert(
+				allSamples.end(),
+				connectionSamples.begin(),
+				connectionSamples.end());
+		}
+		result.roundTripP50 = GetPercentile(allSamples, 50);
+		result.roundTripP99 = GetPercentile(allSamples, 99);
+
+		foreach (size_t connectionErrors, errors) {
+			result.errorsNumber += connectionErrors;
+		}
+
+	}
+
+	clients.clear();
+	tex::Server::GetInstance().Stop();
+
+	return result;
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void Benchmark::CreateScenarios(boost::ptr_vector<Scenario> &result) {
+	boost::ptr_vector<Scenario> scenarios;
+	scenarios.push_back(new TcpScenario);
+	scenarios.push_back(new UdpScenario);
+	scenarios.push_back(new SslScenario);
+	scenarios.push_back(new PipeScenario);
+	scenarios.swap(result);
+}
+
+//////////////////////////////////////////////////////////////////////////
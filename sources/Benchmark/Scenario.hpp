@@ -0,0 +1,122 @@
+/**************************************************************************
+ *   Created: 2026/10/19 19:10
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__Scenario_hpp__2610191910
+#define INCLUDED_FILE__TUNNELEX__Scenario_hpp__2610191910
+
+#include "TestUtils/ClientServer.hpp"
+
+namespace TunnelEx {
+	class RuleSet;
+}
+
+namespace Benchmark {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct Settings {
+
+		Settings()
+				: connectionsNumber(16),
+				messageSize(1024),
+				streamSize(4 * 1024 * 1024),
+				roundTripsNumber(1000),
+				waitTime(0, 1, 0) {
+			//...//
+		}
+
+		//! Concurrent connections through the tunnel.
+		size_t connectionsNumber;
+		//! Size of one message for throughput and round trip.
+		size_t messageSize;
+		//! Bytes, that each connection sends for throughput measuring.
+		size_t streamSize;
+		//! Round trips number for each connection for latency measuring.
+		size_t roundTripsNumber;
+		//! Maximum time to wait one operation.
+		boost::posix_time::time_duration waitTime;
+
+	};
+
+	struct Result {
+
+		Result()
+				: connectionsNumber(0),
+				setupRate(0),
+				throughput(0),
+				roundTripP50(0),
+				roundTripP99(0),
+				errorsNumber(0) {
+			//...//
+		}
+
+		std::string name;
+		size_t connectionsNumber;
+		//! Tunnels per second.
+		double setupRate;
+		//! Bytes per second, all connections.
+		double throughput;
+		//! Microseconds.
+		double roundTripP50;
+		//! Microseconds.
+		double roundTripP99;
+		size_t errorsNumber;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Fixed benchmark scenario.
+	/** Starts in-process server with generated rules, backend server from
+	  * the test utils and drives connections through the tunnel by test
+	  * utils clients.
+	  */
+	class Scenario : private boost::noncopyable {
+
+	public:
+
+		explicit Scenario(const std::string &name);
+		virtual ~Scenario();
+
+	public:
+
+		const std::string & GetName() const {
+			return m_name;
+		}
+
+		Result Run(const Settings &) const;
+
+	protected:
+
+		virtual void CreateRules(TunnelEx::RuleSet &) const = 0;
+
+		virtual std::auto_ptr<TestUtil::Server> CreateServer(
+					const boost::posix_time::time_duration &waitTime)
+				const
+				= 0;
+
+		virtual std::auto_ptr<TestUtil::Client> CreateClient(
+					const boost::posix_time::time_duration &waitTime)
+				const
+				= 0;
+
+	private:
+
+		const std::string m_name;
+
+	};
+
+	//! Creates all scenarios in fixed order.
+	void CreateScenarios(boost::ptr_vector<Scenario> &);
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__Scenario_hpp__2610191910
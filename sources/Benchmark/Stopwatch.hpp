@@ -0,0 +1,40 @@
+/**************************************************************************
+ *   Created: 2026/10/19 21:41
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__Stopwatch_hpp__2610192141
+#define INCLUDED_FILE__TUNNELEX__Stopwatch_hpp__2610192141
+
+namespace Benchmark {
+
+	//! Wall clock with the performance counter resolution.
+	class Stopwatch {
+	public:
+		Stopwatch() {
+			QueryPerformanceFrequency(&m_frequency);
+			Restart();
+		}
+	public:
+		void Restart() {
+			QueryPerformanceCounter(&m_start);
+		}
+		double GetMicroseconds() const {
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			return double(now.QuadPart - m_start.QuadPart)
+				* 1000000
+				/ m_frequency.QuadPart;
+		}
+	private:
+		LARGE_INTEGER m_frequency;
+		LARGE_INTEGER m_start;
+	};
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__Stopwatch_hpp__2610192141
@@ -163,6 +163,23 @@ void Node::SetAttribute(const char *attributeName, const WString &value) {
 	SetAttribute(attributeName, ConvertString(value, utf8Value));
 }
 
+//////////////////////////////////////////////////////////////////////////
+
+template<>
+WString & Reader::GetAttribute(
+			const char *attributeName,
+			WString &destinationBuffer)
+		const {
+	UString utf8buffer;
+	return ConvertString(GetAttribute(attributeName, utf8buffer), destinationBuffer);
+}
+
+template<>
+WString & Reader::GetContent(WString &destinationBuffer) const {
+	UString utf8buffer;
+	return ConvertString(GetContent(utf8buffer), destinationBuffer);
+}
+
 #if TEMPLATES_REQUIRE_SOURCE != 0
 	//! Only for template instantiation.
 	namespace {
@@ -180,6 +197,8 @@ void Node::SetAttribute(const char *attributeName, const WString &value) {
 			MakeTemplatePtr(&Node::SetAttribute<UString>);
 			MakeTemplatePtr(&Node::SetAttribute<std::wstring>);
 			MakeTemplatePtr(&Node::SetAttribute<WString>);
+			MakeTemplatePtr(&Reader::GetAttribute<WString>);
+			MakeTemplatePtr(&Reader::GetContent<WString>);
 		}
 	}
 #endif // TEMPLATES_REQUIRE_SOURCE
@@ -17,6 +17,7 @@
 #include <libxml/xmlschemas.h>
 #include <libxml/xpath.h>
 #include <libxml/xmlsave.h>
+#include <libxml/xmlreader.h>
 #include "CompileWarningsBoost.h"
 #	include <boost/noncopyable.hpp>
 #	include <boost/shared_ptr.hpp>
@@ -420,8 +421,14 @@ namespace Xml {
 	void DumpSchemaParseError(void *, const char *, ...);
 
 	//! XML-Schema implementation.
+	/** Compiled schema is read-only after the construction, so the same
+	  * object could validate documents from several threads at the same time,
+	  * each validation uses own validation context.
+	  */
 	class Schema : private boost::noncopyable {
 
+		friend class Reader;
+
 	public:
 
 		class ParseException : public Document::ParseException {
@@ -453,12 +460,9 @@ namespace Xml {
 				NULL);
 			m_schema = xmlSchemaParse(m_parserContext);
 			assert(m_schema);
-			m_validateContext = xmlSchemaNewValidCtxt(m_schema);
-			assert(m_validateContext);
 		}
 
 		~Schema() {
-			xmlSchemaFreeValidCtxt(m_validateContext);
 			xmlSchemaFree(m_schema);
 			xmlSchemaFreeParserCtxt(m_parserContext);
 		}
@@ -469,27 +473,43 @@ namespace Xml {
 					Document &doc,
 					std::string *validateError = NULL)
 				const {
-			SetValidateErrorHandler(validateError);
-			return xmlSchemaValidateDoc(m_validateContext, doc.m_handler->Get()) == 0;
+			const ValidateContext context(*this, validateError);
+			return xmlSchemaValidateDoc(context.Get(), doc.m_handler->Get()) == 0;
 		}
 		
 		bool Validate(Node &node, std::string *validateError = NULL) const {
-			SetValidateErrorHandler(validateError);
-			return xmlSchemaValidateOneElement(m_validateContext, node.m_node) == 0;
+			const ValidateContext context(*this, validateError);
+			return xmlSchemaValidateOneElement(context.Get(), node.m_node) == 0;
 		}
 
 	protected:
 
-		void SetValidateErrorHandler(std::string *validateError = NULL) const {
-			if (validateError) {
-				validateError->clear();
+		class ValidateContext : private boost::noncopyable {
+		public:
+			explicit ValidateContext(
+						const Schema &schema,
+						std::string *validateError)
+					: m_context(xmlSchemaNewValidCtxt(schema.m_schema)) {
+				assert(m_context);
+				if (validateError) {
+					validateError->clear();
+				}
+				xmlSchemaSetValidErrors(
+					m_context,
+					&DumpSchemaValidityError,
+					&DumpSchemaValidityError,
+					validateError);
 			}
-			xmlSchemaSetValidErrors(
-				m_validateContext,
-				&DumpSchemaValidityError,
-				&DumpSchemaValidityError,
-				validateError);
-		}
+			~ValidateContext() {
+				xmlSchemaFreeValidCtxt(m_context);
+			}
+		public:
+			xmlSchemaValidCtxtPtr Get() const {
+				return m_context;
+			}
+		private:
+			xmlSchemaValidCtxtPtr m_context;
+		};
 
 	private:
 
@@ -497,7 +517,6 @@ namespace Xml {
 		boost::shared_ptr<Document> m_schemaDoc;
 		xmlSchemaParserCtxtPtr m_parserContext;
 		xmlSchemaPtr m_schema;
-		xmlSchemaValidCtxtPtr m_validateContext;
 
 	};
 
@@ -603,6 +622,158 @@ namespace Xml {
 
 	//////////////////////////////////////////////////////////////////////////
 
+	//! Forward-only XML reader.
+	/** Doesn't build document tree, so memory usage doesn't depend on
+	  * the document size. XML-Schema validation, if it's set, is performed
+	  * node by node at reading.
+	  */
+	class Reader : private boost::noncopyable {
+
+	public:
+
+		template<class XmlString>
+		explicit Reader(const XmlString &xmlString)
+				: m_reader(Open(xmlString)) {
+			//...//
+		}
+
+		template<class XmlString>
+		explicit Reader(
+					const XmlString &xmlString,
+					const Schema &schema,
+					std::string *validateError = NULL)
+				: m_reader(Open(xmlString)),
+				m_validateContext(new Schema::ValidateContext(schema, validateError)) {
+			if (	xmlTextReaderSchemaValidateCtxt(
+						m_reader,
+						m_validateContext->Get(),
+						0)
+					!= 0) {
+				xmlFreeTextReader(m_reader);
+				throw Exception("Could not start XML-Schema validation.");
+			}
+		}
+
+		~Reader() {
+			xmlFreeTextReader(m_reader);
+		}
+
+	public:
+
+		//! Moves to the next node.
+		/** @throw Document::ParseException if XML has an invalid format.
+		  * @return false if there are no more nodes.
+		  */
+		bool Read() {
+			const int result = xmlTextReaderRead(m_reader);
+			if (result == -1) {
+				throw Document::ParseException(
+					"Could not parse XML-string, string has an invalid format.");
+			}
+			return result == 1;
+		}
+
+		//! Returns false if already read nodes do not match XML-Schema.
+		bool IsValid() const {
+			return xmlTextReaderIsValid(m_reader) != 0;
+		}
+
+		bool IsElement() const {
+			return xmlTextReaderNodeType(m_reader) == XML_READER_TYPE_ELEMENT;
+		}
+
+		bool IsEndElement() const {
+			return xmlTextReaderNodeType(m_reader) == XML_READER_TYPE_END_ELEMENT;
+		}
+
+		//! Returns true for element without end element, as <Element/>.
+		bool IsEmptyElement() const {
+			return xmlTextReaderIsEmptyElement(m_reader) == 1;
+		}
+
+		int GetDepth() const {
+			return xmlTextReaderDepth(m_reader);
+		}
+
+		bool IsName(const char *name) const {
+			const xmlChar *const nodeName = xmlTextReaderConstLocalName(m_reader);
+			return
+				nodeName != NULL
+				&& xmlStrEqual(nodeName, reinterpret_cast<const xmlChar *>(name));
+		}
+
+		template<class String>
+		String & GetAttribute(
+					const char *attributeName,
+					String &destinationBuffer)
+				const {
+			xmlChar *attributeValPtr = xmlTextReaderGetAttribute(
+				m_reader, reinterpret_cast<const xmlChar *>(attributeName));
+			if (attributeValPtr == NULL) {
+				throw Exception("Unknown XML-attribute.");
+			}
+			boost::shared_ptr<xmlChar> attributeVal(attributeValPtr, &Free);
+			destinationBuffer
+				= reinterpret_cast<String::value_type *>(attributeValPtr);
+			return destinationBuffer;
+		}
+
+		template<>
+		TunnelEx::WString & GetAttribute(
+				const char *attributeName,
+				TunnelEx::WString &destinationBuffer)
+			const;
+
+		//! Returns text content of the current element.
+		/** Reads only the current element subtree, the next reading starts
+		  * from the element children.
+		  */
+		template<class String>
+		String & GetContent(String &destinationBuffer) const {
+			xmlChar *contentPtr = xmlTextReaderReadString(m_reader);
+			if (contentPtr == NULL) {
+				destinationBuffer = String();
+				return destinationBuffer;
+			}
+			boost::shared_ptr<xmlChar> content(contentPtr, &Free);
+			destinationBuffer
+				= reinterpret_cast<String::value_type *>(contentPtr);
+			return destinationBuffer;
+		}
+
+		template<>
+		TunnelEx::WString & GetContent(TunnelEx::WString &destinationBuffer) const;
+
+	private:
+
+		template<class XmlString>
+		static xmlTextReaderPtr Open(const XmlString &xmlString) {
+#			pragma warning(push)
+#			pragma warning(disable: 4244)
+			const xmlTextReaderPtr result = xmlReaderForMemory(
+				reinterpret_cast<const char *>(xmlString.GetCStr()),
+				xmlString.GetLength() * sizeof(XmlString::value_type),
+				NULL,
+				NULL,
+				0);
+#			pragma warning(pop)
+			if (result == NULL) {
+				throw Document::ParseException(
+					"Could not parse XML-string, "
+						"string has an invalid format or empty.");
+			}
+			return result;
+		}
+
+	private:
+
+		xmlTextReaderPtr m_reader;
+		boost::shared_ptr<Schema::ValidateContext> m_validateContext;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
 	//! XPath implementation.
 	class XPath : private boost::noncopyable {
 	
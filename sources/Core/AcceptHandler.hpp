@@ -229,6 +229,24 @@ namespace TunnelEx {
 			return 0;
 		}
 
+		//! Called by a reactor when acceptor handle is ready for writing.
+		virtual int handle_output(ACE_HANDLE = ACE_INVALID_HANDLE) {
+			try {
+				m_acceptor->HandleOutput();
+			} catch (const TunnelEx::LocalException &ex) {
+				Log::GetInstance().AppendError(
+					ConvertString<String>(ex.GetWhat()).GetCStr());
+			} catch (const std::exception &ex) {
+				Log::GetInstance().AppendError(ex.what());
+				throw;
+			} catch (...) {
+				Log::GetInstance().AppendSystemError(
+					"Unknown system error occurred at acceptor data sending.");
+				throw;
+			}
+			return 0;
+		}
+
 #		ifdef ACE_WIN32
 			//! Method created only for Windows-pipes.
 			virtual int handle_signal(int, siginfo_t *, ucontext_t *) {
@@ -249,7 +267,11 @@ namespace TunnelEx {
 	private:
 
 		static ACE_Reactor_Mask GetEventsMask() {
-			return ACE_Event_Handler::ACCEPT_MASK | ACE_Event_Handler::READ_MASK;
+			// write event comes only after failed non-blocking sending, so
+			// it doesn't disturb listeners which never send
+			return ACE_Event_Handler::ACCEPT_MASK
+				| ACE_Event_Handler::READ_MASK
+				| ACE_Event_Handler::WRITE_MASK;
 		}
 
 	private:
@@ -130,6 +130,10 @@ AutoPtr<MessageBlock> Acceptor::CreateMessageBlock(
 	return m_pimpl->CreateMessageBlock(size, data);
 }
 
+void Acceptor::HandleOutput() {
+	//...//
+}
+
 const RuleEndpoint & Acceptor::GetRuleEndpoint() const {
 	return m_pimpl->m_ruleEndpoint;
 }
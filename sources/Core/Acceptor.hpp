@@ -67,6 +67,14 @@ namespace TunnelEx {
 		  */
 		virtual bool TryToAttach() = 0;
 
+		//! Handles I/O handle readiness for writing.
+		/** Called after non-blocking sending through the acceptor I/O
+		  * handle failed as system buffer was full and the buffer has
+		  * free space again. Default implementation does nothing.
+		  * @throw TunnelEx::LocalException
+		  */
+		virtual void HandleOutput();
+
 		virtual ::TunnelEx::AutoPtr<::TunnelEx::EndpointAddress> GetLocalAddress()
 			const
 			= 0;
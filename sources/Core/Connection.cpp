@@ -20,6 +20,8 @@
 #include "MessagesAllocator.hpp"
 #include "Error.hpp"
 #include "Locking.hpp"
+#include "Metrics.hpp"
+#include "Tracer.hpp"
 
 using namespace TunnelEx;
 using namespace TunnelEx::Helpers::Asserts;
@@ -349,7 +351,8 @@ public:
 				new MessagesAllocator(
 					messageBlockQueueBufferSize + 1, // plus 1 for message, that duplicated for proactor
 					messageBlockQueueBufferSize,
-					UniqueMessageBlockHolder::GetMessageMemorySize(dataBlockSize)));
+					UniqueMessageBlockHolder::GetMessageMemorySize(dataBlockSize),
+					signal->GetTunnel().GetSharedMetrics()));
 		}
 
 		ACE_Proactor &proactor = signal->GetTunnel().GetProactor();
@@ -516,9 +519,10 @@ public:
 		}
 
 		messageBlockHolder.SetSendingStartTimePoint();
+		const size_t size = messageBlockDuplicate.GetUnreadedDataSize();
 		const auto writeResult = m_writeStreamFunc(
 			messageBlockDuplicate.Get(),
-			messageBlockDuplicate.GetUnreadedDataSize());
+			size);
 		if (writeResult == -1) {
 			const auto errNo = errno;
 			lock.release();
@@ -529,6 +533,8 @@ public:
 			// another thread (also see read-init incrimination)
 			Interlocked::Increment(m_refsCount);
 			lock.release();
+			m_traffic.AddOutcoming(size);
+			Trace(TRACE_EVENT_WRITE_POST, m_instanceId, size);
 			UpdateIdleTimer(messageBlockHolder.GetSendingStartTime());
 			messageBlockDuplicate.Release();
 			messageBlockHolder.MarkAsAddedToQueue();
@@ -569,6 +575,7 @@ public:
 		}
 		m_ruleEndpointAddress->StatConnectionSetupCompleting();
 		StartIdleTimer();
+		Trace(TRACE_EVENT_SETUP_END, m_instanceId);
 	}
 
 	void OnSetupFail(const WString &failReason) {
@@ -576,6 +583,7 @@ public:
 		assert(m_setupState == SETUP_STATE_NOT_COMPLETED);
 		m_setupState = SETUP_STATE_FAILED;
 		m_ruleEndpointAddress->StatConnectionSetupCanceling(failReason);
+		Trace(TRACE_EVENT_SETUP_END, m_instanceId);
 		Log::GetInstance().AppendDebug(
 			"Connection %1% setup has been canceled.",
 			m_instanceId);
@@ -642,6 +650,11 @@ public:
 		if (messageBlock.GetUnreadedDataSize() == 0) {
 			return;
 		}
+		m_traffic.AddIncoming(messageBlock.GetUnreadedDataSize());
+		Trace(
+			TRACE_EVENT_LISTENER_DISPATCH,
+			m_instanceId,
+			messageBlock.GetUnreadedDataSize());
 		m_signal->OnNewMessageBlock(messageBlock);
 	}
 
@@ -661,6 +674,10 @@ public:
 		return m_closeCode;
 	}
 
+	TrafficStat GetTrafficStat() const throw() {
+		return m_traffic.GetStat();
+	}
+
 public:
 
 	virtual void handle_read_file(const ACE_Asynch_Read_File::Result &result) {
@@ -821,6 +838,10 @@ private:
 			m_readStartAttemptsCount > 0
 				?	(m_readsMallocFailsCount * 100) / m_readStartAttemptsCount
 				:	0);
+		const pt::time_duration latency = message.GetFullLatency();
+		if (!latency.is_special()) {
+			Metrics::GetInstance().CollectLatency(latency.total_microseconds());
+		}
 	}
 
 	void ReportSendError(int errorNo) const {
@@ -872,6 +893,7 @@ private:
 		UniqueMessageBlockHolder messageBlock(result.message_block());
 		messageBlock.SetReceivingTimePoint();
 		assert(messageBlock.IsTunnelMessage());
+		Trace(TRACE_EVENT_READ_COMPLETE, m_instanceId, result.bytes_transferred());
 
 		if (!result.success()) {
 			messageBlock.Reset();
@@ -966,6 +988,7 @@ private:
 	void HandleWriteStream(const Result &result) {
 		UniqueMessageBlockHolder messageBlock(result.message_block());
 		messageBlock.SetSendingTimePoint();
+		Trace(TRACE_EVENT_WRITE_COMPLETE, m_instanceId, result.bytes_transferred());
 		m_signal->OnMessageBlockSent(messageBlock);
 		RemoveRef(true);
 	}
@@ -1016,6 +1039,7 @@ private:
 			throw ConnectionException(message.str().c_str());
 		}
 		m_readingState = RS_READING;
+		Trace(TRACE_EVENT_READ_POST, m_instanceId);
 		// incrementing only here as "isClosed + locking" guaranties that 
 		// the m_refsCount is not zero and object will not destroyed from
 		// another thread (also see write-init incrimination)
@@ -1116,6 +1140,8 @@ private:
 	volatile long m_closeCode;
 	static const long m_closeCodeNotSetValue;
 
+	Helpers::TrafficCounters m_traffic;
+
 };
 
 const long Connection::Implementation::m_closeCodeNotSetValue
@@ -1192,6 +1218,7 @@ void Connection::Setup() {
 }
 
 void Connection::StartSetup() {
+	Trace(TRACE_EVENT_SETUP_START, GetInstanceId());
 	Setup();
 }
 
@@ -1222,3 +1249,7 @@ bool Connection::IsOneWay() const {
 long Connection::GetCloseCode() const throw() {
 	return m_pimpl->GetCloseCode();
 }
+
+TrafficStat Connection::GetTrafficStat() const throw() {
+	return m_pimpl->GetTrafficStat();
+}
@@ -11,6 +11,7 @@
 #define INCLUDED_FILE__Connection_h__0703010128
 
 #include "DataTransferCommand.hpp"
+#include "TrafficStat.hpp"
 #include "Instance.hpp"
 #include "IoHandle.h"
 #include "SmartPtr.hpp"
@@ -126,6 +127,9 @@ namespace TunnelEx {
 
 		long GetCloseCode() const throw();
 
+		//! Returns traffic counters snapshot.
+		TrafficStat GetTrafficStat() const throw();
+
 		bool IsSetupCompleted() const;
 
 		bool IsSetupFailed() const;
@@ -10,6 +10,12 @@
 #include "Prec.h"
 #include "Locking.hpp"
 
+#include <intrin.h>
+
+// InterlockedCompareExchange64 is not exported by Windows XP kernel32,
+// compiler intrinsic (cmpxchg8b) works on all supported systems.
+#pragma intrinsic(_InterlockedCompareExchange64)
+
 using namespace TunnelEx;
 
 //////////////////////////////////////////////////////////////////////////
@@ -72,4 +78,26 @@ long Interlocked::CompareExchange(
 	return BOOST_INTERLOCKED_COMPARE_EXCHANGE(&destination, exchangeValue, compareValue);
 }
 
+long long Interlocked::ExchangeAdd(
+			long long volatile &destination,
+			long long value)
+		throw() {
+	for ( ; ; ) {
+		// could be read partially, compare-exchange will fail in this case
+		const long long prevValue = destination;
+		if (	_InterlockedCompareExchange64(&destination, prevValue + value, prevValue)
+				== prevValue) {
+			return prevValue;
+		}
+	}
+}
+
+long long Interlocked::CompareExchange(
+			long long volatile &destination,
+			long long exchangeValue,
+			long long compareValue)
+		throw() {
+	return _InterlockedCompareExchange64(&destination, exchangeValue, compareValue);
+}
+
 //////////////////////////////////////////////////////////////////////////
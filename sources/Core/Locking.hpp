@@ -32,6 +32,17 @@ namespace TunnelEx {
 				long compareValue)
 			throw();
 
+		static long long ExchangeAdd(
+				long long volatile &destination,
+				long long value)
+			throw();
+
+		static long long CompareExchange(
+				long long volatile &destination,
+				long long exchangeValue,
+				long long compareValue)
+			throw();
+
 	};
 
 	//////////////////////////////////////////////////////////////////////////
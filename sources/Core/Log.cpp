@@ -22,6 +22,17 @@ using namespace TunnelEx::Singletons;
 //////////////////////////////////////////////////////////////////////////
 
 //! Log implementation.
+/** Records are placed into the lock-free ring buffer and written into the
+  * streams by the writer thread, so threads which append records never
+  * wait for the stream mutex and disk. The writer thread is started with
+  * the first attached file or stream, until it is started records are
+  * written by appending thread. Debug records are placed into the buffer
+  * as format ID and raw arguments and formatted only by writer. Fatal and
+  * system error records are written by appending thread after all queued
+  * records and flushed at once, as the process may be terminated right
+  * after such error. Last written records are kept in the memory for the
+  * log viewers.
+  */
 class TunnelEx::Singletons::LogPolicy::Implementation : private boost::noncopyable {
 
 public:
@@ -36,23 +47,68 @@ public:
 		LevelInfo()
 				: isRegistrationOn(false),
 				name("<?>"),
-				eventCount(0) {
+				eventCount(0),
+				isSynchronous(false) {
 			//...//
 		}
 
 		const char *name;
 		volatile long isRegistrationOn;
 		volatile long eventCount;
+		//! Record is written and flushed by appending thread, not queued.
+		bool isSynchronous;
 		
 	};
 
 	typedef std::vector<LevelInfo> Levels;
 
+	//! Format string of the deferred formatting record.
+	/** Format source string pointer is the format ID, format string is
+	  * copied as module with source string can be unloaded before record
+	  * will be written.
+	  */
+	struct MessageFormat {
+		const char *source;
+		std::string text;
+	};
+
+	typedef boost::ptr_vector<MessageFormat> MessageFormatsStorage;
+	typedef boost::unordered_map<const char *, const MessageFormat *> MessageFormats;
+	typedef ReadWriteSpinMutex MessageFormatsMutex;
+	typedef ReadLock<MessageFormatsMutex> MessageFormatsReadLock;
+	typedef WriteLock<MessageFormatsMutex> MessageFormatsWriteLock;
+
+	struct Record {
+		volatile long sequence;
+		pt::ptime time;
+		const LevelInfo *level;
+		//! Format for the deferred formatting or nullptr for text record.
+		const MessageFormat *format;
+		ACE_thread_t thread;
+		//! Message text or arguments for the deferred formatting.
+		std::string message;
+	};
+
+	typedef std::vector<Record> Records;
+
+	typedef std::vector<LogRecord> RecentRecords;
+
 public:
 	
 	Implementation()
 			: m_levels(LOG_LEVEL_LEVELS_COUNT),
-			m_size(0) {
+			m_size(0),
+			//! @todo: hardcoded log buffer size, must be power of 2
+			m_records(1 << 13),
+			m_enqueuePos(0),
+			m_dequeuePos(0),
+			m_droppedCount(0),
+			m_droppedTotalCount(0),
+			//! @todo: hardcoded number of recent records in memory
+			m_recentRecords(2000),
+			m_lastRecentRecordNumber(0),
+			m_isWriterStarted(false),
+			m_isWriterStopped(false) {
 		m_levels[LOG_LEVEL_UNKNOWN].name = "Unknown";
 		m_levels[LOG_LEVEL_TRACK].name = "Tracking";
 		m_levels[LOG_LEVEL_DEBUG].name = "Debug";
@@ -60,11 +116,29 @@ public:
 		m_levels[LOG_LEVEL_WARN].name = "Warning";
 		m_levels[LOG_LEVEL_ERROR].name = "Error";
 		m_levels[LOG_LEVEL_SYSTEM_ERROR].name = "System error";
+		m_levels[LOG_LEVEL_SYSTEM_ERROR].isSynchronous = true;
 		m_levels[LOG_LEVEL_FATAL_ERROR].name = "Fatal error";
+		m_levels[LOG_LEVEL_FATAL_ERROR].isSynchronous = true;
+		BOOST_STATIC_ASSERT(((1 << 13) & ((1 << 13) - 1)) == 0);
+		for (size_t i = 0; i < m_records.size(); ++i) {
+			m_records[i].sequence = long(i);
+			m_records[i].level = nullptr;
+			m_records[i].format = nullptr;
+		}
 	}
 
 	~Implementation() {
-		//...//
+		try {
+			if (m_isWriterStarted) {
+				Interlocked::Exchange(m_isWriterStopped, true);
+				m_writeEvent.signal();
+				m_writerThread.wait();
+			}
+			Lock lock(m_streamMutex);
+			WriteRecords();
+		} catch (...) {
+			assert(false);
+		}
 	}
 
 public:
@@ -108,24 +182,355 @@ public:
 	}
 
 	void Append(LevelInfo &level, const std::string &message) throw() {
+		Append(level, nullptr, message.c_str(), message.size());
+	}
+
+	void AppendDeferred(
+				LevelInfo &level,
+				const char *format,
+				const Helpers::LogRecordArgs &args)
+			throw() {
+		const MessageFormat *messageFormat;
+		try {
+			messageFormat = &GetMessageFormat(format);
+		} catch (...) {
+			assert(false);
+			return;
+		}
+		Append(level, messageFormat, args.GetData(), args.GetSize());
+	}
+
+	void Append(
+				LevelInfo &level,
+				const MessageFormat *format,
+				const char *message,
+				size_t messageSize)
+			throw() {
 		try {
 			const pt::ptime occurTime(pt::microsec_clock::local_time());
-			Lock lock(m_streamMutex);
-			m_stream
-				<< occurTime
-				<< ' ' << std::setw(12) << level.name
-				<< ": " << message;
-			if (*message.rbegin() != '.') {
-				m_stream << '.';
+			if (level.isSynchronous) {
+				AppendSynchronous(level, occurTime, format, message, messageSize);
+				return;
+			}
+			if (!Enqueue(level, occurTime, format, message, messageSize)) {
+				Interlocked::Increment(m_droppedCount);
+				return;
 			}
-			m_stream << std::endl;
 			Interlocked::Increment(level.eventCount);
 			Interlocked::Increment(m_size);
+			if (!m_isWriterStarted) {
+				Lock lock(m_streamMutex);
+				WriteRecords();
+			}
 		} catch (...) {
 			assert(false);
 		}
 	}
 
+	long GetDroppedCount() const {
+		return m_droppedTotalCount;
+	}
+
+private:
+
+	static long GetNextPos(long pos) throw() {
+		return long(static_cast<unsigned long>(pos) + 1);
+	}
+
+	static long GetPosDistance(long from, long to) throw() {
+		return long(static_cast<unsigned long>(to) - static_cast<unsigned long>(from));
+	}
+
+	//! Returns format copy for format source string, registers it at first.
+	const MessageFormat & GetMessageFormat(const char *source) {
+		{
+			MessageFormatsReadLock lock(m_messageFormatsMutex);
+			const MessageFormats::const_iterator pos
+				= m_messageFormats.find(source);
+			// source string memory could be reused by other module
+			if (pos != m_messageFormats.end() && pos->second->text == source) {
+				return *pos->second;
+			}
+		}
+		std::auto_ptr<MessageFormat> format(new MessageFormat);
+		format->source = source;
+		format->text = source;
+		MessageFormatsWriteLock lock(m_messageFormatsMutex);
+		const MessageFormats::const_iterator pos = m_messageFormats.find(source);
+		if (pos != m_messageFormats.end() && pos->second->text == source) {
+			return *pos->second;
+		}
+		// previous format copy isn't removed as it can be used by records
+		m_messageFormatsStorage.push_back(format);
+		const MessageFormat &result = m_messageFormatsStorage.back();
+		m_messageFormats[source] = &result;
+		return result;
+	}
+
+	//! Formats deferred formatting record.
+	static std::string FormatRecordMessage(
+				const MessageFormat &format,
+				const std::string &args) {
+		Format message(format.text);
+		for (size_t i = 0; i < args.size(); ) {
+			const Helpers::LogRecordArgs::Type type
+				= Helpers::LogRecordArgs::Type(args[i++]);
+			switch (type) {
+				case Helpers::LogRecordArgs::TYPE_SIGNED:
+					message % ReadArg<long long>(args, i);
+					break;
+				case Helpers::LogRecordArgs::TYPE_UNSIGNED:
+					message % ReadArg<unsigned long long>(args, i);
+					break;
+				case Helpers::LogRecordArgs::TYPE_DOUBLE:
+					message % ReadArg<double>(args, i);
+					break;
+				case Helpers::LogRecordArgs::TYPE_BOOL:
+					message % ReadArg<bool>(args, i);
+					break;
+				case Helpers::LogRecordArgs::TYPE_STRING:
+					{
+						const unsigned int size = ReadArg<unsigned int>(args, i);
+						message % args.substr(i, size);
+						i += size;
+					}
+					break;
+				case Helpers::LogRecordArgs::TYPE_WSTRING:
+					{
+						const unsigned int size = ReadArg<unsigned int>(args, i);
+						std::wstring str(size, 0);
+						if (size > 0) {
+							memcpy(&str[0], &args[i], size * sizeof(wchar_t));
+						}
+						message % ConvertString<String>(str.c_str()).GetCStr();
+						i += size * sizeof(wchar_t);
+					}
+					break;
+				default:
+					assert(false);
+					i = args.size();
+					break;
+			}
+		}
+		return message.str();
+	}
+
+	template<typename T>
+	static T ReadArg(const std::string &args, size_t &pos) {
+		T result;
+		assert(pos + sizeof(result) <= args.size());
+		memcpy(&result, &args[pos], sizeof(result));
+		pos += sizeof(result);
+		return result;
+	}
+
+	//! Puts record into the buffer, returns false if buffer is full.
+	bool Enqueue(
+				const LevelInfo &level,
+				const pt::ptime &time,
+				const MessageFormat *format,
+				const char *message,
+				size_t messageSize)
+			throw() {
+		long pos = m_enqueuePos;
+		for ( ; ; ) {
+			Record &record = m_records[size_t(pos) & (m_records.size() - 1)];
+			const long distance = GetPosDistance(pos, record.sequence);
+			if (distance == 0) {
+				if (	Interlocked::CompareExchange(m_enqueuePos, GetNextPos(pos), pos)
+						== pos) {
+					record.time = time;
+					record.level = &level;
+					record.format = format;
+					if (format) {
+						record.thread = ACE_OS::thr_self();
+					}
+					try {
+						// record string keeps its memory, so no allocations
+						// after some time
+						record.message.assign(message, messageSize);
+					} catch (...) {
+						record.message.clear();
+					}
+					Interlocked::Exchange(record.sequence, GetNextPos(pos));
+					return true;
+				}
+			} else if (distance < 0) {
+				return false;
+			}
+			pos = m_enqueuePos;
+		}
+	}
+
+	//! Writes all queued records and the record, flushes stream.
+	/** Records which are enqueued by other threads while the record is
+	  * written will be written by the writer thread after it.
+	  */
+	void AppendSynchronous(
+				LevelInfo &level,
+				const pt::ptime &time,
+				const MessageFormat *format,
+				const char *message,
+				size_t messageSize) {
+		Lock lock(m_streamMutex);
+		WriteRecords();
+		const std::string messageStr(message, messageSize);
+		if (format) {
+			WriteRecord(level, time, *format, ACE_OS::thr_self(), messageStr);
+		} else {
+			WriteRecord(level, time, messageStr);
+		}
+		m_stream.flush();
+		Interlocked::Increment(level.eventCount);
+		Interlocked::Increment(m_size);
+	}
+
+	//! Writes all ready records, stream mutex must be locked.
+	void WriteRecords() {
+		bool isWritten = false;
+		for ( ; ; ) {
+			Record &record
+				= m_records[size_t(m_dequeuePos) & (m_records.size() - 1)];
+			if (record.sequence != GetNextPos(m_dequeuePos)) {
+				break;
+			}
+			if (record.format) {
+				WriteRecord(
+					*record.level,
+					record.time,
+					*record.format,
+					record.thread,
+					record.message);
+			} else {
+				WriteRecord(*record.level, record.time, record.message);
+			}
+			Interlocked::Exchange(
+				record.sequence,
+				long(static_cast<unsigned long>(m_dequeuePos) + m_records.size()));
+			m_dequeuePos = GetNextPos(m_dequeuePos);
+			isWritten = true;
+		}
+		const long droppedCount = Interlocked::Exchange(m_droppedCount, 0);
+		if (droppedCount > 0) {
+			m_droppedTotalCount += droppedCount;
+			WriteRecord(
+				GetLevelInfo(LOG_LEVEL_WARN),
+				pt::microsec_clock::local_time(),
+				(Format("%1% log records dropped as log buffer is full") % droppedCount).str());
+			isWritten = true;
+		}
+		if (isWritten) {
+			m_stream.flush();
+		}
+	}
+
+	void WriteRecord(
+				const LevelInfo &level,
+				const pt::ptime &time,
+				const MessageFormat &format,
+				ACE_thread_t thread,
+				const std::string &args) {
+		std::ostringstream message;
+		message << thread << " ";
+		try {
+			message << FormatRecordMessage(format, args);
+		} catch (...) {
+			message << "Format-error for the string \"" << format.text << "\".";
+		}
+		WriteRecord(level, time, message.str());
+	}
+
+	void WriteRecord(
+				const LevelInfo &level,
+				const pt::ptime &time,
+				const std::string &message) {
+		const std::string timeStr = pt::to_simple_string(time);
+		const bool isDotRequired = message.empty() || *message.rbegin() != '.';
+		m_stream
+			<< timeStr
+			<< ' ' << std::setw(12) << level.name
+			<< ": " << message;
+		if (isDotRequired) {
+			m_stream << '.';
+		}
+		m_stream << '\n';
+		{
+			Lock lock(m_recentRecordsMutex);
+			LogRecord &record = m_recentRecords[
+				m_lastRecentRecordNumber % m_recentRecords.size()];
+			record.sequenceNumber = ++m_lastRecentRecordNumber;
+			record.time = timeStr;
+			record.level = LogLevel(&level - &m_levels[0]);
+			record.message = message;
+			if (isDotRequired) {
+				record.message.push_back('.');
+			}
+		}
+	}
+
+public:
+
+	void GetRecentRecords(
+				unsigned long sinceSequenceNumber,
+				size_t maxNumber,
+				std::vector<LogRecord> &result)
+			const {
+		std::vector<LogRecord> records;
+		Lock lock(m_recentRecordsMutex);
+		const unsigned long last = m_lastRecentRecordNumber;
+		// number from the previous run (service restarted) - all records
+		unsigned long first = sinceSequenceNumber <= last ? sinceSequenceNumber : 0;
+		if (last > m_recentRecords.size()) {
+			first = std::max(
+				first,
+				last - static_cast<unsigned long>(m_recentRecords.size()));
+		}
+		if (last > maxNumber) {
+			first = std::max(first, last - static_cast<unsigned long>(maxNumber));
+		}
+		if (first < last) {
+			records.reserve(last - first);
+		}
+		for (unsigned long i = first; i < last; ++i) {
+			records.push_back(m_recentRecords[i % m_recentRecords.size()]);
+		}
+		records.swap(result);
+	}
+
+private:
+
+	void StartWriter() {
+		if (m_isWriterStarted) {
+			return;
+		}
+		if (	m_writerThread.spawn(
+					&Implementation::WriterThreadMain,
+					this,
+					THR_SCOPE_PROCESS | THR_JOINABLE)
+				== -1) {
+			return;
+		}
+		Interlocked::Exchange(m_isWriterStarted, true);
+	}
+
+	static ACE_THR_FUNC_RETURN WriterThreadMain(void *param) {
+		Implementation &self = *static_cast<Implementation *>(param);
+		//! @todo: hardcoded log flush interval
+		const ACE_Time_Value flushInterval(0, 100 * 1000);
+		while (!self.m_isWriterStopped) {
+			self.m_writeEvent.wait(&flushInterval, 0);
+			try {
+				Lock lock(self.m_streamMutex);
+				self.WriteRecords();
+			} catch (...) {
+				assert(false);
+			}
+		}
+		return NULL;
+	}
+
+public:
+
 	bool AttachFile(const std::wstring &filePath) throw() {
 		try {
 			try {
@@ -135,8 +540,12 @@ public:
 					(Format("Log: could not create directory for attached file: \"%1%\".") % ex.what()).str());
 			}
 			Lock lock(m_streamMutex);
-			return m_stream.AttachFile(
-				ConvertString<String>(filePath.c_str()).GetCStr());
+			WriteRecords();
+			if (!m_stream.AttachFile(ConvertString<String>(filePath.c_str()).GetCStr())) {
+				return false;
+			}
+			StartWriter();
+			return true;
 		} catch (...) {
 			return false;
 		}
@@ -145,6 +554,7 @@ public:
 	bool DetachFile(const std::wstring &filePath) throw() {
 		try {
 			Lock lock(m_streamMutex);
+			WriteRecords();
 			return m_stream.DetachFile(
 				ConvertString<String>(filePath.c_str()).GetCStr());
 		} catch (...) {
@@ -155,7 +565,12 @@ public:
 	bool AttachStdoutStream() throw() {
 		try {
 			Lock lock(m_streamMutex);
-			return m_stream.AttachStream(std::cout);
+			WriteRecords();
+			if (!m_stream.AttachStream(std::cout)) {
+				return false;
+			}
+			StartWriter();
+			return true;
 		} catch (...) {
 			return false;
 		}
@@ -164,6 +579,7 @@ public:
 	bool DetachStdoutStream() throw() {
 		try {
 			Lock lock(m_streamMutex);
+			WriteRecords();
 			return m_stream.DetachStream(std::cout);
 		} catch (...) {
 			return false;
@@ -173,7 +589,12 @@ public:
 	bool AttachStderrStream() throw() {
 		try {
 			Lock lock(m_streamMutex);
-			return m_stream.AttachStream(std::cerr);
+			WriteRecords();
+			if (!m_stream.AttachStream(std::cerr)) {
+				return false;
+			}
+			StartWriter();
+			return true;
 		} catch (...) {
 			return false;
 		}
@@ -182,6 +603,7 @@ public:
 	bool DetachStderrStream() throw() {
 		try {
 			Lock lock(m_streamMutex);
+			WriteRecords();
 			return m_stream.DetachStream(std::cerr);
 		} catch (...) {
 			return false;
@@ -226,6 +648,25 @@ private:
 	
 	volatile long m_size;
 
+	MessageFormatsMutex m_messageFormatsMutex;
+	MessageFormats m_messageFormats;
+	MessageFormatsStorage m_messageFormatsStorage;
+
+	Records m_records;
+	volatile long m_enqueuePos;
+	long m_dequeuePos;
+	volatile long m_droppedCount;
+	volatile long m_droppedTotalCount;
+
+	mutable Mutex m_recentRecordsMutex;
+	RecentRecords m_recentRecords;
+	unsigned long m_lastRecentRecordNumber;
+
+	ACE_Auto_Event m_writeEvent;
+	ACE_Thread_Manager m_writerThread;
+	volatile long m_isWriterStarted;
+	volatile long m_isWriterStopped;
+
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -349,6 +790,14 @@ void LogPolicy::AppendDebugDirect(const WFormat &message) throw() {
 	}
 }
 
+void LogPolicy::AppendDebugDeferred(
+			const char *format,
+			const Helpers::LogRecordArgs &args)
+		throw() {
+	assert(IsDebugRegistrationOn());
+	m_pimpl->AppendDeferred(m_pimpl->GetLevelInfo(LOG_LEVEL_DEBUG), format, args);
+}
+
 void LogPolicy::AppendForced(LogLevel level, const std::string &message) throw() {
 	m_pimpl->Append(m_pimpl->GetLevelInfo(level), message);
 }
@@ -437,6 +886,18 @@ long LogPolicy::GetSize() const {
 	return m_pimpl->GetSize();
 }
 
+void LogPolicy::GetRecentRecords(
+			unsigned long sinceSequenceNumber,
+			size_t maxNumber,
+			std::vector<LogRecord> &result)
+		const {
+	m_pimpl->GetRecentRecords(sinceSequenceNumber, maxNumber, result);
+}
+
+long LogPolicy::GetDroppedCount() const {
+	return m_pimpl->GetDroppedCount();
+}
+
 long LogPolicy::GetWarnCount() const {
 	return m_pimpl->GetEventCount(LOG_LEVEL_WARN);
 }
@@ -36,6 +36,155 @@ namespace TunnelEx {
 		LOG_LEVEL_LEVELS_COUNT
 	};
 
+	//! Written log record from the recent records memory store.
+	struct LogRecord {
+		//! Record number, starts with 1.
+		unsigned long sequenceNumber;
+		std::string time;
+		LogLevel level;
+		std::string message;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace Helpers {
+
+		//! Log record arguments in the binary form.
+		/** Keeps raw values of the log record arguments, so record will be
+		  * formatted later, by the log writer thread. Values of the unknown
+		  * types are formatted at once. Too long strings are truncated.
+		  */
+		class LogRecordArgs {
+
+		public:
+
+			enum Type {
+				TYPE_SIGNED,
+				TYPE_UNSIGNED,
+				TYPE_DOUBLE,
+				TYPE_BOOL,
+				TYPE_STRING,
+				TYPE_WSTRING
+			};
+
+		public:
+
+			LogRecordArgs() throw()
+					: m_size(0) {
+				//...//
+			}
+
+		private:
+
+			LogRecordArgs(const LogRecordArgs &);
+			const LogRecordArgs & operator =(const LogRecordArgs &);
+
+		public:
+
+			void Add(int value) throw() {
+				AddValue(TYPE_SIGNED, static_cast<long long>(value));
+			}
+			void Add(long value) throw() {
+				AddValue(TYPE_SIGNED, static_cast<long long>(value));
+			}
+			void Add(long long value) throw() {
+				AddValue(TYPE_SIGNED, value);
+			}
+			void Add(unsigned int value) throw() {
+				AddValue(TYPE_UNSIGNED, static_cast<unsigned long long>(value));
+			}
+			void Add(unsigned long value) throw() {
+				AddValue(TYPE_UNSIGNED, static_cast<unsigned long long>(value));
+			}
+			void Add(unsigned long long value) throw() {
+				AddValue(TYPE_UNSIGNED, value);
+			}
+			void Add(double value) throw() {
+				AddValue(TYPE_DOUBLE, value);
+			}
+			void Add(bool value) throw() {
+				AddValue(TYPE_BOOL, value);
+			}
+
+			void Add(const char *value) throw() {
+				AddString(TYPE_STRING, value, strlen(value));
+			}
+			void Add(char *value) throw() {
+				Add(const_cast<const char *>(value));
+			}
+			void Add(const std::string &value) throw() {
+				AddString(TYPE_STRING, value.c_str(), value.size());
+			}
+			void Add(const ::TunnelEx::String &value) throw() {
+				AddString(TYPE_STRING, value.GetCStr(), value.GetLength());
+			}
+			void Add(const wchar_t *value) throw() {
+				AddString(TYPE_WSTRING, value, wcslen(value));
+			}
+			void Add(wchar_t *value) throw() {
+				Add(const_cast<const wchar_t *>(value));
+			}
+			void Add(const std::wstring &value) throw() {
+				AddString(TYPE_WSTRING, value.c_str(), value.size());
+			}
+			void Add(const ::TunnelEx::WString &value) throw() {
+				AddString(TYPE_WSTRING, value.GetCStr(), value.GetLength());
+			}
+
+			template<typename T>
+			void Add(const T &value) throw() {
+				try {
+					Add((::TunnelEx::Format("%1%") % value).str());
+				} catch (...) {
+					Add("<?>");
+				}
+			}
+
+		public:
+
+			const char * GetData() const throw() {
+				return &m_buffer[0];
+			}
+
+			size_t GetSize() const throw() {
+				return m_size;
+			}
+
+		private:
+
+			template<typename T>
+			void AddValue(Type type, const T &value) throw() {
+				assert(m_size + 1 + sizeof(value) <= sizeof(m_buffer));
+				m_buffer[m_size++] = char(type);
+				memcpy(&m_buffer[m_size], &value, sizeof(value));
+				m_size += sizeof(value);
+			}
+
+			template<typename Char>
+			void AddString(Type type, const Char *value, size_t length) throw() {
+				// keeps space for values, which can follow
+				const size_t reserve = 64;
+				size_t maxLength = sizeof(m_buffer) - m_size - 1 - sizeof(unsigned int);
+				maxLength = maxLength > reserve ? (maxLength - reserve) / sizeof(Char) : 0;
+				const unsigned int size
+					= static_cast<unsigned int>(std::min(length, maxLength));
+				m_buffer[m_size++] = char(type);
+				memcpy(&m_buffer[m_size], &size, sizeof(size));
+				m_size += sizeof(size);
+				memcpy(&m_buffer[m_size], value, size * sizeof(Char));
+				m_size += size * sizeof(Char);
+			}
+
+		private:
+
+			//! @todo: hardcoded log record arguments size
+			char m_buffer[1024];
+			size_t m_size;
+
+		};
+
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 
 	namespace Singletons {
@@ -80,11 +229,9 @@ namespace TunnelEx {
 				if (!IsDebugRegistrationOn()) {
 					return;
 				}
-				try {
-					AppendDebugDirect((TunnelEx::Format(str) % insert1).str());
-				} catch (...) {
-					AppendWarn((TunnelEx::Format("Format-error for the string \"%1%\".") % str).str());
-				}
+				Helpers::LogRecordArgs args;
+				args.Add(insert1);
+				AppendDebugDeferred(str, args);
 			}
 			//! Format and add debug message.
 			template<typename T1, typename T2>
@@ -92,11 +239,10 @@ namespace TunnelEx {
 				if (!IsDebugRegistrationOn()) {
 					return;
 				}
-				try {
-					AppendDebugDirect((TunnelEx::Format(str) % insert1 % insert2).str());
-				} catch (...) {
-					AppendWarn((TunnelEx::Format("Format-error for the string \"%1%\".") % str).str());
-				}
+				Helpers::LogRecordArgs args;
+				args.Add(insert1);
+				args.Add(insert2);
+				AppendDebugDeferred(str, args);
 			}
 			//! Format and add debug message.
 			template<typename T1, typename T2, typename T3>
@@ -109,11 +255,11 @@ namespace TunnelEx {
 				if (!IsDebugRegistrationOn()) {
 					return;
 				}
-				try {
-					AppendDebugDirect((TunnelEx::Format(str) % insert1 % insert2 % insert3).str());
-				} catch (...) {
-					AppendWarn((TunnelEx::Format("Format-error for the string \"%1%\".") % str).str());
-				}
+				Helpers::LogRecordArgs args;
+				args.Add(insert1);
+				args.Add(insert2);
+				args.Add(insert3);
+				AppendDebugDeferred(str, args);
 			}
 			//! Format and add debug message.
 			template<typename T1, typename T2, typename T3, typename T4>
@@ -127,11 +273,12 @@ namespace TunnelEx {
 				if (!IsDebugRegistrationOn()) {
 					return;
 				}
-				try {
-					AppendDebugDirect((TunnelEx::Format(str) % insert1 % insert2 % insert3 % insert4).str());
-				} catch (...) {
-					AppendWarn((TunnelEx::Format("Format-error for the string \"%1%\".") % str).str());
-				}
+				Helpers::LogRecordArgs args;
+				args.Add(insert1);
+				args.Add(insert2);
+				args.Add(insert3);
+				args.Add(insert4);
+				AppendDebugDeferred(str, args);
 			}
 			//! Format and add debug message.
 			template<typename T1, typename T2, typename T3, typename T4, typename T5>
@@ -146,11 +293,13 @@ namespace TunnelEx {
 				if (!IsDebugRegistrationOn()) {
 					return;
 				}
-				try {
-					AppendDebugDirect((TunnelEx::Format(str) % insert1 % insert2 % insert3 % insert4 % insert5).str());
-				} catch (...) {
-					AppendWarn((TunnelEx::Format("Format-error for the string \"%1%\".") % str).str());
-				}
+				Helpers::LogRecordArgs args;
+				args.Add(insert1);
+				args.Add(insert2);
+				args.Add(insert3);
+				args.Add(insert4);
+				args.Add(insert5);
+				AppendDebugDeferred(str, args);
 			}
 			//! Format and add debug message.
 			template<typename Formatter>
@@ -206,6 +355,21 @@ namespace TunnelEx {
 			LogLevel ResolveLevel(const char *levelName) const throw();
 
 			long GetSize() const;
+			//! Returns last written records from the memory.
+			/** Only limited number of last records is kept in the memory.
+			  * @param sinceSequenceNumber	returns only records after the record
+			  *								with this number, 0 or unknown
+			  *								number - all records;
+			  * @param maxNumber			maximum number of last records;
+			  * @param result				records, ordered by sequence number.
+			  */
+			void GetRecentRecords(
+						unsigned long sinceSequenceNumber,
+						size_t maxNumber,
+						std::vector<LogRecord> &result)
+					const;
+			//! Number of records dropped as log buffer was full.
+			long GetDroppedCount() const;
 
 			long GetWarnCount() const;
 			long GetErrorCount() const;
@@ -221,6 +385,9 @@ namespace TunnelEx {
 			void AppendDebugDirect(const ::TunnelEx::Format &) throw();
 			void AppendDebugDirect(const ::TunnelEx::WFormat &) throw();
 
+			void AppendDebugDeferred(const char *, const Helpers::LogRecordArgs &)
+				throw();
+
 		private:
 			
 			class Implementation;
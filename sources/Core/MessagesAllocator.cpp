@@ -9,6 +9,7 @@
 
 #include "Prec.h"
 #include "MessagesAllocator.hpp"
+#include "Metrics.hpp"
 
 using namespace TunnelEx;
 
@@ -26,13 +27,31 @@ const size_t MessagesAllocator::DefautConnectionBufferSize = 150 * 1024;
 MessagesAllocator::MessagesAllocator(
 			size_t messageBlocksCount,
 			size_t dataBlocksCount,
-			size_t dataBlockSize)
+			size_t dataBlockSize,
+			SharedPtr<RuleCounters> ruleCounters /*= SharedPtr<RuleCounters>()*/)
 		: m_dataBlockSize(dataBlockSize),
-		m_messageBlocksAllocator(messageBlocksCount),
-		m_messageBlockSatellitesAllocator(dataBlocksCount),
-		m_dataBlocksAllocator(dataBlocksCount),
-		m_dataBlocksBufferAllocator(dataBlocksCount, m_dataBlockSize) {
-	//...//
+		m_memorySize(
+			messageBlocksCount * sizeof(ACE_Message_Block)
+			+ dataBlocksCount
+				* (	sizeof(UniqueMessageBlockHolder::Satellite)
+					+ sizeof(ACE_Data_Block)
+					+ m_dataBlockSize)),
+		m_ruleCounters(ruleCounters),
+		m_counters(
+			Metrics::GetInstance().GetAllocators(),
+			m_ruleCounters ? &m_ruleCounters->GetAllocators() : nullptr),
+		m_messageBlocksAllocator(m_counters, messageBlocksCount),
+		m_messageBlockSatellitesAllocator(m_counters, dataBlocksCount),
+		m_dataBlocksAllocator(m_counters, dataBlocksCount),
+		m_dataBlocksBufferAllocator(
+			m_counters,
+			dataBlocksCount,
+			m_dataBlockSize) {
+	Metrics::GetInstance().OnAllocatorCreate(m_memorySize);
+}
+
+MessagesAllocator::~MessagesAllocator() {
+	Metrics::GetInstance().OnAllocatorDestroy(m_memorySize);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -12,6 +12,7 @@
 
 #include "MessagesAllocator.hpp"
 #include "MessageBlockHolder.hpp"
+#include "Metrics.hpp"
 #include "Locking.hpp"
 
 namespace TunnelEx {
@@ -23,36 +24,105 @@ namespace TunnelEx {
 		const static size_t DefautDataBlockSize;
 		const static size_t DefautConnectionBufferSize;
 
+		typedef Singletons::MetricsPolicy::AllocatorCounters Counters;
+		typedef Singletons::MetricsPolicy::RuleCounters RuleCounters;
+		typedef Singletons::MetricsPolicy::AllocatorPool Pool;
+
 	private:
 
-		class Mutex : private boost::noncopyable {
+		//! Pool with counters, which are changed under the pool lock.
+		/** Base pool is created without lock, so counting doesn't add
+		  * any interlocked operation to the pool lock.
+		  */
+		template<typename Base, Pool pool>
+		class InstrumentedAllocator : public Base {
+		private:
+			typedef SpinMutex PoolMutex;
+			typedef Lock<PoolMutex> PoolLock;
+		public:
+			explicit InstrumentedAllocator(
+						Counters &counters,
+						size_t chunksNumber)
+					: Base(chunksNumber),
+					m_counters(counters) {
+				//...//
+			}
+			explicit InstrumentedAllocator(
+						Counters &counters,
+						size_t chunksNumber,
+						size_t chunkSize)
+					: Base(chunksNumber, chunkSize),
+					m_counters(counters) {
+				//...//
+			}
+			virtual ~InstrumentedAllocator() {
+				//...//
+			}
 		public:
-			int acquire() {
-				m_impl.Acquire();
-				return 0;
+			virtual void * malloc(size_t size) {
+				const PoolLock lock(m_mutex);
+				return Register(Base::malloc(size));
+			}
+			virtual void * calloc(size_t size, char initialValue = '\0') {
+				const PoolLock lock(m_mutex);
+				return Register(Base::calloc(size, initialValue));
+			}
+			virtual void * calloc(
+						size_t elementsNumber,
+						size_t elementSize,
+						char initialValue = '\0') {
+				const PoolLock lock(m_mutex);
+				return Register(
+					Base::calloc(elementsNumber, elementSize, initialValue));
 			}
-			int release() {
-				m_impl.Release();
-				return 0;
+			virtual void free(void *ptr) {
+				const PoolLock lock(m_mutex);
+				if (ptr) {
+					m_counters.OnFree(pool);
+				}
+				Base::free(ptr);
+			}
+		private:
+			void * Register(void *ptr) throw() {
+				if (ptr) {
+					m_counters.OnAllocate(pool);
+				} else {
+					m_counters.OnFail(pool);
+				}
+				return ptr;
 			}
 		private:
-			SpinMutex m_impl;
+			PoolMutex m_mutex;
+			Counters &m_counters;
 		};
 
-		typedef ACE_Cached_Allocator<ACE_Message_Block, Mutex> MessageBlocksAllocator;
-		typedef ACE_Cached_Allocator<
-				UniqueMessageBlockHolder::Satellite,
-				Mutex>
+		typedef InstrumentedAllocator<
+				ACE_Cached_Allocator<ACE_Message_Block, ACE_Null_Mutex>,
+				Singletons::MetricsPolicy::ALLOCATOR_POOL_MESSAGE_BLOCKS>
+			MessageBlocksAllocator;
+		typedef InstrumentedAllocator<
+				ACE_Cached_Allocator<UniqueMessageBlockHolder::Satellite, ACE_Null_Mutex>,
+				Singletons::MetricsPolicy::ALLOCATOR_POOL_SATELLITES>
 			MessageBlockSatellitesAllocator;
-		typedef ACE_Cached_Allocator<ACE_Data_Block, Mutex> DataBlocksAllocator;
-		typedef ACE_Dynamic_Cached_Allocator<Mutex> DataBlocksBufferAllocator;
+		typedef InstrumentedAllocator<
+				ACE_Cached_Allocator<ACE_Data_Block, ACE_Null_Mutex>,
+				Singletons::MetricsPolicy::ALLOCATOR_POOL_DATA_BLOCKS>
+			DataBlocksAllocator;
+		typedef InstrumentedAllocator<
+				ACE_Dynamic_Cached_Allocator<ACE_Null_Mutex>,
+				Singletons::MetricsPolicy::ALLOCATOR_POOL_DATA_BUFFERS>
+			DataBlocksBufferAllocator;
 
 	public:
 		
+		//! Allocations are also counted for the rule, if rule counters are
+		//! set. Allocator holds rule counters until destruction.
 		explicit MessagesAllocator(
 				size_t messageBlocksCount,
 				size_t dataBlocksCount,
-				size_t dataBlockSize);
+				size_t dataBlockSize,
+				SharedPtr<RuleCounters> ruleCounters = SharedPtr<RuleCounters>());
+		~MessagesAllocator();
 
 	public:
 
@@ -79,6 +149,9 @@ namespace TunnelEx {
 	private:
 
 		const size_t m_dataBlockSize;
+		const size_t m_memorySize;
+		const SharedPtr<RuleCounters> m_ruleCounters;
+		Counters m_counters;
 
 		MessageBlocksAllocator m_messageBlocksAllocator;
 		MessageBlockSatellitesAllocator m_messageBlockSatellitesAllocator;
@@ -0,0 +1,499 @@
+/**************************************************************************
+ *   Created: 2026/10/19 16:24
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Metrics.hpp"
+#include "Log.hpp"
+
+using namespace TunnelEx;
+using namespace TunnelEx::Singletons;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//! @todo: hardcoded latency histogram buckets (microseconds)
+	const long long latencyBuckets[] = {
+		100,
+		250,
+		500,
+		1000,
+		2500,
+		5000,
+		10000,
+		25000,
+		50000,
+		100000,
+		250000,
+		500000,
+		1000000
+	};
+	const size_t latencyBucketsNumber
+		= sizeof(latencyBuckets) / sizeof(latencyBuckets[0]);
+
+	long long Read(const volatile long long &value) throw() {
+		return Interlocked::CompareExchange(
+			const_cast<volatile long long &>(value),
+			0,
+			0);
+	}
+
+	double ToSeconds(long long microseconds) {
+		return double(microseconds) / 1000000;
+	}
+
+	void DumpAllocatorsStat(
+				const char *owner,
+				const MetricsPolicy::AllocatorsStat &stat) {
+		Format message("Allocators %1%:");
+		message % owner;
+		std::string messageStr = message.str();
+		for (int i = 0; i < MetricsPolicy::numberOfAllocatorPools; ++i) {
+			Format poolMessage(" %1%: %2%/%3%/%4%;");
+			poolMessage
+				% MetricsPolicy::GetAllocatorPoolName(MetricsPolicy::AllocatorPool(i))
+				% stat.pools[i].live
+				% stat.pools[i].peak
+				% stat.pools[i].fails;
+			messageStr += poolMessage.str();
+		}
+		Log::GetInstance().AppendDebug(messageStr);
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+class MetricsPolicy::Implementation : private boost::noncopyable {
+
+public:
+
+	typedef ACE_Thread_Mutex RulesMutex;
+	typedef ACE_Guard<RulesMutex> RulesLock;
+	typedef std::map<std::wstring, SharedPtr<RuleCounters> > Rules;
+	//! Export works with the copy of the registry, so tunnels opening
+	//! doesn't wait for the export.
+	typedef std::vector<Rules::value_type> RulesSnapshot;
+
+	typedef ACE_Thread_Mutex SourcesMutex;
+	typedef ACE_Guard<SourcesMutex> SourcesLock;
+	typedef std::vector<const Source *> Sources;
+
+public:
+
+	Implementation()
+			: m_latencySum(0),
+			m_allocatorsNumber(0),
+			m_allocatorsMemorySize(0),
+			m_tunnelOpeningQueueSize(0) {
+		for (size_t i = 0; i <= latencyBucketsNumber; ++i) {
+			m_latencyBuckets[i] = 0;
+		}
+	}
+
+public:
+
+	SharedPtr<RuleCounters> GetRuleCounters(const WString &ruleUuid) {
+		const std::wstring uuid(ruleUuid.GetCStr());
+		RulesLock lock(m_rulesMutex);
+		const Rules::iterator pos = m_rules.lower_bound(uuid);
+		if (pos != m_rules.end() && pos->first == uuid) {
+			return pos->second;
+		}
+		SharedPtr<RuleCounters> result(new RuleCounters);
+		m_rules.insert(pos, std::make_pair(uuid, result));
+		return result;
+	}
+
+	void RemoveRuleCounters(const WString &ruleUuid) throw() {
+		const std::wstring uuid(ruleUuid.GetCStr());
+		RulesLock lock(m_rulesMutex);
+		m_rules.erase(uuid);
+	}
+
+	void CollectLatency(long long microseconds) throw() {
+		const long long *const bucket = std::lower_bound(
+			latencyBuckets,
+			latencyBuckets + latencyBucketsNumber,
+			microseconds);
+		Interlocked::ExchangeAdd(m_latencyBuckets[bucket - latencyBuckets], 1);
+		Interlocked::ExchangeAdd(m_latencySum, microseconds);
+	}
+
+	void OnAllocatorCreate(size_t memorySize) throw() {
+		Interlocked::Increment(m_allocatorsNumber);
+		Interlocked::ExchangeAdd(m_allocatorsMemorySize, memorySize);
+	}
+
+	void OnAllocatorDestroy(size_t memorySize) throw() {
+		Interlocked::Decrement(m_allocatorsNumber);
+		Interlocked::ExchangeAdd(m_allocatorsMemorySize, -(long long)(memorySize));
+	}
+
+	void SetTunnelOpeningQueueSize(size_t size) throw() {
+		Interlocked::Exchange(m_tunnelOpeningQueueSize, long(size));
+	}
+
+	AllocatorCountersGroup & GetAllocators() throw() {
+		return m_allocatorPools;
+	}
+
+	void RegisterSource(const Source &source) {
+		SourcesLock lock(m_sourcesMutex);
+		assert(
+			std::find(m_sources.begin(), m_sources.end(), &source)
+			== m_sources.end());
+		m_sources.push_back(&source);
+	}
+
+	void UnregisterSource(const Source &source) throw() {
+		SourcesLock lock(m_sourcesMutex);
+		const Sources::iterator pos
+			= std::find(m_sources.begin(), m_sources.end(), &source);
+		assert(pos != m_sources.end());
+		if (pos != m_sources.end()) {
+			m_sources.erase(pos);
+		}
+	}
+
+	void GetAllocatorsStat(std::vector<AllocatorsStat> &result) const {
+		RulesSnapshot rules;
+		GetRules(rules);
+		std::vector<AllocatorsStat> stat(rules.size() + 1);
+		m_allocatorPools.GetStat(stat[0]);
+		size_t i = 1;
+		foreach (const Rules::value_type &rule, rules) {
+			stat[i].ruleUuid = rule.first.c_str();
+			rule.second->GetAllocators().GetStat(stat[i]);
+			++i;
+		}
+		stat.swap(result);
+	}
+
+	void DumpAllocators() const {
+		if (!Log::GetInstance().IsDebugRegistrationOn()) {
+			return;
+		}
+		std::vector<AllocatorsStat> stat;
+		GetAllocatorsStat(stat);
+		DumpAllocatorsStat("total", stat[0]);
+		for (size_t i = 1; i < stat.size(); ++i) {
+			DumpAllocatorsStat(
+				ConvertString<String>(stat[i].ruleUuid).GetCStr(),
+				stat[i]);
+		}
+	}
+
+public:
+
+	void Export(std::string &result) const {
+
+		std::ostringstream os;
+		os.imbue(std::locale::classic());
+
+		RulesSnapshot rules;
+		GetRules(rules);
+
+		AllocatorsStat allocators;
+		m_allocatorPools.GetStat(allocators);
+		std::vector<AllocatorsStat> ruleAllocators(rules.size());
+		for (size_t i = 0; i < rules.size(); ++i) {
+			rules[i].second->GetAllocators().GetStat(ruleAllocators[i]);
+		}
+
+		const char *const directions[numberOfDirections] = {
+			"to_destination",
+			"to_source"
+		};
+
+		os << "# HELP tunnelex_rule_bytes_total Bytes sent through rule tunnels." << std::endl;
+		os << "# TYPE tunnelex_rule_bytes_total counter" << std::endl;
+		foreach (const Rules::value_type &rule, rules) {
+			for (int i = 0; i < numberOfDirections; ++i) {
+				os
+					<< "tunnelex_rule_bytes_total{rule=\"" << GetLabel(rule.first)
+					<< "\",direction=\"" << directions[i] << "\"} "
+					<< rule.second->GetBytes(Direction(i)) << std::endl;
+			}
+		}
+
+		os << "# HELP tunnelex_rule_packets_total Packets sent through rule tunnels." << std::endl;
+		os << "# TYPE tunnelex_rule_packets_total counter" << std::endl;
+		foreach (const Rules::value_type &rule, rules) {
+			for (int i = 0; i < numberOfDirections; ++i) {
+				os
+					<< "tunnelex_rule_packets_total{rule=\"" << GetLabel(rule.first)
+					<< "\",direction=\"" << directions[i] << "\"} "
+					<< rule.second->GetPackets(Direction(i)) << std::endl;
+			}
+		}
+
+		os << "# HELP tunnelex_rule_active_tunnels Currently open rule tunnels." << std::endl;
+		os << "# TYPE tunnelex_rule_active_tunnels gauge" << std::endl;
+		long activeTunnels = 0;
+		foreach (const Rules::value_type &rule, rules) {
+			const long ruleActiveTunnels = rule.second->GetActiveTunnels();
+			os
+				<< "tunnelex_rule_active_tunnels{rule=\"" << GetLabel(rule.first) << "\"} "
+				<< ruleActiveTunnels << std::endl;
+			activeTunnels += ruleActiveTunnels;
+		}
+		os << "# HELP tunnelex_active_tunnels Currently open tunnels." << std::endl;
+		os << "# TYPE tunnelex_active_tunnels gauge" << std::endl;
+		os << "tunnelex_active_tunnels " << activeTunnels << std::endl;
+
+		os << "# HELP tunnelex_rule_accepted_connections_total Accepted incoming connections." << std::endl;
+		os << "# TYPE tunnelex_rule_accepted_connections_total counter" << std::endl;
+		foreach (const Rules::value_type &rule, rules) {
+			os
+				<< "tunnelex_rule_accepted_connections_total{rule=\"" << GetLabel(rule.first) << "\"} "
+				<< rule.second->GetAccepted() << std::endl;
+		}
+
+		os << "# HELP tunnelex_rule_setup_failures_total Failed tunnel setups." << std::endl;
+		os << "# TYPE tunnelex_rule_setup_failures_total counter" << std::endl;
+		foreach (const Rules::value_type &rule, rules) {
+			os
+				<< "tunnelex_rule_setup_failures_total{rule=\"" << GetLabel(rule.first) << "\"} "
+				<< rule.second->GetSetupFails() << std::endl;
+		}
+
+		os << "# HELP tunnelex_message_latency_seconds Message full latency, from receiving start to sending end." << std::endl;
+		os << "# TYPE tunnelex_message_latency_seconds histogram" << std::endl;
+		{
+			long long cumulative = 0;
+			for (size_t i = 0; i < latencyBucketsNumber; ++i) {
+				cumulative += Read(m_latencyBuckets[i]);
+				os
+					<< "tunnelex_message_latency_seconds_bucket{le=\""
+					<< ToSeconds(latencyBuckets[i]) << "\"} "
+					<< cumulative << std::endl;
+			}
+			cumulative += Read(m_latencyBuckets[latencyBucketsNumber]);
+			os
+				<< "tunnelex_message_latency_seconds_bucket{le=\"+Inf\"} "
+				<< cumulative << std::endl;
+			os
+				<< "tunnelex_message_latency_seconds_sum "
+				<< ToSeconds(Read(m_latencySum)) << std::endl;
+			os
+				<< "tunnelex_message_latency_seconds_count "
+				<< cumulative << std::endl;
+		}
+
+		os << "# HELP tunnelex_allocators Message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_allocators gauge" << std::endl;
+		os << "tunnelex_allocators " << m_allocatorsNumber << std::endl;
+		os << "# HELP tunnelex_allocators_memory_bytes Memory preallocated by message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_allocators_memory_bytes gauge" << std::endl;
+		os << "tunnelex_allocators_memory_bytes " << Read(m_allocatorsMemorySize) << std::endl;
+
+		os << "# HELP tunnelex_allocator_pool_live Allocated blocks of message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_allocator_pool_live gauge" << std::endl;
+		for (int i = 0; i < numberOfAllocatorPools; ++i) {
+			os
+				<< "tunnelex_allocator_pool_live{pool=\"" << GetAllocatorPoolName(AllocatorPool(i)) << "\"} "
+				<< allocators.pools[i].live << std::endl;
+		}
+		os << "# HELP tunnelex_allocator_pool_peak Sum of high-water marks of allocated blocks of live message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_allocator_pool_peak gauge" << std::endl;
+		for (int i = 0; i < numberOfAllocatorPools; ++i) {
+			os
+				<< "tunnelex_allocator_pool_peak{pool=\"" << GetAllocatorPoolName(AllocatorPool(i)) << "\"} "
+				<< allocators.pools[i].peak << std::endl;
+		}
+		os << "# HELP tunnelex_allocator_pool_failures_total Failed allocations from message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_allocator_pool_failures_total counter" << std::endl;
+		for (int i = 0; i < numberOfAllocatorPools; ++i) {
+			os
+				<< "tunnelex_allocator_pool_failures_total{pool=\"" << GetAllocatorPoolName(AllocatorPool(i)) << "\"} "
+				<< allocators.pools[i].fails << std::endl;
+		}
+
+		os << "# HELP tunnelex_rule_allocator_pool_live Allocated blocks of rule tunnels message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_rule_allocator_pool_live gauge" << std::endl;
+		for (size_t r = 0; r < rules.size(); ++r) {
+			for (int i = 0; i < numberOfAllocatorPools; ++i) {
+				os
+					<< "tunnelex_rule_allocator_pool_live{rule=\"" << GetLabel(rules[r].first)
+					<< "\",pool=\"" << GetAllocatorPoolName(AllocatorPool(i)) << "\"} "
+					<< ruleAllocators[r].pools[i].live << std::endl;
+			}
+		}
+		os << "# HELP tunnelex_rule_allocator_pool_peak Sum of high-water marks of allocated blocks of live rule tunnels message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_rule_allocator_pool_peak gauge" << std::endl;
+		for (size_t r = 0; r < rules.size(); ++r) {
+			for (int i = 0; i < numberOfAllocatorPools; ++i) {
+				os
+					<< "tunnelex_rule_allocator_pool_peak{rule=\"" << GetLabel(rules[r].first)
+					<< "\",pool=\"" << GetAllocatorPoolName(AllocatorPool(i)) << "\"} "
+					<< ruleAllocators[r].pools[i].peak << std::endl;
+			}
+		}
+		os << "# HELP tunnelex_rule_allocator_pool_failures_total Failed allocations from rule tunnels message allocators pools." << std::endl;
+		os << "# TYPE tunnelex_rule_allocator_pool_failures_total counter" << std::endl;
+		for (size_t r = 0; r < rules.size(); ++r) {
+			for (int i = 0; i < numberOfAllocatorPools; ++i) {
+				os
+					<< "tunnelex_rule_allocator_pool_failures_total{rule=\"" << GetLabel(rules[r].first)
+					<< "\",pool=\"" << GetAllocatorPoolName(AllocatorPool(i)) << "\"} "
+					<< ruleAllocators[r].pools[i].fails << std::endl;
+			}
+		}
+
+		os << "# HELP tunnelex_tunnel_opening_queue_size Connections and tunnels waiting for the tunnel opening thread." << std::endl;
+		os << "# TYPE tunnelex_tunnel_opening_queue_size gauge" << std::endl;
+		os << "tunnelex_tunnel_opening_queue_size " << m_tunnelOpeningQueueSize << std::endl;
+
+		std::string resultTmp = os.str();
+		{
+			SourcesLock lock(m_sourcesMutex);
+			foreach (const Source *source, m_sources) {
+				source->Export(resultTmp);
+			}
+		}
+		resultTmp.swap(result);
+
+	}
+
+private:
+
+	void GetRules(RulesSnapshot &result) const {
+		RulesLock lock(m_rulesMutex);
+		result.assign(m_rules.begin(), m_rules.end());
+	}
+
+	static std::string GetLabel(const std::wstring &value) {
+		const String source = ConvertString<String>(value.c_str());
+		std::string result;
+		result.reserve(source.GetLength());
+		for (const char *i = source.GetCStr(); *i; ++i) {
+			if (*i == '\\' || *i == '"') {
+				result.push_back('\\');
+			}
+			result.push_back(*i);
+		}
+		return result;
+	}
+
+private:
+
+	mutable RulesMutex m_rulesMutex;
+	Rules m_rules;
+
+	volatile long long m_latencyBuckets[latencyBucketsNumber + 1];
+	volatile long long m_latencySum;
+
+	volatile long m_allocatorsNumber;
+	volatile long long m_allocatorsMemorySize;
+	AllocatorCountersGroup m_allocatorPools;
+
+	volatile long m_tunnelOpeningQueueSize;
+
+	mutable SourcesMutex m_sourcesMutex;
+	Sources m_sources;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+MetricsPolicy::MetricsPolicy()
+		: m_pimpl(new Implementation) {
+	//...//
+}
+
+MetricsPolicy::~MetricsPolicy() {
+	delete m_pimpl;
+}
+
+SharedPtr<MetricsPolicy::RuleCounters> MetricsPolicy::GetRuleCounters(
+			const WString &ruleUuid) {
+	return m_pimpl->GetRuleCounters(ruleUuid);
+}
+
+void MetricsPolicy::RemoveRuleCounters(const WString &ruleUuid) throw() {
+	m_pimpl->RemoveRuleCounters(ruleUuid);
+}
+
+void MetricsPolicy::CollectLatency(long long microseconds) throw() {
+	m_pimpl->CollectLatency(microseconds);
+}
+
+void MetricsPolicy::OnAllocatorCreate(size_t memorySize) throw() {
+	m_pimpl->OnAllocatorCreate(memorySize);
+}
+
+void MetricsPolicy::OnAllocatorDestroy(size_t memorySize) throw() {
+	m_pimpl->OnAllocatorDestroy(memorySize);
+}
+
+MetricsPolicy::AllocatorCountersGroup & MetricsPolicy::GetAllocators() throw() {
+	return m_pimpl->GetAllocators();
+}
+
+const char * MetricsPolicy::GetAllocatorPoolName(AllocatorPool pool) throw() {
+	static_assert(numberOfAllocatorPools == 4, "Allocator pools list changed.");
+	switch (pool) {
+		case ALLOCATOR_POOL_MESSAGE_BLOCKS:
+			return "message_blocks";
+		case ALLOCATOR_POOL_SATELLITES:
+			return "satellites";
+		case ALLOCATOR_POOL_DATA_BLOCKS:
+			return "data_blocks";
+		case ALLOCATOR_POOL_DATA_BUFFERS:
+			return "data_buffers";
+		default:
+			assert(false);
+			return "unknown";
+	}
+}
+
+void MetricsPolicy::GetAllocatorsStat(std::vector<AllocatorsStat> &result) const {
+	m_pimpl->GetAllocatorsStat(result);
+}
+
+void MetricsPolicy::DumpAllocators() const throw() {
+	try {
+		m_pimpl->DumpAllocators();
+	} catch (...) {
+		assert(false);
+		Log::GetInstance().AppendDebug("Failed to build allocators report.");
+	}
+}
+
+void MetricsPolicy::SetTunnelOpeningQueueSize(size_t size) throw() {
+	m_pimpl->SetTunnelOpeningQueueSize(size);
+}
+
+void MetricsPolicy::RegisterSource(const Source &source) {
+	m_pimpl->RegisterSource(source);
+}
+
+void MetricsPolicy::UnregisterSource(const Source &source) throw() {
+	m_pimpl->UnregisterSource(source);
+}
+
+void MetricsPolicy::Export(std::string &result) const {
+	m_pimpl->Export(result);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#if TEMPLATES_REQUIRE_SOURCE != 0
+#	include "Singleton.cpp"
+	namespace {
+		//! Only for template instantiation.
+		void MakeMetricsTemplateInstantiation() {
+			Metrics::GetInstance();
+		}
+	}
+#endif // TEMPLATES_REQUIRE_SOURCE
+
+//////////////////////////////////////////////////////////////////////////
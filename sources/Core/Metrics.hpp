@@ -0,0 +1,414 @@
+/**************************************************************************
+ *   Created: 2026/10/19 16:05
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__Metrics_hpp__2610191605
+#define INCLUDED_FILE__TUNNELEX__Metrics_hpp__2610191605
+
+#include "Singleton.hpp"
+#include "Api.h"
+#include "String.hpp"
+#include "SmartPtr.hpp"
+#include "Locking.hpp"
+
+namespace TunnelEx {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace Singletons {
+
+		//! Runtime metrics real class.
+		/** To get instance please use the Metrics-singleton. Counters are
+		  * changed only by interlocked operations or under the lock, which
+		  * the data path takes anyway, so the data path never waits for the
+		  * export. Allocator counters are summed only at the export.
+		  */
+		class TUNNELEX_CORE_API MetricsPolicy {
+
+			template<typename T, template<class> class L, template<class> class Th>
+			friend class Holder;
+
+		public:
+
+			enum Direction {
+				DIRECTION_TO_DESTINATION,
+				DIRECTION_TO_SOURCE,
+				numberOfDirections
+			};
+
+			//! Pools of the messages allocator.
+			enum AllocatorPool {
+				ALLOCATOR_POOL_MESSAGE_BLOCKS,
+				ALLOCATOR_POOL_SATELLITES,
+				ALLOCATOR_POOL_DATA_BLOCKS,
+				ALLOCATOR_POOL_DATA_BUFFERS,
+				numberOfAllocatorPools
+			};
+
+			//! Allocator pools counters snapshot.
+			struct AllocatorsStat {
+
+				struct Pool {
+					long live;
+					long peak;
+					long long fails;
+				};
+
+				//! Empty for process-wide stat.
+				WString ruleUuid;
+				Pool pools[numberOfAllocatorPools];
+
+			};
+
+			class AllocatorCountersGroup;
+
+			//! Counters of the one messages allocator.
+			/** Each pool changes its counters only under its own lock, so
+			  * counters are not interlocked. Peak is the high-water mark of
+			  * live allocations. Counters are registered in the process-wide
+			  * group and in the rule group, groups sum it at reading.
+			  */
+			class AllocatorCounters {
+
+				friend class AllocatorCountersGroup;
+
+			public:
+
+				explicit AllocatorCounters(
+							AllocatorCountersGroup &processGroup,
+							AllocatorCountersGroup *ruleGroup)
+						throw() {
+					for (int i = 0; i < numberOfAllocatorPools; ++i) {
+						m_live[i] = 0;
+						m_peak[i] = 0;
+						m_fails[i] = 0;
+					}
+					m_processLink.owner = this;
+					m_processLink.group = &processGroup;
+					m_ruleLink.owner = this;
+					m_ruleLink.group = ruleGroup;
+					processGroup.Register(m_processLink);
+					if (ruleGroup) {
+						ruleGroup->Register(m_ruleLink);
+					}
+				}
+
+				~AllocatorCounters() throw() {
+					if (m_ruleLink.group) {
+						m_ruleLink.group->Unregister(m_ruleLink);
+					}
+					m_processLink.group->Unregister(m_processLink);
+				}
+
+			private:
+
+				AllocatorCounters(const AllocatorCounters &);
+				const AllocatorCounters & operator =(const AllocatorCounters &);
+
+			public:
+
+				void OnAllocate(AllocatorPool pool) throw() {
+					assert(pool < numberOfAllocatorPools);
+					const long live = ++m_live[pool];
+					if (live > m_peak[pool]) {
+						m_peak[pool] = live;
+					}
+				}
+
+				void OnFree(AllocatorPool pool) throw() {
+					assert(pool < numberOfAllocatorPools);
+					--m_live[pool];
+				}
+
+				void OnFail(AllocatorPool pool) throw() {
+					assert(pool < numberOfAllocatorPools);
+					++m_fails[pool];
+				}
+
+			private:
+
+				//! Group list item.
+				struct Link {
+					AllocatorCounters *owner;
+					AllocatorCountersGroup *group;
+					Link *prev;
+					Link *next;
+				};
+
+			private:
+
+				volatile long m_live[numberOfAllocatorPools];
+				volatile long m_peak[numberOfAllocatorPools];
+				volatile long m_fails[numberOfAllocatorPools];
+
+				Link m_processLink;
+				Link m_ruleLink;
+
+			};
+
+			//! Sums counters of the registered allocators at reading.
+			/** Peak of the group is the sum of the allocators peaks.
+			  */
+			class AllocatorCountersGroup {
+
+				friend class AllocatorCounters;
+
+			public:
+
+				AllocatorCountersGroup() throw()
+						: m_first(nullptr) {
+					for (int i = 0; i < numberOfAllocatorPools; ++i) {
+						m_closedFails[i] = 0;
+					}
+				}
+
+				~AllocatorCountersGroup() throw() {
+					assert(!m_first);
+				}
+
+			private:
+
+				AllocatorCountersGroup(const AllocatorCountersGroup &);
+				const AllocatorCountersGroup & operator =(
+						const AllocatorCountersGroup &);
+
+			public:
+
+				void GetStat(AllocatorsStat &result) const throw() {
+					const Lock<SpinMutex> lock(m_mutex);
+					for (int i = 0; i < numberOfAllocatorPools; ++i) {
+						result.pools[i].live = 0;
+						result.pools[i].peak = 0;
+						result.pools[i].fails = m_closedFails[i];
+					}
+					for (	const AllocatorCounters::Link *link = m_first;
+							link;
+							link = link->next) {
+						const AllocatorCounters &counters = *link->owner;
+						for (int i = 0; i < numberOfAllocatorPools; ++i) {
+							result.pools[i].live += counters.m_live[i];
+							result.pools[i].peak += counters.m_peak[i];
+							result.pools[i].fails += counters.m_fails[i];
+						}
+					}
+				}
+
+			private:
+
+				void Register(AllocatorCounters::Link &link) throw() {
+					assert(link.group == this);
+					const Lock<SpinMutex> lock(m_mutex);
+					link.prev = nullptr;
+					link.next = m_first;
+					if (m_first) {
+						m_first->prev = &link;
+					}
+					m_first = &link;
+				}
+
+				void Unregister(AllocatorCounters::Link &link) throw() {
+					assert(link.group == this);
+					const Lock<SpinMutex> lock(m_mutex);
+					if (link.prev) {
+						link.prev->next = link.next;
+					} else {
+						assert(m_first == &link);
+						m_first = link.next;
+					}
+					if (link.next) {
+						link.next->prev = link.prev;
+					}
+					for (int i = 0; i < numberOfAllocatorPools; ++i) {
+						m_closedFails[i] += link.owner->m_fails[i];
+					}
+				}
+
+			private:
+
+				mutable SpinMutex m_mutex;
+				AllocatorCounters::Link *m_first;
+				//! Failures of the already destroyed allocators.
+				long long m_closedFails[numberOfAllocatorPools];
+
+			};
+
+			//! Rule counters.
+			class RuleCounters {
+
+			public:
+
+				RuleCounters() throw()
+						: m_activeTunnels(0),
+						m_accepted(0),
+						m_setupFails(0) {
+					for (int i = 0; i < numberOfDirections; ++i) {
+						m_bytes[i] = 0;
+						m_packets[i] = 0;
+					}
+				}
+
+			private:
+
+				RuleCounters(const RuleCounters &);
+				const RuleCounters & operator =(const RuleCounters &);
+
+			public:
+
+				void AddTraffic(Direction direction, size_t size) throw() {
+					assert(direction < numberOfDirections);
+					Interlocked::ExchangeAdd(m_bytes[direction], size);
+					Interlocked::ExchangeAdd(m_packets[direction], 1);
+				}
+
+				void OnTunnelOpen() throw() {
+					Interlocked::Increment(m_activeTunnels);
+				}
+				void OnTunnelClose() throw() {
+					Interlocked::Decrement(m_activeTunnels);
+				}
+
+				void OnAccept() throw() {
+					Interlocked::ExchangeAdd(m_accepted, 1);
+				}
+
+				void OnSetupFail() throw() {
+					Interlocked::ExchangeAdd(m_setupFails, 1);
+				}
+
+			public:
+
+				long long GetBytes(Direction direction) const throw() {
+					assert(direction < numberOfDirections);
+					return Read(m_bytes[direction]);
+				}
+				long long GetPackets(Direction direction) const throw() {
+					assert(direction < numberOfDirections);
+					return Read(m_packets[direction]);
+				}
+				long GetActiveTunnels() const throw() {
+					return m_activeTunnels;
+				}
+				long long GetAccepted() const throw() {
+					return Read(m_accepted);
+				}
+				long long GetSetupFails() const throw() {
+					return Read(m_setupFails);
+				}
+
+				AllocatorCountersGroup & GetAllocators() throw() {
+					return m_allocators;
+				}
+				const AllocatorCountersGroup & GetAllocators() const throw() {
+					return m_allocators;
+				}
+
+			private:
+
+				static long long Read(const volatile long long &value) throw() {
+					return Interlocked::CompareExchange(
+						const_cast<volatile long long &>(value),
+						0,
+						0);
+				}
+
+			private:
+
+				volatile long long m_bytes[numberOfDirections];
+				volatile long long m_packets[numberOfDirections];
+				volatile long m_activeTunnels;
+				volatile long long m_accepted;
+				volatile long long m_setupFails;
+
+				AllocatorCountersGroup m_allocators;
+
+			};
+
+			//! Metrics of other module.
+			/** Source is asked for the values at each export.
+			  */
+			class Source {
+			public:
+				virtual ~Source() throw() {
+					//...//
+				}
+			public:
+				//! Appends metrics in the Prometheus text format.
+				virtual void Export(std::string &) const = 0;
+			};
+
+		private:
+
+			MetricsPolicy();
+			MetricsPolicy(const MetricsPolicy &);
+			~MetricsPolicy();
+			const MetricsPolicy & operator =(const MetricsPolicy &);
+			MetricsPolicy * operator *();
+
+		public:
+
+			//! Returns rule counters, creates it at the first call.
+			/** Locks the registry, so should be called only at the tunnel
+			  * or the rule opening, not for each packet.
+			  */
+			SharedPtr<RuleCounters> GetRuleCounters(const WString &ruleUuid);
+			//! Removes rule counters from the export.
+			/** Tunnels which are still open keep its counters until closing.
+			  */
+			void RemoveRuleCounters(const WString &ruleUuid) throw();
+
+			void CollectLatency(long long microseconds) throw();
+
+			void OnAllocatorCreate(size_t memorySize) throw();
+			void OnAllocatorDestroy(size_t memorySize) throw();
+
+			//! Process-wide allocator pools counters.
+			AllocatorCountersGroup & GetAllocators() throw();
+
+			static const char * GetAllocatorPoolName(AllocatorPool) throw();
+
+			//! Returns process-wide allocators stat and stat for each rule.
+			/** Process-wide stat is the first.
+			  */
+			void GetAllocatorsStat(std::vector<AllocatorsStat> &) const;
+
+			//! Appends allocators summary to the debug log.
+			void DumpAllocators() const throw();
+
+			void SetTunnelOpeningQueueSize(size_t) throw();
+
+		public:
+
+			//! Registers metrics of other module.
+			/** Source has to be unregistered before destruction, unregistering
+			  * waits for the export end.
+			  */
+			void RegisterSource(const Source &);
+			void UnregisterSource(const Source &) throw();
+
+			//! Exports all metrics in the Prometheus text format.
+			void Export(std::string &) const;
+
+		private:
+
+			class Implementation;
+			Implementation *m_pimpl;
+
+		};
+
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Runtime metrics. Is a singleton.
+	typedef Singletons::Holder<Singletons::MetricsPolicy, Singletons::PhoenixLifetime> Metrics;
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__Metrics_hpp__2610191605
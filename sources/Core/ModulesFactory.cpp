@@ -13,6 +13,7 @@
 #include "Connection.hpp"
 #include "Service.hpp"
 #include "TrafficLogger.hpp"
+#include "TrafficCapture.hpp"
 #include "Rule.hpp"
 #include "Log.hpp"
 #include "EndpointAddress.hpp"
@@ -160,6 +161,10 @@ public:
 			std::make_pair<std::wstring, ListenerFabric>(
 				L"TrafficLogger/File",
 				ListenerFabric(&CreateListenerModule<TrafficLogger>)));
+		m_listenerFabricCollection.insert(
+			std::make_pair<std::wstring, ListenerFabric>(
+				L"TrafficLogger/Capture",
+				ListenerFabric(&CreateListenerModule<TrafficCapture>)));
 
 		try {
 
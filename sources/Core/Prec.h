@@ -44,6 +44,7 @@
 #	include <ace/Recursive_Thread_Mutex.h>
 #	include <ace/Condition_T.h>
 #	include <ace/Thread_Manager.h>
+#	include <ace/Auto_Event.h>
 #	include <ace/Message_Block.h>
 #	include <ace/Malloc_T.h>
 #	include <ace/Event_Handler.h>
@@ -54,10 +55,13 @@
 #	include <ace/OS_NS_unistd.h>
 #	include <ace/Atomic_Op.h>
 #	include <ace/INET_Addr.h>
+#	include <ace/Singleton.h>
+#	include <ace/TSS_T.h>
 #include "CompileWarningsAce.h"
 
 #include "CompileWarningsBoost.h"
 #	include <boost/shared_ptr.hpp>
+#	include <boost/weak_ptr.hpp>
 #	include <boost/noncopyable.hpp>
 #	include <boost/filesystem.hpp>
 #	include <boost/bind.hpp>
@@ -79,6 +83,7 @@
 #	include <boost/date_time.hpp>
 #	include <boost/unordered_map.hpp>
 #	include <boost/static_assert.hpp>
+#	include <boost/crc.hpp>
 #	include <boost/accumulators/accumulators.hpp>
 #	include <boost/accumulators/statistics/stats.hpp>
 #	include <boost/accumulators/statistics/mean.hpp>
@@ -98,6 +103,7 @@
 #include <map>
 #include <string>
 #include <numeric>
+#include <algorithm>
 #include <exception>
 
 #endif
@@ -370,6 +370,48 @@ namespace TunnelEx {
 
 	//////////////////////////////////////////////////////////////////////////
 
+	//! Compiled rule set XML-schema, parsed at first use and shared by all threads.
+	class RuleSetSchemaCache : private boost::noncopyable {
+
+	public:
+
+		typedef ACE_Thread_Mutex Mutex;
+		typedef ACE_Guard<Mutex> Lock;
+
+	public:
+
+		RuleSetSchemaCache() {
+			//...//
+		}
+
+	public:
+
+		//! Returns compiled schema.
+		/** @throw Schema::ParseException
+		  */
+		boost::shared_ptr<const Schema> Get() {
+			const Lock lock(m_mutex);
+			if (!m_schema) {
+				fs::path schemaFile(GetModuleFilePathA().branch_path());
+				schemaFile /= "RuleSet.xsd";
+				m_schema.reset(new Schema(schemaFile.string()));
+			}
+			return m_schema;
+		}
+
+	private:
+
+		Mutex m_mutex;
+		boost::shared_ptr<const Schema> m_schema;
+
+	};
+
+	namespace {
+		RuleSetSchemaCache ruleSetSchemaCache;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	class RuleEntitySetXmlSaver {
 
 	public:
@@ -384,7 +426,8 @@ namespace TunnelEx {
 		void Save(
 					const ServiceRuleSet &serviceRuleSet,
 					const TunnelRuleSet &tunnelRuleSet,
-					XmlString &result)
+					XmlString &result,
+					bool isValidationRequired)
 				const {
 
 			boost::shared_ptr<Document> doc(Document::CreateNew("RuleSet"));
@@ -394,12 +437,20 @@ namespace TunnelEx {
 			SaveServiceRuleSet(serviceRuleSet, *root);
 			SaveTunnelRuleSet(tunnelRuleSet, *root);
 			
+			if (isValidationRequired) {
+				Validate(*doc);
+			}
+			
+			doc->Dump(result);
+
+		}
+
+	protected:
+
+		void Validate(Document &doc) const {
 			try {
-				fs::path schemaFile(GetModuleFilePathA().branch_path());
-				schemaFile /= "RuleSet.xsd";
 				std::string validateErrors;
-				Schema schema(schemaFile.string());
-				if (!schema.Validate(*doc, &validateErrors)) {
+				if (!ruleSetSchemaCache.Get()->Validate(doc, &validateErrors)) {
 					WFormat message(
 						L"Could not save rule std::set, internal error with XML (\"%1%\").");
 					message % ConvertString<WString>(validateErrors.c_str()).GetCStr();
@@ -410,12 +461,7 @@ namespace TunnelEx {
 				message % ex.what();
 				throw SystemException(message.str().c_str());
 			}
-			
-			doc->Dump(result);
-
 		}
-
-	protected:
 		
 		void SaveRuleErrorsTreatment(
 					const Rule &entity,
@@ -581,15 +627,85 @@ namespace TunnelEx {
 
 	//////////////////////////////////////////////////////////////////////////
 
-	class RuleEntitySetXmlParser : private boost::noncopyable {
+	//! One-pass rule set parser, doesn't build XML-document tree.
+	/** Reader validates each node at reading, so parsing stops at the first
+	  * node which doesn't match the rule set XML-schema.
+	  */
+	class RuleSetXmlParser : private boost::noncopyable {
+
+	public:
+
+		explicit RuleSetXmlParser(
+					Reader &reader,
+					const std::string &validateErrors)
+				: m_reader(reader),
+				m_validateErrors(validateErrors) {
+			//...//
+		}
+
+	public:
+
+		void Parse(ServiceRuleSet &serviceRuleSet, TunnelRuleSet &tunnelRuleSet) {
+			ServiceRuleSet services;
+			TunnelRuleSet tunnels;
+			if (ReadChildElement(-1) && !m_reader.IsEmptyElement()) {
+				const int depth = m_reader.GetDepth();
+				while (ReadChildElement(depth)) {
+					if (m_reader.IsName("ServiceRule")) {
+						services.Append(*ParseServiceRule());
+					} else if (m_reader.IsName("TunnelRule")) {
+						tunnels.Append(*ParseTunnelRule());
+					}
+				}
+			}
+			// the document end also has to be validated
+			while (Read()) {
+				//...//
+			}
+			services.Swap(serviceRuleSet);
+			tunnels.Swap(tunnelRuleSet);
+		}
 
 	protected:
 
-		Rule::ErrorsTreatment ParseErrorsTreatment(
-					boost::shared_ptr<const Node> node)
-				const {
+		bool Read() {
+			const bool result = m_reader.Read();
+			if (!m_reader.IsValid()) {
+				WFormat message(
+					L"Passed XML-string has invalid format and can not be loaded by rule (\"%1%\").");
+				message % ConvertString<WString>(m_validateErrors.c_str()).GetCStr();
+				throw XmlDoesNotMatchException(message.str().c_str());
+			}
+			return result;
+		}
+
+		//! Skips all nodes until the next child element or the parent end.
+		bool ReadChildElement(int parentDepth) {
+			while (Read()) {
+				const int depth = m_reader.GetDepth();
+				if (depth <= parentDepth) {
+					assert(m_reader.IsEndElement());
+					return false;
+				} else if (depth == parentDepth + 1 && m_reader.IsElement()) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		const WString & ParseUuid(WString &buffer) {
+			m_reader.GetAttribute("Uuid", buffer);
+			const String uuid(ConvertString<String>(buffer));
+			if (!m_uuids.insert(uuid.GetCStr()).second) {
+				Log::GetInstance().AppendWarn(
+					(Format("Rule set UUID \"%1%\" is not unique.") % uuid.GetCStr()).str());
+			}
+			return buffer;
+		}
+
+		Rule::ErrorsTreatment ParseErrorsTreatment() const {
 			std::string errorsTreatment;
-			node->GetAttribute("ErrorsTreatment", errorsTreatment);
+			m_reader.GetAttribute("ErrorsTreatment", errorsTreatment);
 			if (errorsTreatment == "information") {
 				return Rule::ERRORS_TREATMENT_INFO;
 			} else if (errorsTreatment == "warning") {
@@ -601,216 +717,139 @@ namespace TunnelEx {
 		}
 
 		template<class Entity>
-		boost::shared_ptr<Entity> ParseEntity(boost::shared_ptr<const Node> node) const {
+		boost::shared_ptr<Entity> ParseEntity() {
 			WString buffer;
-			boost::shared_ptr<Entity> entity(new Entity(node->GetAttribute("Uuid", buffer)));
-			entity->SetName(node->GetAttribute("Name", buffer));
-			entity->SetErrorsTreatment(ParseErrorsTreatment(node));
-			entity->Enable(node->GetAttribute("IsEnabled", buffer) == L"true");
+			boost::shared_ptr<Entity> entity(new Entity(ParseUuid(buffer)));
+			entity->SetName(m_reader.GetAttribute("Name", buffer));
+			entity->SetErrorsTreatment(ParseErrorsTreatment());
+			entity->Enable(m_reader.GetAttribute("IsEnabled", buffer) == L"true");
 			return entity;
 		}
 
-		template<class RuleSet>
-		void Parse(
-					const Document &doc,
-					const std::string &tagName,
-					boost::function<boost::shared_ptr<typename RuleSet::ItemType>(boost::shared_ptr<const Node>)> entityParser,
-					RuleSet &result)
-				const {
-			ConstNodeCollection nodes;
-			const std::string path = "/RuleSet/" + tagName;
-			doc.GetXPath()->Query(path.c_str(), nodes);
-			typename RuleSet set(nodes.size());
-			foreach (boost::shared_ptr<const Node> &node, nodes) {
-				set.Append(*entityParser(node));
-			}
-			result.Swap(set);
-		}
-
-	};
-
-	//////////////////////////////////////////////////////////////////////////
-
-	class TunnelRuleSetXmlParser : private RuleEntitySetXmlParser {
-
-	public:
+	protected:
 
-		TunnelRuleSetXmlParser() {
-			//...//
+		boost::shared_ptr<ServiceRule> ParseServiceRule() {
+			const int depth = m_reader.GetDepth();
+			const bool isEmpty = m_reader.IsEmptyElement();
+			boost::shared_ptr<ServiceRule> rule = ParseEntity<ServiceRule>();
+			ServiceRule::ServiceSet services;
+			if (!isEmpty) {
+				while (ReadChildElement(depth)) {
+					services.Append(ParseService());
+				}
+			}
+			rule->SetServices(services);
+			return rule;
 		}
 
-	public:
-
-		void Parse(const Document &doc, TunnelRuleSet &result) const {
-			RuleEntitySetXmlParser::Parse(
-				doc,
-				"TunnelRule",
-				boost::bind(&TunnelRuleSetXmlParser::ParseRule, this, _1),
-				result);
+		ServiceRule::Service ParseService() {
+			ServiceRule::Service result;
+			ParseUuid(result.uuid);
+			m_reader.GetAttribute("Name", result.name);
+			m_reader.GetContent(result.param);
+			return result;
 		}
 
 	protected:
 
-		RuleEndpoint::ListenerInfo ParseListiner(const Node &node) const {
-			RuleEndpoint::ListenerInfo result;
-			WString wbuffer;
-			result.name = node.GetAttribute("Name", wbuffer);
-			result.param = node.GetContent(wbuffer);
-			return result;
-		}
-
-		RuleEndpoint ParseInputEndpoint(const Node &endpointNode) const {
-			WString wbuffer;
-			WString wbuffer2;
-			RuleEndpoint endpoint(&endpointNode.GetAttribute("Uuid", wbuffer2));
-			for (	boost::shared_ptr<const Node> node = endpointNode.GetChildElement();
-					node;
-					node = node->GetNextElement()) {
-				node->GetName(wbuffer);
-				if (wbuffer == L"CombinedAddress") {
-					endpoint.SetCombinedResourceIdentifier(
-						node->GetAttribute("ResourceIdentifier", wbuffer),
-						node->GetAttribute("IsAcceptor", wbuffer2) == L"true");
-				} else if (wbuffer == L"SplitAddress") {
-					node->GetAttribute("Acceptor", wbuffer);
-					Endpoint::Acceptor acceptor = Endpoint::ACCEPTOR_NONE; // wbuffer == L"none"
-					if (wbuffer == L"reader") {
-						acceptor = Endpoint::ACCEPTOR_READER;
-					} else if (wbuffer == L"writer") {
-						acceptor = Endpoint::ACCEPTOR_WRITER;
-					}
-					endpoint.SetReadWriteResourceIdentifiers(
-						node->GetAttribute("ReadResourceIdentifier", wbuffer),
-						node->GetAttribute("WriteResourceIdentifier", wbuffer2),
-						acceptor);
-				} else if (wbuffer == L"PreListener") {
-					endpoint.GetPreListeners().Append(ParseListiner(*node));
-				} else { // L"PostListener"
-					endpoint.GetPostListeners().Append(ParseListiner(*node));
-				}
+		boost::shared_ptr<TunnelRule> ParseTunnelRule() {
+			const int depth = m_reader.GetDepth();
+			const bool isEmpty = m_reader.IsEmptyElement();
+			boost::shared_ptr<TunnelRule> rule = ParseEntity<TunnelRule>();
+			if (isEmpty) {
+				return rule;
 			}
-			return endpoint;
-		}
-
-		RuleEndpoint ParseDestinationEndpoint(const Node &endpointNode) const {
-			WString wbuffer;
-			WString wbuffer2;
-			RuleEndpoint endpoint(&endpointNode.GetAttribute("Uuid", wbuffer2));
-			for (	boost::shared_ptr<const Node> node = endpointNode.GetChildElement();
-					node;
-					node = node->GetNextElement()) {
-				node->GetName(wbuffer);
-				if (wbuffer == L"CombinedAddress") {
-					endpoint.SetCombinedResourceIdentifier(
-						node->GetAttribute("ResourceIdentifier", wbuffer),
-						false);
-				} else if (wbuffer == L"SplitAddress") {
-					endpoint.SetReadWriteResourceIdentifiers(
-						node->GetAttribute("ReadResourceIdentifier", wbuffer),
-						node->GetAttribute("WriteResourceIdentifier", wbuffer2),
-						Endpoint::ACCEPTOR_NONE);
-				} else if (wbuffer == L"PreListener") {
-					endpoint.GetPreListeners().Append(ParseListiner(*node));
-				} else { // L"PostListener"
-					endpoint.GetPostListeners().Append(ParseListiner(*node));
+			while (ReadChildElement(depth)) {
+				if (m_reader.IsName("FilterSet")) {
+					TunnelRule::Filters filters;
+					ParseFilters(filters);
+					rule->SetFilters(filters);
+				} else if (m_reader.IsName("InputSet")) {
+					RuleEndpointCollection endpoints;
+					ParseEndpoints(true, endpoints);
+					rule->SetInputs(endpoints);
+				} else if (m_reader.IsName("DestinationSet")) {
+					RuleEndpointCollection endpoints;
+					ParseEndpoints(false, endpoints);
+					rule->SetDestinations(endpoints);
 				}
 			}
-			return endpoint;
+			return rule;
 		}
 
-		void ParseInputEnpoints(
-					boost::shared_ptr<const Node> node,
-					RuleEndpointCollection &result)
-				const {
-			RuleEndpointCollection set;
-			for (node = node->GetChildElement(); node; node = node->GetNextElement()) {
-				set.Append(ParseInputEndpoint(*node));
+		void ParseFilters(TunnelRule::Filters &result) {
+			TunnelRule::Filters set;
+			if (!m_reader.IsEmptyElement()) {
+				const int depth = m_reader.GetDepth();
+				WString buffer;
+				while (ReadChildElement(depth)) {
+					set.Append(m_reader.GetAttribute("Name", buffer));
+				}
 			}
 			set.Swap(result);
 		}
 
-		void ParseDestinationEndpoints(
-					boost::shared_ptr<const Node> node,
-					RuleEndpointCollection &result)
-				const {
+		void ParseEndpoints(bool isInput, RuleEndpointCollection &result) {
 			RuleEndpointCollection set;
-			for (node = node->GetChildElement(); node; node = node->GetNextElement()) {
-				set.Append(ParseDestinationEndpoint(*node));
+			if (!m_reader.IsEmptyElement()) {
+				const int depth = m_reader.GetDepth();
+				while (ReadChildElement(depth)) {
+					set.Append(ParseEndpoint(isInput));
+				}
 			}
 			set.Swap(result);
 		}
 
-		void ParseFilters(
-					boost::shared_ptr<const Node> node,
-					TunnelRule::Filters &result)
-				const {
-			TunnelRule::Filters set;
-			std::wstring buffer;
-			for (node = node->GetChildElement(); node; node = node->GetNextElement()) {
-				set.Append(node->GetAttribute("Name", buffer).c_str());
+		RuleEndpoint ParseEndpoint(bool isInput) {
+			const int depth = m_reader.GetDepth();
+			const bool isEmpty = m_reader.IsEmptyElement();
+			WString wbuffer;
+			WString wbuffer2;
+			RuleEndpoint endpoint(&ParseUuid(wbuffer2));
+			if (isEmpty) {
+				return endpoint;
 			}
-			set.Swap(result);
-		}
-
-		boost::shared_ptr<TunnelRule> ParseRule(boost::shared_ptr<const Node> node) const {
-			boost::shared_ptr<TunnelRule> rule = ParseEntity<TunnelRule>(node);
-			node = node->GetChildElement();
-			{
-				TunnelRule::Filters filters;
-				ParseFilters(node, filters);
-				rule->SetFilters(filters);
+			while (ReadChildElement(depth)) {
+				if (m_reader.IsName("CombinedAddress")) {
+					endpoint.SetCombinedResourceIdentifier(
+						m_reader.GetAttribute("ResourceIdentifier", wbuffer),
+						isInput && m_reader.GetAttribute("IsAcceptor", wbuffer2) == L"true");
+				} else if (m_reader.IsName("SplitAddress")) {
+					Endpoint::Acceptor acceptor = Endpoint::ACCEPTOR_NONE;
+					if (isInput) {
+						m_reader.GetAttribute("Acceptor", wbuffer);
+						if (wbuffer == L"reader") {
+							acceptor = Endpoint::ACCEPTOR_READER;
+						} else if (wbuffer == L"writer") {
+							acceptor = Endpoint::ACCEPTOR_WRITER;
+						}
+					}
+					endpoint.SetReadWriteResourceIdentifiers(
+						m_reader.GetAttribute("ReadResourceIdentifier", wbuffer),
+						m_reader.GetAttribute("WriteResourceIdentifier", wbuffer2),
+						acceptor);
+				} else if (m_reader.IsName("PreListener")) {
+					endpoint.GetPreListeners().Append(ParseListener());
+				} else if (m_reader.IsName("PostListener")) {
+					endpoint.GetPostListeners().Append(ParseListener());
+				}
 			}
-			node = node->GetNextElement();
-			RuleEndpointCollection endpoints;
-			ParseInputEnpoints(node, endpoints);
-			rule->SetInputs(endpoints);
-			node = node->GetNextElement();
-			ParseDestinationEndpoints(node, endpoints);
-			rule->SetDestinations(endpoints);
-			return rule;
-		}
-
-	};
-
-	//////////////////////////////////////////////////////////////////////////
-
-	class ServiceRuleSetXmlParser : private RuleEntitySetXmlParser {
-
-	public:
-
-		ServiceRuleSetXmlParser() {
-			//...//
+			return endpoint;
 		}
 
-	public:
-
-		void Parse(const Document &doc, ServiceRuleSet &result) const {
-			RuleEntitySetXmlParser::Parse(
-				doc,
-				"ServiceRule",
-				boost::bind(&ServiceRuleSetXmlParser::ParseRule, this, _1),
-				result);
+		RuleEndpoint::ListenerInfo ParseListener() {
+			RuleEndpoint::ListenerInfo result;
+			WString wbuffer;
+			result.name = m_reader.GetAttribute("Name", wbuffer);
+			result.param = m_reader.GetContent(wbuffer);
+			return result;
 		}
 
-	protected:
+	private:
 
-		boost::shared_ptr<ServiceRule> ParseRule(boost::shared_ptr<const Node> node) const {
-			boost::shared_ptr<ServiceRule> rule = ParseEntity<ServiceRule>(node);
-			ServiceRule::ServiceSet services;
-			for (node = node->GetChildElement(); node; node = node->GetNextElement()) {
-				services.Append(ParseService(*node));
-			}
-			rule->SetServices(services);
-			return rule;
-		}
-
-		ServiceRule::Service ParseService(const Node &node) const {
-			ServiceRule::Service result;
-			node.GetAttribute("Uuid", result.uuid);
-			node.GetAttribute("Name", result.name);
-			node.GetContent(result.param);
-			return result;
-		}
+		Reader &m_reader;
+		const std::string &m_validateErrors;
+		std::set<std::string> m_uuids;
 
 	};
 
@@ -831,39 +870,12 @@ public:
 	explicit Implementation(const WString &xml) {
 		
 		try {
-		
-			boost::shared_ptr<Document> doc(Document::LoadFromString(xml));
-			fs::path schemaFile(Helpers::GetModuleFilePathA().branch_path());
-			schemaFile /= "RuleSet.xsd";
-			Schema schema(schemaFile.string());
-			std::string validateErrors;
-
-			if (schema.Validate(*doc, &validateErrors)) {
-			
-				{
-					ConstNodeCollection uuids;
-					doc->GetXPath()->Query("//*/@Uuid", uuids);
-					typedef std::set<std::string> Collection;
-					Collection collection;
-					std::string buffer;
-					const ConstNodeCollection::const_iterator end(uuids.end());
-					foreach (boost::shared_ptr<const Node> &node, uuids) {
-						if (!collection.insert(node->GetContent(buffer)).second) {
-							Log::GetInstance().AppendWarn(
-								(Format("Rule set UUID \"%1%\" is not unique.") % buffer).str());
-						}
-					}
-				}
 
-				ServiceRuleSetXmlParser().Parse(*doc, m_serviceRuleSet);
-				TunnelRuleSetXmlParser().Parse(*doc, m_tunnelRuleSet);
-
-			} else {
-				WFormat message(
-					L"Passed XML-string has invalid format and can not be loaded by rule (\"%1%\").");
-				message % ConvertString<WString>(validateErrors.c_str()).GetCStr();
-				throw XmlDoesNotMatchException(message.str().c_str());
-			}
+			const boost::shared_ptr<const Schema> schema(ruleSetSchemaCache.Get());
+			std::string validateErrors;
+			Reader reader(xml, *schema, &validateErrors);
+			RuleSetXmlParser(reader, validateErrors)
+				.Parse(m_serviceRuleSet, m_tunnelRuleSet);
 
 		} catch (const Schema::ParseException &ex) {
 			WFormat message(L"Could not load system XML-Schema file: \"%1%\".");
@@ -874,6 +886,10 @@ public:
 				=	L"Could not parse XML-string with rule std::set,"
 						L" std::string has invalid format, invalid text encoding or empty.";
 			throw InvalidXmlException(message);
+		} catch (const Xml::Exception &ex) {
+			WFormat message(L"Could not read XML-string with rule set: \"%1%\".");
+			message % ex.what();
+			throw LogicalException(message.str().c_str());
 		}
 
 	}
@@ -929,28 +945,36 @@ void RuleSet::Swap(RuleSet &rhs) throw() {
 	std::swap(rhs.m_pimpl, m_pimpl);
 }
 
-void RuleSet::GetXml(UString &destinationBuffer) const {
+void RuleSet::GetXml(
+			UString &destinationBuffer,
+			bool isValidationRequired /*= true*/)
+		const {
 	RuleEntitySetXmlSaver()
-		.Save(GetServices(), GetTunnels(), destinationBuffer);
+		.Save(GetServices(), GetTunnels(), destinationBuffer, isValidationRequired);
 }
 
-void RuleSet::GetXml(WString &destinationBuffer) const {
+void RuleSet::GetXml(
+			WString &destinationBuffer,
+			bool isValidationRequired /*= true*/)
+		const {
 	RuleEntitySetXmlSaver()
-		.Save(GetServices(), GetTunnels(), destinationBuffer);
+		.Save(GetServices(), GetTunnels(), destinationBuffer, isValidationRequired);
 }
 
 void RuleSet::GetXml(
 			const ServiceRuleSet &s,
 			const TunnelRuleSet &t,
-			UString &b) {
-	RuleEntitySetXmlSaver().Save(s, t, b);
+			UString &b,
+			bool isValidationRequired /*= true*/) {
+	RuleEntitySetXmlSaver().Save(s, t, b, isValidationRequired);
 }
 
 void RuleSet::GetXml(
 			const ServiceRuleSet &s,
 			const TunnelRuleSet &t,
-			WString &b) {
-	RuleEntitySetXmlSaver().Save(s, t, b);
+			WString &b,
+			bool isValidationRequired /*= true*/) {
+	RuleEntitySetXmlSaver().Save(s, t, b, isValidationRequired);
 }
 
 ServiceRuleSet & RuleSet::GetServices() {
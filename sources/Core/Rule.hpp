@@ -233,6 +233,7 @@ namespace TunnelEx {
 		// C-tor
 		/** @throw TunnelEx::InvalidXmlException 
 		  * @throw TunnelEx::XmlDoesNotMatchException
+		  * @throw TunnelEx::LogicalException
 		  */
 		explicit RuleSet(const ::TunnelEx::WString &);
 
@@ -251,19 +252,33 @@ namespace TunnelEx {
 
 	public:
 
-		void GetXml(::TunnelEx::UString &destinationBuffer) const;
+		//! Serializes rule set into XML.
+		/** @param	isValidationRequired	if false - generated XML will be
+		  *									not validated by the XML-schema,
+		  *									it saves time when the XML will
+		  *									be validated at loading anyway;
+		  */
+		void GetXml(
+				::TunnelEx::UString &destinationBuffer,
+				bool isValidationRequired = true)
+			const;
 
-		void GetXml(::TunnelEx::WString &destinationBuffer) const;
+		void GetXml(
+				::TunnelEx::WString &destinationBuffer,
+				bool isValidationRequired = true)
+			const;
 
 		static void GetXml(
 				const ::TunnelEx::ServiceRuleSet &,
 				const ::TunnelEx::TunnelRuleSet &,
-				::TunnelEx::UString &destinationBuffer);
+				::TunnelEx::UString &destinationBuffer,
+				bool isValidationRequired = true);
 
 		static void GetXml(
 				const ::TunnelEx::ServiceRuleSet &,
 				const ::TunnelEx::TunnelRuleSet &,
-				::TunnelEx::WString &destinationBuffer);
+				::TunnelEx::WString &destinationBuffer,
+				bool isValidationRequired = true);
 
 	public:
 
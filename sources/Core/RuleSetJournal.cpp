@@ -0,0 +1,484 @@
+/**************************************************************************
+ *   Created: 2026/10/19 23:25
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "RuleSetJournal.hpp"
+#include "RuleSetSnapshot.hpp"
+#include "Rule.hpp"
+#include "Log.hpp"
+#include "Error.hpp"
+#include "Exceptions.hpp"
+
+using namespace TunnelEx;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	enum RecordType {
+		RECORD_TYPE_UPDATE = 1,
+		RECORD_TYPE_ENABLE,
+		RECORD_TYPE_DISABLE,
+		RECORD_TYPE_DELETE
+	};
+
+#	pragma pack(push, 1)
+	struct RecordHeader {
+		unsigned long dataSize;
+		unsigned long dataChecksum;
+		unsigned char type;
+	};
+#	pragma pack(pop)
+
+	unsigned long CalcChecksum(unsigned char type, const char *data, size_t size) {
+		boost::crc_32_type crc;
+		crc.process_byte(type);
+		crc.process_bytes(data, size);
+		return crc.checksum();
+	}
+
+	WString GetCompactionFilePath(const WString &filePath) {
+		WString result = filePath;
+		result += L".compaction";
+		return result;
+	}
+
+	void ThrowSystemError(const wchar_t *what, const WString &path) {
+		const Error error(GetLastError());
+		WFormat message(L"Failed to %1% rule set journal \"%2%\": %3% (%4%).");
+		message % what % path.GetCStr() % error.GetStringW() % error.GetErrorNo();
+		throw SystemException(message.str().c_str());
+	}
+
+	class FileHandle : private boost::noncopyable {
+	public:
+		explicit FileHandle(HANDLE handle)
+				: m_handle(handle) {
+			//...//
+		}
+		~FileHandle() throw() {
+			if (IsValid()) {
+				CloseHandle(m_handle);
+			}
+		}
+	public:
+		bool IsValid() const {
+			return m_handle != INVALID_HANDLE_VALUE;
+		}
+		HANDLE Get() const {
+			return m_handle;
+		}
+	private:
+		HANDLE m_handle;
+	};
+
+	HANDLE OpenForAppending(const WString &path) {
+		const HANDLE result = CreateFileW(
+			path.GetCStr(),
+			GENERIC_READ | GENERIC_WRITE,
+			FILE_SHARE_READ,
+			NULL,
+			OPEN_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL,
+			NULL);
+		if (result == INVALID_HANDLE_VALUE) {
+			ThrowSystemError(L"open", path);
+		}
+		return result;
+	}
+
+	void Seek(HANDLE file, unsigned long long position, DWORD method, const WString &path) {
+		LARGE_INTEGER distance;
+		distance.QuadPart = position;
+		if (!SetFilePointerEx(file, distance, NULL, method)) {
+			ThrowSystemError(L"set position in", path);
+		}
+	}
+
+	void Write(HANDLE file, const char *data, size_t size, const WString &path) {
+		DWORD written = 0;
+		if (!WriteFile(file, data, DWORD(size), &written, NULL) || written != size) {
+			ThrowSystemError(L"write", path);
+		}
+	}
+
+	void ReadAll(HANDLE file, const WString &path, std::vector<char> &result) {
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size)) {
+			ThrowSystemError(L"get size of", path);
+		}
+		Seek(file, 0, FILE_BEGIN, path);
+		std::vector<char> buffer(size_t(size.QuadPart));
+		DWORD read = 0;
+		if (	!buffer.empty()
+				&& (	!ReadFile(file, &buffer[0], DWORD(buffer.size()), &read, NULL)
+						|| read != buffer.size())) {
+			ThrowSystemError(L"read", path);
+		}
+		buffer.swap(result);
+	}
+
+	//! @return	false if file does not exist.
+	bool ReadAll(const WString &path, std::vector<char> &result) {
+		FileHandle file(
+			CreateFileW(
+				path.GetCStr(),
+				GENERIC_READ,
+				// the journal could be opened for appending
+				FILE_SHARE_READ | FILE_SHARE_WRITE,
+				NULL,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+				NULL));
+		if (!file.IsValid()) {
+			if (GetLastError() == ERROR_FILE_NOT_FOUND) {
+				return false;
+			}
+			ThrowSystemError(L"open", path);
+		}
+		ReadAll(file.Get(), path, result);
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template<typename Set>
+	void ApplyUpdate(const Set &rulesWithNew, Set &ruleSet) {
+		for (size_t i = 0; i < rulesWithNew.GetSize(); ++i) {
+			const typename Set::ItemType &newRule = rulesWithNew[i];
+			bool wasFound = false;
+			for (size_t j = 0; j < ruleSet.GetSize(); ++j) {
+				if (ruleSet[j].GetUuid() == newRule.GetUuid()) {
+					ruleSet[j] = newRule;
+					wasFound = true;
+					break;
+				}
+			}
+			if (!wasFound) {
+				ruleSet.Append(newRule);
+			}
+		}
+	}
+
+	template<typename Set>
+	bool ApplyEnable(const WString &uuid, bool isEnabled, Set &ruleSet) {
+		for (size_t i = 0; i < ruleSet.GetSize(); ++i) {
+			if (ruleSet[i].GetUuid() == uuid) {
+				ruleSet[i].Enable(isEnabled);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<typename Set>
+	bool ApplyDelete(const WString &uuid, Set &ruleSet) {
+		for (size_t i = 0; i < ruleSet.GetSize(); ++i) {
+			if (ruleSet[i].GetUuid() == uuid) {
+				ruleSet.Remove(i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//! @return false if record is damaged.
+	bool ApplyRecord(
+				unsigned char type,
+				const char *data,
+				size_t size,
+				RuleSet &ruleSet) {
+		switch (type) {
+			case RECORD_TYPE_UPDATE:
+				{
+					RuleSet rulesWithNew;
+					if (!RuleSetSnapshot::Deserialize(data, size, rulesWithNew)) {
+						return false;
+					}
+					ApplyUpdate(rulesWithNew.GetServices(), ruleSet.GetServices());
+					ApplyUpdate(rulesWithNew.GetTunnels(), ruleSet.GetTunnels());
+				}
+				return true;
+			case RECORD_TYPE_ENABLE:
+			case RECORD_TYPE_DISABLE:
+			case RECORD_TYPE_DELETE:
+				{
+					if (size % sizeof(wchar_t)) {
+						return false;
+					}
+					const std::wstring uuid(
+						reinterpret_cast<const wchar_t *>(data),
+						size / sizeof(wchar_t));
+					if (type == RECORD_TYPE_DELETE) {
+						ApplyDelete(uuid.c_str(), ruleSet.GetServices())
+							|| ApplyDelete(uuid.c_str(), ruleSet.GetTunnels());
+					} else {
+						const bool isEnabled = type == RECORD_TYPE_ENABLE;
+						ApplyEnable(uuid.c_str(), isEnabled, ruleSet.GetServices())
+							|| ApplyEnable(uuid.c_str(), isEnabled, ruleSet.GetTunnels());
+					}
+				}
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	//! Applies records until the first damaged record.
+	/** @param validSize	size of the records before the first damaged record.
+	  * @return number of applied records.
+	  */
+	size_t ApplyRecords(
+				const std::vector<char> &buffer,
+				RuleSet &ruleSet,
+				size_t &validSize) {
+		size_t result = 0;
+		size_t offset = 0;
+		while (offset < buffer.size()) {
+			RecordHeader header;
+			if (buffer.size() - offset < sizeof(header)) {
+				break;
+			}
+			memcpy(&header, &buffer[offset], sizeof(header));
+			if (buffer.size() - offset - sizeof(header) < header.dataSize) {
+				break;
+			}
+			const char *const data = &buffer[0] + offset + sizeof(header);
+			if (	header.dataChecksum != CalcChecksum(header.type, data, header.dataSize)
+					|| !ApplyRecord(header.type, data, header.dataSize, ruleSet)) {
+				break;
+			}
+			offset += sizeof(header) + header.dataSize;
+			++result;
+		}
+		validSize = offset;
+		return result;
+	}
+
+	size_t ReplayFile(const WString &path, RuleSet &ruleSet) {
+		std::vector<char> buffer;
+		if (!ReadAll(path, buffer)) {
+			return 0;
+		}
+		size_t validSize = 0;
+		const size_t result = ApplyRecords(buffer, ruleSet, validSize);
+		if (validSize < buffer.size()) {
+			Format message(
+				"Rule set journal \"%1%\" has damaged record at %2%,"
+					" the rest of the journal is ignored.");
+			message % ConvertString<String>(path).GetCStr() % validSize;
+			Log::GetInstance().AppendWarn(message.str());
+		}
+		return result;
+	}
+
+	//! Removes damaged records from the file end and moves to the end.
+	/** Partially written record could be left by the crash, records appended
+	  * after it will be never replayed.
+	  * @return file size.
+	  */
+	unsigned long long CutDamagedRecords(HANDLE file, const WString &path) {
+		std::vector<char> buffer;
+		ReadAll(file, path, buffer);
+		RuleSet ruleSet;
+		size_t validSize = 0;
+		ApplyRecords(buffer, ruleSet, validSize);
+		if (validSize < buffer.size()) {
+			Format message(
+				"Rule set journal \"%1%\" has damaged record at %2%,"
+					" the rest of the journal is removed.");
+			message % ConvertString<String>(path).GetCStr() % validSize;
+			Log::GetInstance().AppendWarn(message.str());
+			Seek(file, validSize, FILE_BEGIN, path);
+			if (!SetEndOfFile(file)) {
+				ThrowSystemError(L"truncate", path);
+			}
+		}
+		Seek(file, 0, FILE_END, path);
+		return validSize;
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+class RuleSetJournal::Implementation : private boost::noncopyable {
+
+public:
+
+	typedef ACE_Thread_Mutex Mutex;
+	typedef ACE_Guard<Mutex> Lock;
+
+public:
+
+	explicit Implementation(const WString &filePath)
+			: m_filePath(filePath),
+			m_compactionFilePath(GetCompactionFilePath(filePath)),
+			m_file(OpenForAppending(m_filePath)),
+			m_size(0),
+			m_isFlushRequired(false) {
+		m_size = CutDamagedRecords(m_file.Get(), m_filePath);
+	}
+
+public:
+
+	void Append(RecordType type, const char *data, size_t size) {
+		std::vector<char> record(sizeof(RecordHeader) + size);
+		RecordHeader &header = *reinterpret_cast<RecordHeader *>(&record[0]);
+		header.dataSize = static_cast<unsigned long>(size);
+		header.type = static_cast<unsigned char>(type);
+		header.dataChecksum = CalcChecksum(header.type, data, size);
+		if (size) {
+			memcpy(&record[sizeof(RecordHeader)], data, size);
+		}
+		const Lock lock(m_mutex);
+		try {
+			Write(m_file.Get(), &record[0], record.size(), m_filePath);
+		} catch (const SystemException &) {
+			// partially written record breaks replaying for all next records
+			Seek(m_file.Get(), m_size, FILE_BEGIN, m_filePath);
+			SetEndOfFile(m_file.Get());
+			throw;
+		}
+		m_size += record.size();
+		m_isFlushRequired = true;
+	}
+
+	void Flush() {
+		{
+			const Lock lock(m_mutex);
+			if (!m_isFlushRequired) {
+				return;
+			}
+			m_isFlushRequired = false;
+		}
+		// records appended during flushing will be flushed by the next call
+		if (!FlushFileBuffers(m_file.Get())) {
+			{
+				const Lock lock(m_mutex);
+				m_isFlushRequired = true;
+			}
+			ThrowSystemError(L"flush", m_filePath);
+		}
+	}
+
+	unsigned long long GetSize() const {
+		const Lock lock(m_mutex);
+		return m_size;
+	}
+
+	void StartCompaction() {
+
+		const Lock lock(m_mutex);
+		if (!m_size) {
+			return;
+		}
+
+		std::vector<char> records(size_t(m_size));
+		Seek(m_file.Get(), 0, FILE_BEGIN, m_filePath);
+		DWORD read = 0;
+		if (	!ReadFile(m_file.Get(), &records[0], DWORD(records.size()), &read, NULL)
+				|| read != records.size()) {
+			Seek(m_file.Get(), 0, FILE_END, m_filePath);
+			ThrowSystemError(L"read", m_filePath);
+		}
+
+		{
+			// could be not empty after not completed compaction
+			FileHandle compactionFile(OpenForAppending(m_compactionFilePath));
+			CutDamagedRecords(compactionFile.Get(), m_compactionFilePath);
+			Write(compactionFile.Get(), &records[0], records.size(), m_compactionFilePath);
+			if (!FlushFileBuffers(compactionFile.Get())) {
+				ThrowSystemError(L"flush", m_compactionFilePath);
+			}
+		}
+
+		Seek(m_file.Get(), 0, FILE_BEGIN, m_filePath);
+		if (!SetEndOfFile(m_file.Get()) || !FlushFileBuffers(m_file.Get())) {
+			ThrowSystemError(L"truncate", m_filePath);
+		}
+		m_size = 0;
+		m_isFlushRequired = false;
+
+	}
+
+	void CompleteCompaction() {
+		const Lock lock(m_mutex);
+		if (	!DeleteFileW(m_compactionFilePath.GetCStr())
+				&& GetLastError() != ERROR_FILE_NOT_FOUND) {
+			ThrowSystemError(L"remove compaction file of", m_filePath);
+		}
+	}
+
+private:
+
+	const WString m_filePath;
+	const WString m_compactionFilePath;
+	mutable Mutex m_mutex;
+	FileHandle m_file;
+	unsigned long long m_size;
+	bool m_isFlushRequired;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+RuleSetJournal::RuleSetJournal(const WString &filePath)
+		: m_pimpl(new Implementation(filePath)) {
+	//...//
+}
+
+RuleSetJournal::~RuleSetJournal() throw() {
+	delete m_pimpl;
+}
+
+void RuleSetJournal::AppendUpdate(const RuleSet &rulesWithNew) {
+	std::vector<char> data;
+	RuleSetSnapshot::Serialize(rulesWithNew, data);
+	m_pimpl->Append(RECORD_TYPE_UPDATE, &data[0], data.size());
+}
+
+void RuleSetJournal::AppendEnable(const WString &uuid, bool isEnabled) {
+	m_pimpl->Append(
+		isEnabled ? RECORD_TYPE_ENABLE : RECORD_TYPE_DISABLE,
+		reinterpret_cast<const char *>(uuid.GetCStr()),
+		uuid.GetLength() * sizeof(WString::ValueType));
+}
+
+void RuleSetJournal::AppendDelete(const WString &uuid) {
+	m_pimpl->Append(
+		RECORD_TYPE_DELETE,
+		reinterpret_cast<const char *>(uuid.GetCStr()),
+		uuid.GetLength() * sizeof(WString::ValueType));
+}
+
+void RuleSetJournal::Flush() {
+	m_pimpl->Flush();
+}
+
+unsigned long long RuleSetJournal::GetSize() const {
+	return m_pimpl->GetSize();
+}
+
+void RuleSetJournal::StartCompaction() {
+	m_pimpl->StartCompaction();
+}
+
+void RuleSetJournal::CompleteCompaction() {
+	m_pimpl->CompleteCompaction();
+}
+
+size_t RuleSetJournal::Replay(const WString &filePath, RuleSet &ruleSet) {
+	size_t result = ReplayFile(GetCompactionFilePath(filePath), ruleSet);
+	result += ReplayFile(filePath, ruleSet);
+	return result;
+}
+
+//////////////////////////////////////////////////////////////////////////
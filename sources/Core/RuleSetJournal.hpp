@@ -0,0 +1,102 @@
+/**************************************************************************
+ *   Created: 2026/10/19 23:12
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__RuleSetJournal_hpp__2610192312
+#define INCLUDED_FILE__TUNNELEX__RuleSetJournal_hpp__2610192312
+
+#include "String.hpp"
+#include "Api.h"
+
+namespace TunnelEx {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class RuleSet;
+
+	//! Append-only journal of the rule set changes.
+	/** Each change is appended to the journal file as a small record instead
+	  * of the full rule set saving. Records are written to the file at once,
+	  * but disk flushing is batched by Flush. Compaction moves records into
+	  * the compaction file and lets the owner save full rule set without
+	  * the lock; records are applied in the same order at replaying, so the
+	  * compaction file from interrupted compaction is safe.
+	  */
+	class TUNNELEX_CORE_API RuleSetJournal {
+
+	public:
+
+		//! Opens journal for appending, creates it if it does not exist.
+		/** Damaged records at the journal end, left by the crash, are removed,
+		  * so new records will be not lost at replaying.
+		  * @throw TunnelEx::SystemException
+		  */
+		explicit RuleSetJournal(const ::TunnelEx::WString &filePath);
+		~RuleSetJournal() throw();
+
+	private:
+
+		RuleSetJournal(const RuleSetJournal &);
+		const RuleSetJournal & operator =(const RuleSetJournal &);
+
+	public:
+
+		//! Appends new or changed rules.
+		/** @throw TunnelEx::SystemException
+		  */
+		void AppendUpdate(const ::TunnelEx::RuleSet &);
+		//! Appends rule enabling or disabling.
+		/** @throw TunnelEx::SystemException
+		  */
+		void AppendEnable(const ::TunnelEx::WString &uuid, bool isEnabled);
+		//! Appends rule deletion.
+		/** @throw TunnelEx::SystemException
+		  */
+		void AppendDelete(const ::TunnelEx::WString &uuid);
+
+		//! Flushes all appended records to the disk by one system call.
+		/** @throw TunnelEx::SystemException
+		  */
+		void Flush();
+
+		//! Returns journal size in bytes, doesn't include compaction file.
+		unsigned long long GetSize() const;
+
+		//! Moves all records to the compaction file and starts new journal.
+		/** @throw TunnelEx::SystemException
+		  */
+		void StartCompaction();
+		//! Removes compaction file, full rule set with its records has been saved.
+		/** @throw TunnelEx::SystemException
+		  */
+		void CompleteCompaction();
+
+	public:
+
+		//! Applies records from compaction file and journal to the rule set.
+		/** Stops at first damaged record, it could be only partially written
+		  * record at the journal end.
+		  * @throw TunnelEx::SystemException
+		  * @return number of applied records.
+		  */
+		static size_t Replay(
+				const ::TunnelEx::WString &filePath,
+				::TunnelEx::RuleSet &);
+
+	private:
+
+		class Implementation;
+		Implementation *m_pimpl;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__RuleSetJournal_hpp__2610192312
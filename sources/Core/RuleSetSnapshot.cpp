@@ -0,0 +1,599 @@
+/**************************************************************************
+ *   Created: 2026/10/19 22:41
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "RuleSetSnapshot.hpp"
+#include "Rule.hpp"
+#include "Log.hpp"
+#include "Error.hpp"
+#include "Exceptions.hpp"
+
+using namespace TunnelEx;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	const char snapshotSignature[8] = {'T', 'E', 'X', 'R', 'S', 'N', 'A', 'P'};
+	//! Has to be increased with each change of the format.
+	const unsigned long formatVersion = 1;
+
+#	pragma pack(push, 1)
+	struct Header {
+		char signature[sizeof(snapshotSignature)];
+		unsigned long formatVersion;
+		unsigned long long xmlFileSize;
+		unsigned long long xmlFileModificationTime;
+		unsigned long long dataSize;
+		unsigned long dataChecksum;
+	};
+#	pragma pack(pop)
+
+	struct XmlFileStamp {
+		unsigned long long size;
+		unsigned long long modificationTime;
+	};
+
+	bool GetXmlFileStamp(const WString &path, XmlFileStamp &result) {
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		if (!GetFileAttributesExW(path.GetCStr(), GetFileExInfoStandard, &data)) {
+			return false;
+		}
+		result.size
+			= (static_cast<unsigned long long>(data.nFileSizeHigh) << 32)
+				| data.nFileSizeLow;
+		result.modificationTime
+			= (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32)
+				| data.ftLastWriteTime.dwLowDateTime;
+		return true;
+	}
+
+	//! FNV-1a, detects truncated or damaged snapshot.
+	unsigned long CalcChecksum(const char *data, size_t size) {
+		unsigned long result = 2166136261;
+		for (const char *const end = data + size; data != end; ++data) {
+			result ^= static_cast<unsigned char>(*data);
+			result *= 16777619;
+		}
+		return result;
+	}
+
+	void LogCorrupted(const WString &path) {
+		Format message("Rule set snapshot \"%1%\" is corrupted.");
+		message % ConvertString<String>(path).GetCStr();
+		Log::GetInstance().AppendWarn(message.str());
+	}
+
+	void ThrowSystemError(const wchar_t *what, const WString &path) {
+		const Error error(GetLastError());
+		WFormat message(L"Failed to %1% rule set snapshot \"%2%\": %3% (%4%).");
+		message % what % path.GetCStr() % error.GetStringW() % error.GetErrorNo();
+		throw SystemException(message.str().c_str());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class Writer : private boost::noncopyable {
+
+	public:
+
+		explicit Writer(std::vector<char> &buffer)
+				: m_buffer(buffer) {
+			//...//
+		}
+
+	public:
+
+		void Write(const ServiceRuleSet &set) {
+			WriteSize(set.GetSize());
+			for (size_t i = 0; i < set.GetSize(); ++i) {
+				Write(set[i]);
+			}
+		}
+
+		void Write(const TunnelRuleSet &set) {
+			WriteSize(set.GetSize());
+			for (size_t i = 0; i < set.GetSize(); ++i) {
+				Write(set[i]);
+			}
+		}
+
+	private:
+
+		template<typename T>
+		void WriteValue(const T &value) {
+			const char *const data = reinterpret_cast<const char *>(&value);
+			m_buffer.insert(m_buffer.end(), data, data + sizeof(value));
+		}
+
+		void WriteSize(size_t size) {
+			WriteValue(static_cast<unsigned long>(size));
+		}
+
+		void Write(bool value) {
+			WriteValue(static_cast<unsigned char>(value ? 1 : 0));
+		}
+
+		//! Stores length and string with terminating zero.
+		void Write(const WString &value) {
+			WriteSize(value.GetLength());
+			const char *const data = reinterpret_cast<const char *>(value.GetCStr());
+			m_buffer.insert(
+				m_buffer.end(),
+				data,
+				data + (value.GetLength() + 1) * sizeof(WString::ValueType));
+		}
+
+		void Write(const Rule &rule) {
+			Write(rule.GetUuid());
+			Write(rule.GetName());
+			WriteValue(static_cast<unsigned char>(rule.GetErrorsTreatment()));
+			Write(rule.IsEnabled());
+		}
+
+		void Write(const ServiceRule &rule) {
+			Write(static_cast<const Rule &>(rule));
+			const ServiceRule::ServiceSet &services = rule.GetServices();
+			WriteSize(services.GetSize());
+			for (size_t i = 0; i < services.GetSize(); ++i) {
+				Write(services[i].uuid);
+				Write(services[i].name);
+				Write(services[i].param);
+			}
+		}
+
+		void Write(const TunnelRule &rule) {
+			Write(static_cast<const Rule &>(rule));
+			const TunnelRule::Filters &filters = rule.GetFilters();
+			WriteSize(filters.GetSize());
+			for (size_t i = 0; i < filters.GetSize(); ++i) {
+				Write(filters[i]);
+			}
+			Write(rule.GetInputs(), true);
+			Write(rule.GetDestinations(), false);
+		}
+
+		void Write(const RuleEndpoint::Listeners &listeners) {
+			WriteSize(listeners.GetSize());
+			for (size_t i = 0; i < listeners.GetSize(); ++i) {
+				Write(listeners[i].name);
+				Write(listeners[i].param);
+			}
+		}
+
+		//! Stores the same endpoint data as XML, destinations have no acceptors.
+		void Write(const RuleEndpointCollection &endpoints, bool isInput) {
+			WriteSize(endpoints.GetSize());
+			for (size_t i = 0; i < endpoints.GetSize(); ++i) {
+				const RuleEndpoint &endpoint = endpoints[i];
+				Write(endpoint.GetUuid());
+				Write(endpoint.GetPreListeners());
+				Write(endpoint.GetPostListeners());
+				Write(endpoint.IsCombined());
+				if (endpoint.IsCombined()) {
+					Write(endpoint.GetCombinedResourceIdentifier());
+					if (isInput) {
+						Write(endpoint.IsCombinedAcceptor());
+					}
+				} else {
+					Write(endpoint.GetReadResourceIdentifier());
+					Write(endpoint.GetWriteResourceIdentifier());
+					if (isInput) {
+						WriteValue(
+							static_cast<unsigned char>(endpoint.GetReadWriteAcceptor()));
+					}
+				}
+			}
+		}
+
+	private:
+
+		std::vector<char> &m_buffer;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class Reader : private boost::noncopyable {
+
+	public:
+
+		class CorruptedException {
+			//...//
+		};
+
+	public:
+
+		explicit Reader(const char *begin, const char *end)
+				: m_pos(begin),
+				m_end(end) {
+			//...//
+		}
+
+	public:
+
+		void Read(ServiceRuleSet &result) {
+			const size_t size = ReadSize(sizeof(unsigned long));
+			ServiceRuleSet set(size);
+			for (size_t i = 0; i < size; ++i) {
+				set.Append(*ReadServiceRule());
+			}
+			set.Swap(result);
+		}
+
+		void Read(TunnelRuleSet &result) {
+			const size_t size = ReadSize(sizeof(unsigned long));
+			TunnelRuleSet set(size);
+			for (size_t i = 0; i < size; ++i) {
+				set.Append(*ReadTunnelRule());
+			}
+			set.Swap(result);
+		}
+
+		bool IsEnd() const {
+			return m_pos == m_end;
+		}
+
+	private:
+
+		void Check(size_t size) const {
+			if (size_t(m_end - m_pos) < size) {
+				throw CorruptedException();
+			}
+		}
+
+		template<typename T>
+		T ReadValue() {
+			Check(sizeof(T));
+			T result;
+			memcpy(&result, m_pos, sizeof(T));
+			m_pos += sizeof(T);
+			return result;
+		}
+
+		//! Reads items number and checks that the rest of data could contain it.
+		size_t ReadSize(size_t minItemSize) {
+			const size_t result = ReadValue<unsigned long>();
+			Check(result * minItemSize);
+			return result;
+		}
+
+		bool ReadBool() {
+			return ReadValue<unsigned char>() != 0;
+		}
+
+		void Read(WString &result) {
+			const size_t length = ReadSize(sizeof(WString::ValueType));
+			const size_t size = (length + 1) * sizeof(WString::ValueType);
+			Check(size);
+			const WString::ValueType *const str
+				= reinterpret_cast<const WString::ValueType *>(m_pos);
+			if (str[length] != 0 || std::find(str, str + length, 0) != str + length) {
+				throw CorruptedException();
+			}
+			result = str;
+			m_pos += size;
+		}
+
+		template<typename Entity>
+		boost::shared_ptr<Entity> ReadEntity() {
+			WString buffer;
+			Read(buffer);
+			boost::shared_ptr<Entity> result(new Entity(buffer));
+			Read(buffer);
+			result->SetName(buffer);
+			const unsigned char treatment = ReadValue<unsigned char>();
+			switch (treatment) {
+				case Rule::ERRORS_TREATMENT_INFO:
+				case Rule::ERRORS_TREATMENT_WARN:
+				case Rule::ERRORS_TREATMENT_ERROR:
+					result->SetErrorsTreatment(Rule::ErrorsTreatment(treatment));
+					break;
+				default:
+					throw CorruptedException();
+			}
+			result->Enable(ReadBool());
+			return result;
+		}
+
+		boost::shared_ptr<ServiceRule> ReadServiceRule() {
+			boost::shared_ptr<ServiceRule> result = ReadEntity<ServiceRule>();
+			const size_t size = ReadSize(sizeof(unsigned long) * 3);
+			ServiceRule::ServiceSet services(size);
+			for (size_t i = 0; i < size; ++i) {
+				ServiceRule::Service service;
+				Read(service.uuid);
+				Read(service.name);
+				Read(service.param);
+				services.Append(service);
+			}
+			result->SetServices(services);
+			return result;
+		}
+
+		boost::shared_ptr<TunnelRule> ReadTunnelRule() {
+			boost::shared_ptr<TunnelRule> result = ReadEntity<TunnelRule>();
+			{
+				const size_t size = ReadSize(sizeof(unsigned long));
+				TunnelRule::Filters filters(size);
+				WString buffer;
+				for (size_t i = 0; i < size; ++i) {
+					Read(buffer);
+					filters.Append(buffer);
+				}
+				result->SetFilters(filters);
+			}
+			RuleEndpointCollection endpoints;
+			Read(endpoints, true);
+			result->SetInputs(endpoints);
+			Read(endpoints, false);
+			result->SetDestinations(endpoints);
+			return result;
+		}
+
+		void Read(RuleEndpoint::Listeners &result) {
+			const size_t size = ReadSize(sizeof(unsigned long) * 2);
+			RuleEndpoint::Listeners listeners(size);
+			for (size_t i = 0; i < size; ++i) {
+				RuleEndpoint::ListenerInfo listener;
+				Read(listener.name);
+				Read(listener.param);
+				listeners.Append(listener);
+			}
+			listeners.Swap(result);
+		}
+
+		void Read(RuleEndpointCollection &result, bool isInput) {
+			const size_t size = ReadSize(sizeof(unsigned long));
+			RuleEndpointCollection endpoints(size);
+			WString buffer;
+			WString buffer2;
+			for (size_t i = 0; i < size; ++i) {
+				Read(buffer);
+				RuleEndpoint endpoint(&buffer);
+				Read(endpoint.GetPreListeners());
+				Read(endpoint.GetPostListeners());
+				if (ReadBool()) {
+					Read(buffer);
+					endpoint.SetCombinedResourceIdentifier(
+						buffer,
+						isInput ? ReadBool() : false);
+				} else {
+					Read(buffer);
+					Read(buffer2);
+					Endpoint::Acceptor acceptor = Endpoint::ACCEPTOR_NONE;
+					if (isInput) {
+						const unsigned char value = ReadValue<unsigned char>();
+						switch (value) {
+							case Endpoint::ACCEPTOR_NONE:
+							case Endpoint::ACCEPTOR_READER:
+							case Endpoint::ACCEPTOR_WRITER:
+								acceptor = Endpoint::Acceptor(value);
+								break;
+							default:
+								throw CorruptedException();
+						}
+					}
+					endpoint.SetReadWriteResourceIdentifiers(buffer, buffer2, acceptor);
+				}
+				endpoints.Append(endpoint);
+			}
+			endpoints.Swap(result);
+		}
+
+	private:
+
+		const char *m_pos;
+		const char *const m_end;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class FileHandle : private boost::noncopyable {
+	public:
+		explicit FileHandle(HANDLE handle)
+				: m_handle(handle) {
+			//...//
+		}
+		~FileHandle() throw() {
+			if (IsValid()) {
+				CloseHandle(m_handle);
+			}
+		}
+	public:
+		bool IsValid() const {
+			return m_handle != NULL && m_handle != INVALID_HANDLE_VALUE;
+		}
+		HANDLE Get() const {
+			return m_handle;
+		}
+	private:
+		HANDLE m_handle;
+	};
+
+	class FileView : private boost::noncopyable {
+	public:
+		explicit FileView(const void *view)
+				: m_view(view) {
+			//...//
+		}
+		~FileView() throw() {
+			if (m_view) {
+				UnmapViewOfFile(m_view);
+			}
+		}
+	public:
+		const char * Get() const {
+			return static_cast<const char *>(m_view);
+		}
+	private:
+		const void *m_view;
+	};
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void RuleSetSnapshot::Save(
+			const RuleSet &ruleSet,
+			const WString &xmlFilePath,
+			const WString &snapshotFilePath) {
+
+	XmlFileStamp xmlFileStamp;
+	if (!GetXmlFileStamp(xmlFilePath, xmlFileStamp)) {
+		ThrowSystemError(L"get XML file attributes for", snapshotFilePath);
+	}
+
+	std::vector<char> buffer(sizeof(Header));
+	Serialize(ruleSet, buffer);
+
+	Header &header = *reinterpret_cast<Header *>(&buffer[0]);
+	memcpy(header.signature, snapshotSignature, sizeof(header.signature));
+	header.formatVersion = formatVersion;
+	header.xmlFileSize = xmlFileStamp.size;
+	header.xmlFileModificationTime = xmlFileStamp.modificationTime;
+	header.dataSize = buffer.size() - sizeof(Header);
+	header.dataChecksum = CalcChecksum(&buffer[sizeof(Header)], buffer.size() - sizeof(Header));
+
+	// writes into temporary file to not leave half-written snapshot at failure
+	WString tmpFilePath = snapshotFilePath;
+	tmpFilePath += L".tmp";
+	{
+		FileHandle file(
+			CreateFileW(
+				tmpFilePath.GetCStr(),
+				GENERIC_WRITE,
+				0,
+				NULL,
+				CREATE_ALWAYS,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+				NULL));
+		if (!file.IsValid()) {
+			ThrowSystemError(L"create", tmpFilePath);
+		}
+		DWORD written = 0;
+		if (	!WriteFile(file.Get(), &buffer[0], DWORD(buffer.size()), &written, NULL)
+				|| written != buffer.size()) {
+			ThrowSystemError(L"write", tmpFilePath);
+		}
+	}
+	if (	!MoveFileExW(
+				tmpFilePath.GetCStr(),
+				snapshotFilePath.GetCStr(),
+				MOVEFILE_REPLACE_EXISTING)) {
+		ThrowSystemError(L"replace", snapshotFilePath);
+	}
+
+}
+
+bool RuleSetSnapshot::Load(
+			const WString &xmlFilePath,
+			const WString &snapshotFilePath,
+			RuleSet &result) {
+
+	FileHandle file(
+		CreateFileW(
+			snapshotFilePath.GetCStr(),
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			NULL,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+			NULL));
+	if (!file.IsValid()) {
+		Log::GetInstance().AppendDebug(
+			"Rule set snapshot \"%1%\" is not found.",
+			ConvertString<String>(snapshotFilePath).GetCStr());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file.Get(), &fileSize)) {
+		ThrowSystemError(L"get size of", snapshotFilePath);
+	}
+	if (fileSize.QuadPart < LONGLONG(sizeof(Header))) {
+		LogCorrupted(snapshotFilePath);
+		return false;
+	}
+
+	FileHandle mapping(
+		CreateFileMappingW(file.Get(), NULL, PAGE_READONLY, 0, 0, NULL));
+	if (!mapping.IsValid()) {
+		ThrowSystemError(L"map", snapshotFilePath);
+	}
+	const FileView view(MapViewOfFile(mapping.Get(), FILE_MAP_READ, 0, 0, 0));
+	if (!view.Get()) {
+		ThrowSystemError(L"map view of", snapshotFilePath);
+	}
+
+	const Header &header = *reinterpret_cast<const Header *>(view.Get());
+	if (	memcmp(header.signature, snapshotSignature, sizeof(header.signature))
+			|| header.formatVersion != formatVersion) {
+		Log::GetInstance().AppendDebug(
+			"Rule set snapshot \"%1%\" has other format version.",
+			ConvertString<String>(snapshotFilePath).GetCStr());
+		return false;
+	}
+
+	XmlFileStamp xmlFileStamp;
+	if (	!GetXmlFileStamp(xmlFilePath, xmlFileStamp)
+			|| header.xmlFileSize != xmlFileStamp.size
+			|| header.xmlFileModificationTime != xmlFileStamp.modificationTime) {
+		Log::GetInstance().AppendDebug(
+			"Rule set snapshot \"%1%\" is stale.",
+			ConvertString<String>(snapshotFilePath).GetCStr());
+		return false;
+	}
+
+	const char *const data = view.Get() + sizeof(Header);
+	const size_t dataSize = size_t(fileSize.QuadPart - sizeof(Header));
+	if (	header.dataSize != dataSize
+			|| header.dataChecksum != CalcChecksum(data, dataSize)) {
+		LogCorrupted(snapshotFilePath);
+		return false;
+	}
+
+	if (!Deserialize(data, dataSize, result)) {
+		LogCorrupted(snapshotFilePath);
+		return false;
+	}
+
+	return true;
+
+}
+
+void RuleSetSnapshot::Serialize(const RuleSet &ruleSet, std::vector<char> &result) {
+	Writer writer(result);
+	writer.Write(ruleSet.GetServices());
+	writer.Write(ruleSet.GetTunnels());
+}
+
+bool RuleSetSnapshot::Deserialize(
+			const char *data,
+			size_t size,
+			RuleSet &result) {
+	ServiceRuleSet services;
+	TunnelRuleSet tunnels;
+	try {
+		Reader reader(data, data + size);
+		reader.Read(services);
+		reader.Read(tunnels);
+		if (!reader.IsEnd()) {
+			return false;
+		}
+	} catch (const Reader::CorruptedException &) {
+		return false;
+	}
+	RuleSet(services, tunnels).Swap(result);
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,76 @@
+/**************************************************************************
+ *   Created: 2026/10/19 22:34
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__RuleSetSnapshot_hpp__2610192234
+#define INCLUDED_FILE__TUNNELEX__RuleSetSnapshot_hpp__2610192234
+
+#include "String.hpp"
+#include "Api.h"
+
+#include <vector>
+
+namespace TunnelEx {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class RuleSet;
+
+	//! Compiled binary snapshot of the rule set.
+	/** The snapshot stores the rule set XML file size and modification time
+	  * and can replace XML parsing and validation only while the XML file
+	  * is the same.
+	  */
+	class TUNNELEX_CORE_API RuleSetSnapshot {
+
+	private:
+
+		RuleSetSnapshot();
+
+	public:
+
+		//! Saves snapshot of the rule set, just loaded from or saved to the XML file.
+		/** @throw TunnelEx::SystemException
+		  */
+		static void Save(
+				const ::TunnelEx::RuleSet &,
+				const ::TunnelEx::WString &xmlFilePath,
+				const ::TunnelEx::WString &snapshotFilePath);
+
+		//! Loads rule set from the snapshot.
+		/** @throw TunnelEx::SystemException
+		  * @return	false if the snapshot does not exist, stale, has other
+		  *			format version or corrupted, result is not changed
+		  *			in this case.
+		  */
+		static bool Load(
+				const ::TunnelEx::WString &xmlFilePath,
+				const ::TunnelEx::WString &snapshotFilePath,
+				::TunnelEx::RuleSet &result);
+
+	public:
+
+		//! Appends rule set in the snapshot binary form to the buffer.
+		static void Serialize(const ::TunnelEx::RuleSet &, std::vector<char> &);
+
+		//! Restores rule set from the snapshot binary form.
+		/** @return	false if data is corrupted, result is not changed in
+		  *			this case.
+		  */
+		static bool Deserialize(
+				const char *data,
+				size_t size,
+				::TunnelEx::RuleSet &result);
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__RuleSetSnapshot_hpp__2610192234
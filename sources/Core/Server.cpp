@@ -149,6 +149,14 @@ public:
 		return m_worker->GetOpenedEndpointsNumber();
 	}
 
+	void GetTunnelStats(std::vector<TunnelStat> &result) const {
+		CtrlLock lock(m_ctrlMutex);
+		if (!m_worker.get()) {
+			throw LogicalException(L"Could not get tunnel stats, server does not started");
+		}
+		m_worker->GetTunnelStats(result);
+	}
+
 	const SslCertificatesStorage & GetCertificatesStorage() const {
 		if (m_certificatesStorage == 0) {
 			throw LogicalException(L"SSL certificates storage does not opened");
@@ -234,6 +242,12 @@ size_t Singletons::ServerPolicy::GetOpenedEndpointsNumber() const {
 	return m_pimpl->GetOpenedEndpointsNumber();
 }
 
+void Singletons::ServerPolicy::GetTunnelStats(
+			std::vector<TunnelStat> &result)
+		const {
+	m_pimpl->GetTunnelStats(result);
+}
+
 const SslCertificatesStorage & Singletons::ServerPolicy::GetCertificatesStorage() const {
 	return m_pimpl->GetCertificatesStorage();
 }
@@ -13,6 +13,7 @@
 #include "Rule.hpp"
 #include "String.hpp"
 #include "Singleton.hpp"
+#include "TrafficStat.hpp"
 #include "Time.h"
 #include "Api.h"
 
@@ -61,6 +62,8 @@ namespace TunnelEx {
 			//! @todo: temp-method remove when tunnel collection will be implemented [2008/09/10 0:28]
 			size_t GetTunnelsNumber() const;
 			size_t GetOpenedEndpointsNumber() const;
+			//! Returns traffic snapshot of all active tunnels.
+			void GetTunnelStats(std::vector<::TunnelEx::TunnelStat> &) const;
 
 			bool UpdateRule(const ::TunnelEx::ServiceRule &);
 			bool UpdateRule(const ::TunnelEx::TunnelRule &);
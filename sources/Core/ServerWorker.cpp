@@ -25,6 +25,8 @@
 #include "Error.hpp"
 #include "Exceptions.hpp"
 #include "Licensing.hpp"
+#include "Metrics.hpp"
+#include "Tracer.hpp"
 
 
 namespace mi = boost::multi_index;
@@ -43,6 +45,9 @@ namespace {
 	
 	//! @todo: hadcored min thread number, move to options or config
 	const auto proactorMinThreadCount = 8; // see TEX-689 for details
+
+	//! @todo: hardcored maximum rules activation thread count
+	const auto activationMaxThreadCount = 8;
 	
 	static_assert(
 		openingTunnelMaxThreadCount >= openingTunnelMinThreadCount,
@@ -166,6 +171,7 @@ public:
 	SharedPtr<RecursiveMutex> mutex;
 	std::vector<SharedPtr<Filter> > filters;
 	unsigned long long acceptedConnectionNumb;
+	SharedPtr<Singletons::MetricsPolicy::RuleCounters> metrics;
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -395,6 +401,41 @@ private:
 
 	};
 
+	//! Rules activation at server start.
+	struct ActivationState : private boost::noncopyable {
+
+		typedef ACE_Thread_Mutex Mutex;
+		typedef ACE_Guard<Mutex> Lock;
+		typedef ACE_Thread_Condition<Mutex> Condition;
+
+		struct RuleActivation : private boost::noncopyable {
+			explicit RuleActivation(const TunnelRule &rule)
+					: rule(rule),
+					activeRule(rule.GetUuid(), true),
+					isOpened(false) {
+				//...//
+			}
+			const TunnelRule &rule;
+			ActiveRule activeRule;
+			bool isOpened;
+		};
+
+		ActivationState()
+				: completedCondition(mutex),
+				nextRuleIndex(0),
+				activeThreadsNumber(0) {
+			//...//
+		}
+
+		Mutex mutex;
+		Condition completedCondition;
+
+		boost::ptr_vector<RuleActivation> rules;
+		volatile long nextRuleIndex;
+		size_t activeThreadsNumber;
+
+	};
+
 	struct TunnelOpeningState : private boost::noncopyable {
 
 		typedef ACE_Thread_Mutex Mutex;
@@ -453,7 +494,8 @@ private:
 		TG_TUNNEL_OPENING,
 		TG_PROACTOR,
 		TG_REACTOR,
-		TG_UPDATING
+		TG_UPDATING,
+		TG_ACTIVATION
 	};
 
 public:
@@ -526,6 +568,14 @@ public:
 			0,
 			ACE_DEFAULT_THREAD_PRIORITY,
 			TG_UPDATING);
+		m_threadManager.spawn(
+			&MetricsDumpThread,
+			this,
+			THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED,
+			0,
+			0,
+			ACE_DEFAULT_THREAD_PRIORITY,
+			TG_UPDATING);
 	}
 
 	~Implementation() {
@@ -582,6 +632,24 @@ public:
 		return m_activeTunnels.size();
 	}
 
+	void GetTunnelStats(std::vector<TunnelStat> &result) const {
+		std::vector<boost::shared_ptr<Tunnel> > tunnels;
+		{
+			ActiveTunnelsReadLock lock(m_activeTunnelsMutex);
+			tunnels.reserve(m_activeTunnels.size());
+			foreach (const ActiveTunnel &activeTunnel, m_activeTunnels) {
+				tunnels.push_back(activeTunnel.tunnel);
+			}
+		}
+		// counters are interlocked, so snapshot doesn't require the lock
+		std::vector<TunnelStat> stats;
+		stats.reserve(tunnels.size());
+		foreach (const boost::shared_ptr<Tunnel> &tunnel, tunnels) {
+			stats.push_back(tunnel->GetStat());
+		}
+		stats.swap(result);
+	}
+
 	AutoPtr<EndpointAddress> GetRealOpenedEndpointAddress(
 				const WString &ruleUuid,
 				const WString &endpointUuid)
@@ -632,13 +700,136 @@ public:
 	
 	}
 
+	//! Activates rule set at server start.
+	/** Tunnel rules with listening inputs only, which don't use licensed
+	  * features, are opened by the activation threads pool in parallel and
+	  * the rule opening error doesn't affect other rules. Services and other
+	  * tunnel rules are updated one by one.
+	  */
+	bool Activate(const RuleSet &rules) {
+
+		const ACE_Time_Value startTime = ACE_OS::gettimeofday();
+		bool result = true;
+
+		{
+			const size_t rulesNumb = rules.GetServices().GetSize();
+			for (size_t i = 0; i < rulesNumb; ++i) {
+				if (!Update(rules.GetServices()[i])) {
+					result = false;
+				}
+			}
+		}
+
+		std::auto_ptr<ActivationState> state(new ActivationState);
+		std::vector<const TunnelRule *> serialRules;
+		{
+			RulesReadLock lock(m_rulesMutex);
+			const size_t rulesNumb = rules.GetTunnels().GetSize();
+			for (size_t i = 0; i < rulesNumb; ++i) {
+				const TunnelRule &rule = rules.GetTunnels()[i];
+				if (IsParallelActivationPossible(rule)) {
+					state->rules.push_back(new ActivationState::RuleActivation(rule));
+				} else {
+					serialRules.push_back(&rule);
+				}
+			}
+			if (	state->rules.size() > 0
+					&& !m_ruleSetLicense.IsFeatureAvailable(
+						m_activeRules.size() + state->rules.size())) {
+				// license restriction has to be applied rule by rule
+				serialRules.clear();
+				state->rules.clear();
+				for (size_t i = 0; i < rulesNumb; ++i) {
+					serialRules.push_back(&rules.GetTunnels()[i]);
+				}
+			}
+		}
+
+		size_t threadsNumber = 0;
+		size_t parallelRulesNumber = 0;
+		if (state->rules.size() > 0) {
+			const long processorsNumber = ACE_OS::num_processors_online();
+			const size_t maxThreadsNumber = std::min<size_t>(
+				processorsNumber > 0 ? processorsNumber : 1,
+				activationMaxThreadCount);
+			const size_t requiredThreadsNumber
+				= std::min(state->rules.size(), maxThreadsNumber);
+			m_activationState = state;
+			ActivationState::Lock lock(m_activationState->mutex);
+			for ( ; threadsNumber < requiredThreadsNumber; ++threadsNumber) {
+				const int spawnResult = m_threadManager.spawn(
+					&ActivationThread,
+					this,
+					THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED,
+					0,
+					0,
+					ACE_DEFAULT_THREAD_PRIORITY,
+					TG_ACTIVATION);
+				if (spawnResult == -1) {
+					break;
+				}
+				++m_activationState->activeThreadsNumber;
+			}
+			if (threadsNumber > 0) {
+				while (m_activationState->activeThreadsNumber > 0) {
+					m_activationState->completedCondition.wait();
+				}
+				parallelRulesNumber = m_activationState->rules.size();
+			} else {
+				Log::GetInstance().AppendWarn(
+					"Failed to start rules activation threads,"
+						" rules will be activated one by one.");
+				foreach (
+						const ActivationState::RuleActivation &activation,
+						m_activationState->rules) {
+					serialRules.push_back(&activation.rule);
+				}
+			}
+		}
+
+		if (parallelRulesNumber > 0) {
+			foreach (
+					const ActivationState::RuleActivation &activation,
+					m_activationState->rules) {
+				if (!CommitActivation(activation)) {
+					result = false;
+				}
+			}
+		}
+		if (m_activationState.get()) {
+			// closes acceptors of failed rules
+			m_activationState->rules.clear();
+		}
+
+		foreach (const TunnelRule *rule, serialRules) {
+			if (!Update(*rule)) {
+				result = false;
+			}
+		}
+
+		{
+			Format message(
+				"Rules activated in %1% ms: %2% tunnel rule(s) by %3% thread(s)"
+					", %4% rule(s) one by one.");
+			message
+				% (ACE_OS::gettimeofday() - startTime).msec()
+				% parallelRulesNumber
+				% threadsNumber
+				% (rules.GetServices().GetSize() + serialRules.size());
+			Log::GetInstance().AppendInfo(message.str());
+		}
+
+		return result;
+
+	}
+
 	bool DeleteRule(const WString &uuid) {
 		
 		RulesWriteLock lock(m_rulesMutex);
 		if (Log::GetInstance().IsDebugRegistrationOn()) {
 			Log::GetInstance().AppendDebug(
 				"Deleting rule %1%...",
-				ConvertString<String>(uuid).GetCStr());
+				uuid);
 		}
 
 		bool wasDeleted = false;
@@ -652,7 +843,7 @@ public:
 			if (pos == index.end()) {
 				Log::GetInstance().AppendDebug(
 					"Failed to find rule %1% in active list.",
-					ConvertString<String>(uuid).GetCStr());
+					uuid);
 			} else {
 				isTunnel = pos->isTunnel;
 				activeRules.erase(pos);
@@ -660,7 +851,7 @@ public:
 					Log::GetInstance().AppendDebug(
 						"The %1% rule %2% has been removed from active list.",
 						isTunnel ? "tunnel" : "service",
-						ConvertString<String>(uuid).GetCStr());
+						uuid);
 				}
 				wasDeleted = true;
 				wasDeletedFromActive = true;
@@ -694,7 +885,7 @@ public:
 			if (Log::GetInstance().IsDebugRegistrationOn()) {
 				Log::GetInstance().AppendDebug(
 					"The rule %1% has been removed from checking list.",
-					ConvertString<String>(uuid).GetCStr());
+					uuid);
 			}
 			wasDeleted = true;
 		}
@@ -716,6 +907,10 @@ public:
 			swap(*tunnelRulesToCheck, m_tunnelRulesToCheck);
 		}
 
+		if (wasDeleted) {
+			Metrics::GetInstance().RemoveRuleCounters(uuid);
+		}
+
 		return wasDeleted;
 
 	}
@@ -737,6 +932,8 @@ public:
 					return message;
 				});
 			AutoPtr<Connection> inConnection = acceptor.Accept();
+			ruleInfo->metrics->OnAccept();
+			Trace(TRACE_EVENT_ACCEPT, inConnection->GetInstanceId());
 			if (!inConnection->IsOneWay()) {
 				const unsigned long limit
 					= ruleInfo->rule->GetAcceptedConnectionsLimit();
@@ -778,6 +975,8 @@ public:
 			tunnelsToSwitchInQueue = m_tunnelOpeningState.tunnels.size();
 			m_tunnelOpeningState.newConnections.push_back(
 				TunnelOpeningState::NewConnection(ruleInfo, inConnection));
+			Metrics::GetInstance().SetTunnelOpeningQueueSize(
+				newConnectionsInQueue + tunnelsToSwitchInQueue + 1);
 			m_tunnelOpeningState.condition.signal();
 		}
 		StartServiceThread(newConnectionsInQueue, tunnelsToSwitchInQueue);
@@ -822,6 +1021,7 @@ public:
 
 		if (!tunnel->IsDead()) {
 			if (tunnel->IsSetupFailed()) {
+				tunnel->GetMetrics().OnSetupFail();
 				// tunnel object will be closed if no destinations will be opened,
 				// even if all other connections already closed.
 				SwitchTunnel(tunnel);
@@ -832,14 +1032,14 @@ public:
 					if (Log::GetInstance().IsDebugRegistrationOn()) {
 						Log::GetInstance().AppendDebug(
 							"Deleting rule %1%...",
-							ConvertString<String>(rule.GetUuid()).GetCStr());
+							rule.GetUuid());
 					}
 					RulesWriteLock lock(m_rulesMutex);
 					m_activeRules.get<ByUuid>().erase(rule.GetUuid());
 				}
 				Log::GetInstance().AppendDebug(
 					"Trying to reopen rule %1% for static tunnel...",
-					ConvertString<String>(rule.GetUuid()).GetCStr());
+					rule.GetUuid());
 				Update(rule);
 			} else {
 				tunnel->MarkAsDead();
@@ -858,6 +1058,8 @@ public:
 			tunnelsToSwitchInQueue = m_tunnelOpeningState.tunnels.size();
 			m_tunnelOpeningState.tunnels.push_back(tunnel);
 			tunnel.reset();
+			Metrics::GetInstance().SetTunnelOpeningQueueSize(
+				newConnectionsInQueue + tunnelsToSwitchInQueue + 1);
 			m_tunnelOpeningState.condition.signal();
 		}
 		StartServiceThread(newConnectionsInQueue, tunnelsToSwitchInQueue);
@@ -918,6 +1120,7 @@ private:
 		const boost::shared_ptr<RuleInfo> ruleInfo(new RuleInfo);
 		ruleInfo->rule.Reset(new TunnelRule(rule));
 		ruleInfo->mutex.Reset(new RecursiveMutex);
+		ruleInfo->metrics = Metrics::GetInstance().GetRuleCounters(rule.GetUuid());
 		ModulesFactory::GetInstance().CreateFilters(
 			ruleInfo->rule,
 			ruleInfo->mutex,
@@ -1000,7 +1203,13 @@ private:
 						?	reader
 						:	CreateConnection(endpoint, writerAddress, L"write");
 					boost::shared_ptr<Tunnel> tunnel(
-						new Tunnel(true, m_myInterface, ruleInfo->rule, reader, writer));
+						new Tunnel(
+							true,
+							m_myInterface,
+							ruleInfo->rule,
+							ruleInfo->metrics,
+							reader,
+							writer));
 					assert(
 						tunnels.get<ByInstance>().find(tunnel->GetInstanceId())
 						== tunnels.get<ByInstance>().end());
@@ -1031,7 +1240,7 @@ private:
 		if (Log::GetInstance().IsDebugRegistrationOn()) {
 			Log::GetInstance().AppendDebug(
 				"Updating tunnel rule %1%...",
-				ConvertString<String>(rule.GetUuid()).GetCStr());
+				rule.GetUuid());
 		}
 
 		RulesWriteLock lock(m_rulesMutex);
@@ -1152,13 +1361,13 @@ private:
 		if (Log::GetInstance().IsDebugRegistrationOn()) {
 			Log::GetInstance().AppendDebug(
 				"Updating service rule %1%...",
-				ConvertString<String>(rule.GetUuid()).GetCStr());
+				rule.GetUuid());
 		}
 
 		if (rule.GetServices().GetSize() == 0) {
 			Log::GetInstance().AppendDebug(
 				"Service rule %1% is empty.",
-				ConvertString<String>(rule.GetUuid()).GetCStr());
+				rule.GetUuid());
 			return false;
 		}
 
@@ -1278,6 +1487,139 @@ private:
 
 	}
 
+	//! Checks that endpoint resource doesn't use licensed module features.
+	/** Modules keep license state in function-local statics, which are not
+	  * thread-safe, and licensed features (SSL/TLS, proxy and so on) are set
+	  * by resource identifier parameters.
+	  */
+	static bool IsLicenseFreeResource(const WString &resourceIdentifier) {
+		return wcschr(resourceIdentifier.GetCStr(), L'?') == NULL;
+	}
+
+	//! Checks rule for activation without tunnels opening and license checks.
+	/** Should be called under rules lock.
+	  */
+	bool IsParallelActivationPossible(const TunnelRule &rule) const {
+		if (	!rule.IsEnabled()
+				|| m_activeRules.get<ByUuid>().find(rule.GetUuid())
+					!= m_activeRules.get<ByUuid>().end()
+				|| m_tunnelRulesToCheck.get<ByUuid>().find(rule.GetUuid())
+					!= m_tunnelRulesToCheck.get<ByUuid>().end()) {
+			return false;
+		}
+		const RuleEndpointCollection &inputs = rule.GetInputs();
+		const size_t inputsNumb = inputs.GetSize();
+		if (inputsNumb == 0) {
+			return false;
+		}
+		for (size_t i = 0; i < inputsNumb; ++i) {
+			const RuleEndpoint &endpoint = inputs[i];
+			if (	endpoint.IsCombined()
+					?	!endpoint.IsCombinedAcceptor()
+					:	endpoint.GetReadWriteAcceptor() == Endpoint::ACCEPTOR_NONE) {
+				return false;
+			}
+			if (	endpoint.GetPreListeners().GetSize() > 0
+					|| endpoint.GetPostListeners().GetSize() > 0) {
+				return false;
+			}
+			if (	endpoint.IsCombined()
+					?	!IsLicenseFreeResource(endpoint.GetCombinedResourceIdentifier())
+					:	!IsLicenseFreeResource(endpoint.GetReadResourceIdentifier())
+							|| !IsLicenseFreeResource(endpoint.GetWriteResourceIdentifier())) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void PrepareActivation(ActivationState::RuleActivation &activation) const {
+		try {
+			ActiveTunnels tunnels;
+			std::vector<boost::shared_ptr<Tunnel> > newTunnels;
+			IndexedTunnelRuleSet rulesToCheck;
+			OpenRule(
+				activation.rule,
+				activation.activeRule,
+				tunnels,
+				newTunnels,
+				rulesToCheck);
+			assert(tunnels.size() == 0);
+			assert(newTunnels.size() == 0);
+			assert(rulesToCheck.size() == 0);
+			activation.isOpened = true;
+		} catch (const TunnelEx::LocalException &ex) {
+			Format message("Failed to activate tunnel rule %1%: \"%2%\".");
+			message
+				% ConvertString<String>(activation.rule.GetUuid()).GetCStr()
+				% ConvertString<String>(ex.GetWhat()).GetCStr();
+			Log::GetInstance().AppendError(message.str());
+		} catch (const std::exception &ex) {
+			Format message("Failed to activate tunnel rule %1%: \"%2%\".");
+			message
+				% ConvertString<String>(activation.rule.GetUuid()).GetCStr()
+				% ex.what();
+			Log::GetInstance().AppendError(message.str());
+		}
+	}
+
+	bool CommitActivation(const ActivationState::RuleActivation &activation) {
+		if (!activation.isOpened) {
+			return false;
+		}
+		RulesWriteLock lock(m_rulesMutex);
+		assert(
+			m_activeRules.get<ByUuid>().find(activation.activeRule.uuid)
+			== m_activeRules.get<ByUuid>().end());
+		m_activeRules.insert(activation.activeRule);
+		if (Log::GetInstance().IsDebugRegistrationOn()) {
+			Log::GetInstance().AppendDebug(
+				"The new tunnel rule %1% has been activated.",
+				activation.rule.GetUuid());
+		}
+		return
+			activation.rule.GetInputs().GetSize()
+			== activation.activeRule.acceptHandlers.size();
+	}
+
+	static ACE_THR_FUNC_RETURN ActivationThread(void *param) {
+
+		Log::GetInstance().AppendDebug("Started rules activation thread.");
+
+		Implementation &instance = *static_cast<Implementation *>(param);
+		ActivationState &state = *instance.m_activationState;
+
+		for ( ; ; ) {
+			const size_t index
+				= size_t(Interlocked::Increment(state.nextRuleIndex) - 1);
+			if (index >= state.rules.size()) {
+				break;
+			}
+			instance.PrepareActivation(state.rules[index]);
+		}
+
+		{
+			ActivationState::Lock lock(state.mutex);
+			assert(state.activeThreadsNumber > 0);
+			if (--state.activeThreadsNumber == 0) {
+				state.completedCondition.signal();
+			}
+		}
+
+		// Thread stays alive until server stop as the I/O, started by it,
+		// will be canceled at the thread exit.
+		{
+			ServerStopLock lock(instance.m_serverStopMutex);
+			while (!instance.m_isDestructionMode) {
+				instance.m_serverStopCondition.wait();
+			}
+		}
+
+		Log::GetInstance().AppendDebug("Rules activation thread completed.");
+		return 0;
+
+	}
+
 	static ACE_THR_FUNC_RETURN ServicesSchedulerThread(void *param) {
 		
 		Log::GetInstance().AppendDebug("Started services scheduler thread.");
@@ -1416,6 +1758,29 @@ private:
 		return 0;
 	}
 
+	static ACE_THR_FUNC_RETURN MetricsDumpThread(void *param) {
+		Log::GetInstance().AppendDebug("Started metrics dump thread.");
+		Implementation &instance = *static_cast<Implementation *>(param);
+		std::auto_ptr<ServerStopLock> lock(
+			new ServerStopLock(instance.m_serverStopMutex));
+		for ( ; !instance.m_isDestructionMode; ) {
+			//! @todo: hardcoded metrics dump period, move to options or config
+			const ACE_Time_Value waitUntilTime
+				= ACE_OS::gettimeofday() + ACE_Time_Value(5 * 60);
+			lock.reset(new ServerStopLock(instance.m_serverStopMutex));
+			const int waitResult
+				= instance.m_serverStopCondition.wait(&waitUntilTime);
+			if (waitResult != -1 || instance.m_isDestructionMode) {
+				break;
+			}
+			assert(errno == ETIME);
+			Metrics::GetInstance().DumpAllocators();
+		}
+		Metrics::GetInstance().DumpAllocators();
+		Log::GetInstance().AppendDebug("Metrics dump thread completed.");
+		return 0;
+	}
+
 	bool CheckTunnelRules() {
 		IndexedTunnelRuleSet rulesToCheck;
 		{
@@ -1449,6 +1814,8 @@ private:
 			tunnelsToSwitchInQueue = m_tunnelOpeningState.tunnels.size();
 			m_tunnelOpeningState.tunnels.push_back(tunnel);
 			tunnel.reset();
+			Metrics::GetInstance().SetTunnelOpeningQueueSize(
+				newConnectionsInQueue + tunnelsToSwitchInQueue + 1);
 			m_tunnelOpeningState.condition.signal();
 		}
 		StartServiceThread(newConnectionsInQueue, tunnelsToSwitchInQueue);
@@ -1496,7 +1863,13 @@ private:
 			}
 			assert(reader && writer);
 			tunnel.reset(
-				new Tunnel(false, m_myInterface, ruleInfo->rule, reader, writer));
+				new Tunnel(
+					false,
+					m_myInterface,
+					ruleInfo->rule,
+					ruleInfo->metrics,
+					reader,
+					writer));
 		}
 		OpenTunnelImplementation(tunnel);
 	}
@@ -1768,6 +2141,8 @@ private:
 				} else {
 					continue;
 				}
+				Metrics::GetInstance().SetTunnelOpeningQueueSize(
+					newConnectionsInQueue + tunnelsToSwitchInQueue);
 			
 				break;
 			
@@ -1792,6 +2167,7 @@ private:
 							newConnection.ruleInfo,
 							newConnection.connection);
 					} catch	(const TunnelEx::DestinationConnectionOpeningException &ex) {
+						newConnection.ruleInfo->metrics->OnSetupFail();
 						ReportException(newConnection.ruleInfo->rule->GetErrorsTreatment(), ex);
 					}
 				} else if (tunnel && !tunnel->IsDead()) {
@@ -1925,6 +2301,7 @@ private:
 
 	RuleUpdatingState m_ruleUpdatingState;
 	TunnelOpeningState m_tunnelOpeningState;
+	std::auto_ptr<ActivationState> m_activationState;
 
 	Licensing::FsLocalStorageState m_ruleSetLicenseState;
 	Licensing::RuleSetLicense m_ruleSetLicense;
@@ -1956,6 +2333,10 @@ size_t ServerWorker::GetTunnelsNumber() const {
 	return m_pimpl->GetTunnelsNumber();
 }
 
+void ServerWorker::GetTunnelStats(std::vector<TunnelStat> &result) const {
+	m_pimpl->GetTunnelStats(result);
+}
+
 AutoPtr<EndpointAddress> ServerWorker::GetRealOpenedEndpointAddress(
 			const WString &ruleUuid,
 			const WString &endpointUuid)
@@ -1973,24 +2354,7 @@ bool ServerWorker::Update(const TunnelRule &rule) {
 
 bool ServerWorker::Update(const RuleSet &rules) {
 	try {
-		bool result = true;
-		{
-			const size_t rulesNumb = rules.GetServices().GetSize();
-			for (size_t i = 0; i < rulesNumb; ++i) {
-				if (!Update(rules.GetServices()[i])) {
-					result = false;
-				}
-			}
-		}
-		{
-			const size_t rulesNumb = rules.GetTunnels().GetSize();
-			for (size_t i = 0; i < rulesNumb; ++i) {
-				if (!Update(rules.GetTunnels()[i])) {
-					result = false;
-				}
-			}
-		}
-		return result;
+		return m_pimpl->Activate(rules);
 	} catch (const LicenseException &ex) {
 		Log::GetInstance().AppendError(
 			ConvertString<String>(ex.GetWhat()).GetCStr());
@@ -14,6 +14,7 @@
 #include "SmartPtr.hpp"
 #include "Server.hpp"
 #include "Instance.hpp"
+#include "TrafficStat.hpp"
 #include "IoHandle.h"
 
 class ACE_Proactor;
@@ -56,6 +57,7 @@ namespace TunnelEx {
 		size_t GetOpenedEndpointsNumber() const;
 		//! @todo: temp-method remove when tunnel collection will be implemented [2008/09/10 0:28]
 		size_t GetTunnelsNumber() const;
+		void GetTunnelStats(std::vector<TunnelStat> &) const;
 
 		/**
 		  * @throw TunnelEx::LogicalException
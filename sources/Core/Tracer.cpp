@@ -0,0 +1,324 @@
+/**************************************************************************
+ *   Created: 2026/10/19 18:34
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Tracer.hpp"
+#include "Locking.hpp"
+
+using namespace TunnelEx;
+using namespace TunnelEx::Singletons;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	struct EventInfo {
+		const char *name;
+		const char *category;
+		//! Chrome trace phase: "b" and "e" - async begin and end, "i" - instant.
+		const char *phase;
+	};
+
+	const EventInfo events[numberOfTraceEvents] = {
+		{"accept",		"server",		"i"},
+		{"setup",		"connection",	"b"},
+		{"setup",		"connection",	"e"},
+		{"read",		"connection",	"b"},
+		{"read",		"connection",	"e"},
+		{"write",		"connection",	"b"},
+		{"write",		"connection",	"e"},
+		{"dispatch",	"connection",	"i"}
+	};
+
+	long long GetTime() throw() {
+		LARGE_INTEGER result;
+		QueryPerformanceCounter(&result);
+		return result.QuadPart;
+	}
+
+	long long Read(const volatile long long &value) throw() {
+		return Interlocked::CompareExchange(
+			const_cast<volatile long long &>(value),
+			0,
+			0);
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+class TracerPolicy::Implementation : private boost::noncopyable {
+
+public:
+
+	struct Event {
+		long long time;
+		Instance::Id objectId;
+		size_t size;
+		unsigned long threadId;
+		TraceEvent event;
+	};
+
+	//! Events ring buffer, written only by one thread.
+	/** At the thread exit the buffer is released and the next new thread
+	  * continues to write into it, so the number of buffers is limited by
+	  * the number of simultaneously working threads. Events of the exited
+	  * thread stay for the export until they will be overwritten.
+	  */
+	class Buffer : private boost::noncopyable {
+
+	public:
+
+		Buffer()
+				: m_position(0),
+				m_isUsed(1) {
+			//...//
+		}
+
+	public:
+
+		//! Marks the buffer as free, could be called from any thread.
+		void Release() throw() {
+			Interlocked::Exchange(m_isUsed, 0);
+		}
+
+		//! Returns true if the buffer was free and now is owned by the caller.
+		bool Acquire() throw() {
+			return Interlocked::CompareExchange(m_isUsed, 1, 0) == 0;
+		}
+
+		void Append(const Event &event) throw() {
+			m_events[size_t(m_position) & (size - 1)] = event;
+			// publishing for the export
+			Interlocked::ExchangeAdd(m_position, 1);
+		}
+
+		void Copy(std::vector<Event> &result) const {
+			const long long end = Read(m_position);
+			const long long begin = std::max(0ll, end - size);
+			std::vector<Event> copy;
+			copy.reserve(size_t(end - begin));
+			for (long long i = begin; i < end; ++i) {
+				copy.push_back(m_events[size_t(i) & (size - 1)]);
+			}
+			// events, that could be overwritten by the writer while copying
+			const long long overwrittenEnd = Read(m_position) + 1 - size;
+			if (overwrittenEnd > begin) {
+				copy.erase(
+					copy.begin(),
+					copy.begin() + size_t(std::min(overwrittenEnd, end) - begin));
+			}
+			copy.swap(result);
+		}
+
+	private:
+
+		//! @todo: hardcoded events number for each thread
+		enum {
+			size = 1 << 12
+		};
+
+		volatile long long m_position;
+		volatile long m_isUsed;
+		Event m_events[size];
+
+	};
+
+	//! Thread buffer reference, releases buffer at the thread exit.
+	class BufferHolder : private boost::noncopyable {
+	public:
+		BufferHolder()
+				: buffer(nullptr) {
+			//...//
+		}
+		~BufferHolder() {
+			if (buffer) {
+				buffer->Release();
+			}
+		}
+	public:
+		Buffer *buffer;
+	};
+
+	typedef ACE_Thread_Mutex BuffersMutex;
+	typedef ACE_Guard<BuffersMutex> BuffersLock;
+
+public:
+
+	Implementation() {
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		m_frequency = frequency.QuadPart;
+	}
+
+public:
+
+	void Append(
+				TraceEvent event,
+				Instance::Id objectId,
+				size_t size)
+			throw() {
+		assert(event < numberOfTraceEvents);
+		BufferHolder *holder = m_threadBuffer.ts_object();
+		if (!holder) {
+			holder = CreateBuffer();
+			if (!holder) {
+				return;
+			}
+		}
+		const Event record = {
+			GetTime(),
+			objectId,
+			size,
+			GetCurrentThreadId(),
+			event
+		};
+		holder->buffer->Append(record);
+	}
+
+	void Export(std::string &result) const {
+
+		std::ostringstream os;
+		os.imbue(std::locale::classic());
+		os.setf(std::ios::fixed);
+		os.precision(3);
+
+		const unsigned long processId = GetCurrentProcessId();
+
+		os << "{\"traceEvents\":[";
+		bool isFirst = true;
+		std::vector<Event> bufferEvents;
+		foreach (const Buffer *buffer, GetBuffers()) {
+			buffer->Copy(bufferEvents);
+			foreach (const Event &event, bufferEvents) {
+				const EventInfo &info = events[event.event];
+				if (!isFirst) {
+					os << ",";
+				}
+				isFirst = false;
+				os
+					<< std::endl
+					<< "{\"name\":\"" << info.name << "\""
+					<< ",\"cat\":\"" << info.category << "\""
+					<< ",\"ph\":\"" << info.phase << "\"";
+				if (info.phase[0] == 'i') {
+					os << ",\"s\":\"t\"";
+				} else {
+					os << ",\"id\":\"" << event.objectId << "\"";
+				}
+				os
+					<< ",\"pid\":" << processId
+					<< ",\"tid\":" << event.threadId
+					<< ",\"ts\":" << (double(event.time) * 1000000 / m_frequency)
+					<< ",\"args\":{\"object\":" << event.objectId
+					<< ",\"size\":" << event.size << "}}";
+			}
+		}
+		os << std::endl << "],\"displayTimeUnit\":\"ns\"}" << std::endl;
+
+		result = os.str();
+
+	}
+
+private:
+
+	BufferHolder * CreateBuffer() throw() {
+		try {
+			std::auto_ptr<BufferHolder> holder(new BufferHolder);
+			Buffer *buffer = nullptr;
+			{
+				BuffersLock lock(m_buffersMutex);
+				foreach (Buffer &freeBuffer, m_buffers) {
+					if (freeBuffer.Acquire()) {
+						buffer = &freeBuffer;
+						break;
+					}
+				}
+				if (!buffer) {
+					buffer = new Buffer;
+					// takes ownership, deletes buffer at error
+					m_buffers.push_back(buffer);
+				}
+			}
+			holder->buffer = buffer;
+			// takes ownership, deletes holder at the thread exit
+			m_threadBuffer.ts_object(holder.get());
+			return holder.release();
+		} catch (...) {
+			// tracing is not a reason to break the data path
+			return nullptr;
+		}
+	}
+
+	std::vector<const Buffer *> GetBuffers() const {
+		std::vector<const Buffer *> result;
+		BuffersLock lock(m_buffersMutex);
+		result.reserve(m_buffers.size());
+		foreach (const Buffer &buffer, m_buffers) {
+			result.push_back(&buffer);
+		}
+		return result;
+	}
+
+private:
+
+	long long m_frequency;
+
+	mutable BuffersMutex m_buffersMutex;
+	//! Buffers are not deleted at the thread exit to keep events for export,
+	//! they are reused by new threads.
+	boost::ptr_vector<Buffer> m_buffers;
+
+	//! Has to be destroyed before buffers.
+	ACE_TSS<BufferHolder> m_threadBuffer;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+TracerPolicy::TracerPolicy()
+		: m_isEnabled(0),
+		m_pimpl(new Implementation) {
+	//...//
+}
+
+TracerPolicy::~TracerPolicy() {
+	delete m_pimpl;
+}
+
+void TracerPolicy::Enable(bool isEnabled) throw() {
+	Interlocked::Exchange(m_isEnabled, isEnabled ? 1 : 0);
+}
+
+void TracerPolicy::Append(
+			TraceEvent event,
+			Instance::Id objectId,
+			size_t size)
+		throw() {
+	m_pimpl->Append(event, objectId, size);
+}
+
+void TracerPolicy::Export(std::string &result) const {
+	m_pimpl->Export(result);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#if TEMPLATES_REQUIRE_SOURCE != 0
+#	include "Singleton.cpp"
+	namespace {
+		//! Only for template instantiation.
+		void MakeTracerTemplateInstantiation() {
+			Tracer::GetInstance();
+		}
+	}
+#endif // TEMPLATES_REQUIRE_SOURCE
+
+//////////////////////////////////////////////////////////////////////////
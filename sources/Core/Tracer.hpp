@@ -0,0 +1,112 @@
+/**************************************************************************
+ *   Created: 2026/10/19 18:22
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__Tracer_hpp__2610191822
+#define INCLUDED_FILE__TUNNELEX__Tracer_hpp__2610191822
+
+#include "Singleton.hpp"
+#include "Instance.hpp"
+#include "Api.h"
+
+namespace TunnelEx {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Hot-path events.
+	enum TraceEvent {
+		TRACE_EVENT_ACCEPT,
+		TRACE_EVENT_SETUP_START,
+		TRACE_EVENT_SETUP_END,
+		TRACE_EVENT_READ_POST,
+		TRACE_EVENT_READ_COMPLETE,
+		TRACE_EVENT_WRITE_POST,
+		TRACE_EVENT_WRITE_COMPLETE,
+		TRACE_EVENT_LISTENER_DISPATCH,
+		numberOfTraceEvents
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace Singletons {
+
+		//! Hot-path events tracer real class.
+		/** To get instance please use the Tracer-singleton. Each thread
+		  * writes fixed-size events into its own ring buffer, so tracing
+		  * never locks the data path. Disabled by default, the disabled
+		  * tracer costs only one flag checking.
+		  */
+		class TUNNELEX_CORE_API TracerPolicy {
+
+			template<typename T, template<class> class L, template<class> class Th>
+			friend class Holder;
+
+		private:
+
+			TracerPolicy();
+			TracerPolicy(const TracerPolicy &);
+			~TracerPolicy();
+			const TracerPolicy & operator =(const TracerPolicy &);
+			TracerPolicy * operator *();
+
+		public:
+
+			bool IsEnabled() const throw() {
+				return m_isEnabled != 0;
+			}
+
+			void Enable(bool isEnabled) throw();
+
+			//! Appends event to the ring buffer of the current thread.
+			/** @param	event		event type;
+			  * @param	objectId	connection or tunnel instance ID;
+			  * @param	size		data size, if has sense for event.
+			  */
+			void Append(
+					TraceEvent event,
+					Instance::Id objectId,
+					size_t size = 0)
+				throw();
+
+		public:
+
+			//! Exports buffered events in the Chrome trace (Perfetto) JSON.
+			void Export(std::string &) const;
+
+		private:
+
+			volatile long m_isEnabled;
+
+			class Implementation;
+			Implementation *m_pimpl;
+
+		};
+
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Hot-path events tracer. Is a singleton.
+	typedef Singletons::Holder<Singletons::TracerPolicy, Singletons::PhoenixLifetime> Tracer;
+
+	inline void Trace(
+				TraceEvent event,
+				Instance::Id objectId,
+				size_t size = 0)
+			throw() {
+		Singletons::TracerPolicy &tracer = Tracer::GetInstance();
+		if (tracer.IsEnabled()) {
+			tracer.Append(event, objectId, size);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__Tracer_hpp__2610191822
@@ -0,0 +1,356 @@
+/**************************************************************************
+ *   Created: 2026/10/19 15:12
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "TrafficCapture.hpp"
+#include "Connection.hpp"
+#include "MessageBlock.hpp"
+#include "Locking.hpp"
+#include "Log.hpp"
+#include "Exceptions.hpp"
+
+namespace pt = boost::posix_time;
+namespace fs = boost::filesystem;
+using namespace TunnelEx;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//! @todo: hardcoded traffic capture settings
+	const size_t bufferSize = 4 * 1024 * 1024;
+	const unsigned long long maxFileSize = 256 * 1024 * 1024;
+	const pt::time_duration maxFilePeriod = pt::hours(1);
+	const ACE_Time_Value flushInterval(0, 250 * 1000);
+
+	enum RecordType {
+		RECORD_TYPE_CONNECTION = 1,
+		RECORD_TYPE_DATA = 2,
+		RECORD_TYPE_DROPPED = 3
+	};
+
+#	pragma pack(push, 1)
+	struct RecordHeader {
+		unsigned char type;
+		unsigned int size;
+		unsigned long long time;
+		unsigned long long connection;
+	};
+#	pragma pack(pop)
+
+	const char fileSignature[8] = {'T', 'E', 'X', 'C', 'A', 'P', 0, 1};
+
+	unsigned long long GetCaptureTime() {
+		static const pt::ptime epoch(boost::gregorian::date(1970, 1, 1));
+		return (pt::microsec_clock::universal_time() - epoch).total_microseconds();
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+//! Capture directory buffer and current file.
+class TrafficCapture::Storage : private boost::noncopyable {
+
+public:
+
+	typedef SpinMutex BufferMutex;
+	typedef Lock<BufferMutex> BufferLock;
+
+public:
+
+	Storage(const fs::wpath &dir, ACE_Auto_Event &flushEvent)
+			: m_flushEvent(flushEvent),
+			m_buffer(bufferSize),
+			m_bufferDataSize(0),
+			m_flushBuffer(bufferSize),
+			m_droppedCount(0),
+			m_dir(dir),
+			m_fileIndex(0),
+			m_fileSize(0) {
+		create_directories(m_dir);
+		OpenFile();
+	}
+
+	~Storage() throw() {
+		try {
+			Flush();
+		} catch (...) {
+			assert(false);
+		}
+	}
+
+public:
+
+	//! Copies record into the buffer, never waits for the file writing.
+	void Append(
+				RecordType type,
+				Instance::Id connection,
+				const char *data,
+				size_t dataSize)
+			throw() {
+		RecordHeader header;
+		header.type = static_cast<unsigned char>(type);
+		header.size = static_cast<unsigned int>(dataSize);
+		header.time = GetCaptureTime();
+		header.connection = connection;
+		const size_t recordSize = sizeof(header) + dataSize;
+		bool isFlushRequired;
+		{
+			BufferLock lock(m_bufferMutex);
+			if (m_bufferDataSize + recordSize > m_buffer.size()) {
+				++m_droppedCount;
+				return;
+			}
+			char *const record = &m_buffer[m_bufferDataSize];
+			memcpy(record, &header, sizeof(header));
+			if (dataSize > 0) {
+				memcpy(record + sizeof(header), data, dataSize);
+			}
+			m_bufferDataSize += recordSize;
+			isFlushRequired = m_bufferDataSize >= m_buffer.size() / 2;
+		}
+		if (isFlushRequired) {
+			m_flushEvent.signal();
+		}
+	}
+
+	//! Writes buffered records into the file, only one thread at a time.
+	void Flush() {
+
+		size_t dataSize;
+		unsigned int droppedCount;
+		{
+			BufferLock lock(m_bufferMutex);
+			m_buffer.swap(m_flushBuffer);
+			dataSize = m_bufferDataSize;
+			m_bufferDataSize = 0;
+			droppedCount = m_droppedCount;
+			m_droppedCount = 0;
+		}
+
+		if (droppedCount > 0) {
+			RecordHeader header;
+			header.type = RECORD_TYPE_DROPPED;
+			header.size = sizeof(droppedCount);
+			header.time = GetCaptureTime();
+			header.connection = 0;
+			Write(reinterpret_cast<const char *>(&header), sizeof(header));
+			Write(reinterpret_cast<const char *>(&droppedCount), sizeof(droppedCount));
+		}
+		if (dataSize == 0) {
+			if (droppedCount > 0) {
+				m_file.flush();
+			}
+			return;
+		}
+
+		Write(&m_flushBuffer[0], dataSize);
+		m_file.flush();
+
+		if (	m_fileSize >= maxFileSize
+				|| pt::second_clock::universal_time() - m_fileStartTime >= maxFilePeriod) {
+			OpenFile();
+		}
+
+	}
+
+private:
+
+	void Write(const char *data, size_t size) {
+		m_file.write(data, std::streamsize(size));
+		m_fileSize += size;
+	}
+
+	void OpenFile() {
+		m_file.close();
+		m_file.clear();
+		m_fileStartTime = pt::second_clock::universal_time();
+		const tm time(pt::to_tm(pt::second_clock::local_time()));
+		WFormat name(L"%1%%2$02d%3$02d_%4$02d%5$02d%6$02d_%7%.texcap");
+		name
+			% (time.tm_year + 1900) % (time.tm_mon + 1) % time.tm_mday
+			% time.tm_hour % time.tm_min % time.tm_sec
+			% ++m_fileIndex;
+		const fs::wpath filePath = m_dir / name.str();
+		m_file.open(filePath.string().c_str(), std::ios::trunc | std::ios::binary);
+		if (!m_file) {
+			Log::GetInstance().AppendSystemError(
+				(Format("Could not open file \"%1%\" for traffic capture.")
+						% ConvertString<String>(filePath.string().c_str()).GetCStr()
+					).str());
+			m_fileSize = 0;
+			return;
+		}
+		m_file.write(fileSignature, sizeof(fileSignature));
+		m_fileSize = sizeof(fileSignature);
+	}
+
+private:
+
+	ACE_Auto_Event &m_flushEvent;
+
+	BufferMutex m_bufferMutex;
+	std::vector<char> m_buffer;
+	size_t m_bufferDataSize;
+	std::vector<char> m_flushBuffer;
+	unsigned int m_droppedCount;
+
+	const fs::wpath m_dir;
+	std::ofstream m_file;
+	unsigned int m_fileIndex;
+	unsigned long long m_fileSize;
+	pt::ptime m_fileStartTime;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//! Capture storages registry and flushing thread.
+	class StoragesImpl : private boost::noncopyable {
+
+	public:
+
+		typedef ACE_Thread_Mutex Mutex;
+		typedef ACE_Guard<Mutex> Lock;
+
+		typedef TrafficCapture::Storage Storage;
+		typedef std::map<std::wstring, boost::weak_ptr<Storage> > Storages;
+
+	public:
+
+		StoragesImpl()
+				: m_isStopped(false) {
+			if (	m_threadManager.spawn(
+						&StoragesImpl::FlushThreadMain,
+						this,
+						THR_SCOPE_PROCESS | THR_JOINABLE)
+					== -1) {
+				throw SystemException(L"Failed to start traffic capture thread");
+			}
+		}
+
+		~StoragesImpl() throw() {
+			try {
+				Interlocked::Exchange(m_isStopped, true);
+				m_flushEvent.signal();
+				m_threadManager.wait();
+			} catch (...) {
+				assert(false);
+			}
+		}
+
+	public:
+
+		boost::shared_ptr<Storage> Get(const std::wstring &dir) {
+			Lock lock(m_mutex);
+			boost::weak_ptr<Storage> &cache = m_storages[dir];
+			boost::shared_ptr<Storage> result = cache.lock();
+			if (!result) {
+				result.reset(new Storage(dir, m_flushEvent));
+				cache = result;
+			}
+			return result;
+		}
+
+	private:
+
+		static ACE_THR_FUNC_RETURN FlushThreadMain(void *param) {
+			StoragesImpl &self = *static_cast<StoragesImpl *>(param);
+			std::vector<boost::shared_ptr<Storage> > storages;
+			while (!self.m_isStopped) {
+				self.m_flushEvent.wait(&flushInterval, 0);
+				{
+					Lock lock(self.m_mutex);
+					for (	Storages::iterator i = self.m_storages.begin();
+							i != self.m_storages.end(); ) {
+						const boost::shared_ptr<Storage> storage = i->second.lock();
+						if (!storage) {
+							i = self.m_storages.erase(i);
+						} else {
+							storages.push_back(storage);
+							++i;
+						}
+					}
+				}
+				foreach (const boost::shared_ptr<Storage> &storage, storages) {
+					try {
+						storage->Flush();
+					} catch (const std::exception &ex) {
+						Log::GetInstance().AppendSystemError(
+							(Format("Failed to write traffic capture: \"%1%\".") % ex.what()).str());
+					}
+				}
+				// storage can be destroyed here, if it was released by connection
+				storages.clear();
+			}
+			return NULL;
+		}
+
+	private:
+
+		Mutex m_mutex;
+		Storages m_storages;
+
+		ACE_Auto_Event m_flushEvent;
+		ACE_Thread_Manager m_threadManager;
+		volatile long m_isStopped;
+
+	};
+
+	typedef ACE_Singleton<StoragesImpl, ACE_Thread_Mutex> Storages;
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+TrafficCapture::TrafficCapture(
+			Server::Ref,
+			const RuleEndpoint::ListenerInfo &info,
+			const TunnelRule &rule,
+			const Connection &currentConnection,
+			const Connection &)
+		: m_connectionId(currentConnection.GetInstanceId()) {
+	try {
+		m_storage = Storages::instance()->Get(info.param.GetCStr());
+	} catch (const fs::filesystem_error &ex) {
+		Log::GetInstance().AppendSystemError(
+			(Format("Could not open directory \"%2%\" for traffic capture: \"%1%\".")
+					% ex.what()
+					% ConvertString<String>(info.param).GetCStr()
+				).str());
+		return;
+	}
+	const String ruleUuid = ConvertString<String>(rule.GetUuid());
+	m_storage->Append(
+		RECORD_TYPE_CONNECTION,
+		m_connectionId,
+		ruleUuid.GetCStr(),
+		ruleUuid.GetLength());
+}
+
+TrafficCapture::~TrafficCapture() {
+	LogTracking("TrafficCapture", "~TrafficCapture", __FILE__, __LINE__);
+}
+
+DataTransferCommand TrafficCapture::OnNewMessageBlock(MessageBlock &messageBlock) {
+	if (m_storage) {
+		m_storage->Append(
+			RECORD_TYPE_DATA,
+			m_connectionId,
+			messageBlock.GetData(),
+			messageBlock.GetUnreadedDataSize());
+	}
+	return DATA_TRANSFER_CMD_SEND_PACKET;
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+/**************************************************************************
+ *   Created: 2026/10/19 15:04
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__TrafficCapture_hpp__2610191504
+#define INCLUDED_FILE__TUNNELEX__TrafficCapture_hpp__2610191504
+
+#include "Listener.hpp"
+#include "Rule.hpp"
+#include "Server.hpp"
+
+namespace TunnelEx {
+
+	class Connection;
+
+	//! Writes traffic into the binary capture files.
+	/** Unlike TrafficLogger, doesn't write data in the connection thread:
+	  * records are copied into the preallocated memory buffer, shared by
+	  * all connections with the same capture directory, and written into
+	  * the file by the background thread. If buffer is full, records are
+	  * dropped and counted. Files are rotated by size and time.
+	  *
+	  * File format (all numbers are little-endian):
+	  *  - file header: 8 bytes signature "TEXCAP\0\1";
+	  *  - records: 1 byte record type, 4 bytes record data size, 8 bytes
+	  *    time (microseconds since 1970-01-01 UTC), 8 bytes connection
+	  *    instance ID and record data.
+	  * Record types:
+	  *  - 1 - connection, data is rule UUID;
+	  *  - 2 - connection data;
+	  *  - 3 - records dropped, data is 4 bytes number of dropped records.
+	  */
+	class TrafficCapture : public PreListener {
+
+	public:
+
+		class Storage;
+
+	public:
+
+		TrafficCapture(	Server::Ref,
+						const ::TunnelEx::RuleEndpoint::ListenerInfo &,
+						const ::TunnelEx::TunnelRule &,
+						const ::TunnelEx::Connection &,
+						const ::TunnelEx::Connection &);
+		virtual ~TrafficCapture();
+
+	public:
+
+		virtual DataTransferCommand OnNewMessageBlock(MessageBlock &);
+
+	private:
+
+		boost::shared_ptr<Storage> m_storage;
+		const Instance::Id m_connectionId;
+
+	};
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__TrafficCapture_hpp__2610191504
@@ -0,0 +1,68 @@
+/**************************************************************************
+ *   Created: 2026/10/19 17:46
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "TrafficStat.hpp"
+
+using namespace TunnelEx;
+using namespace TunnelEx::Helpers;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	long GetSecondsTime() throw() {
+		return long(GetTickCount() / 1000);
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+ThroughputEstimator::ThroughputEstimator() throw() {
+	for (size_t i = 0; i < slotsNumber; ++i) {
+		m_slots[i].time = -1;
+		m_slots[i].bytes = 0;
+	}
+}
+
+void ThroughputEstimator::Add(size_t bytes) throw() {
+	const long now = GetSecondsTime();
+	Slot &slot = m_slots[now % slotsNumber];
+	const long slotTime = slot.time;
+	if (	slotTime != now
+			&& Interlocked::CompareExchange(slot.time, now, slotTime) == slotTime) {
+		// this thread starts new second in this slot
+		for ( ; ; ) {
+			const long long prevBytes = slot.bytes;
+			if (Interlocked::CompareExchange(slot.bytes, 0, prevBytes) == prevBytes) {
+				break;
+			}
+		}
+	}
+	Interlocked::ExchangeAdd(slot.bytes, bytes);
+}
+
+double ThroughputEstimator::Get() const throw() {
+	const long now = GetSecondsTime();
+	long long result = 0;
+	foreach (const Slot &slot, m_slots) {
+		const long time = slot.time;
+		if (time < now && now - time <= windowSize) {
+			result += Interlocked::CompareExchange(
+				const_cast<volatile long long &>(slot.bytes),
+				0,
+				0);
+		}
+	}
+	return double(result) / windowSize;
+}
+
+//////////////////////////////////////////////////////////////////////////
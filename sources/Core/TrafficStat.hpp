@@ -0,0 +1,169 @@
+/**************************************************************************
+ *   Created: 2026/10/19 17:31
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__TrafficStat_hpp__2610191731
+#define INCLUDED_FILE__TUNNELEX__TrafficStat_hpp__2610191731
+
+#include "Instance.hpp"
+#include "Locking.hpp"
+#include "Api.h"
+
+namespace TunnelEx {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Traffic counters snapshot.
+	/** For connection "incoming" is data received from the remote and
+	  * "outcoming" - data sent to the remote. For tunnel "incoming" is data
+	  * from source to destination and "outcoming" - from destination
+	  * to source.
+	  */
+	struct TrafficStat {
+
+		TrafficStat() throw()
+				: incomingBytes(0),
+				incomingPackets(0),
+				outcomingBytes(0),
+				outcomingPackets(0) {
+			//...//
+		}
+
+		long long incomingBytes;
+		long long incomingPackets;
+		long long outcomingBytes;
+		long long outcomingPackets;
+
+	};
+
+	//! Tunnel traffic snapshot.
+	struct TunnelStat {
+
+		TunnelStat() throw()
+				: tunnelId(0),
+				throughput(0) {
+			//...//
+		}
+
+		Instance::Id tunnelId;
+		std::wstring ruleUuid;
+		TrafficStat traffic;
+		//! Bytes per second, both directions.
+		double throughput;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace Helpers {
+
+		//! Traffic counters, changed only by interlocked operations.
+		class TrafficCounters {
+
+		public:
+
+			TrafficCounters() throw()
+					: m_incomingBytes(0),
+					m_incomingPackets(0),
+					m_outcomingBytes(0),
+					m_outcomingPackets(0) {
+				//...//
+			}
+
+		private:
+
+			TrafficCounters(const TrafficCounters &);
+			const TrafficCounters & operator =(const TrafficCounters &);
+
+		public:
+
+			void AddIncoming(size_t size) throw() {
+				::TunnelEx::Interlocked::ExchangeAdd(m_incomingBytes, size);
+				::TunnelEx::Interlocked::ExchangeAdd(m_incomingPackets, 1);
+			}
+
+			void AddOutcoming(size_t size) throw() {
+				::TunnelEx::Interlocked::ExchangeAdd(m_outcomingBytes, size);
+				::TunnelEx::Interlocked::ExchangeAdd(m_outcomingPackets, 1);
+			}
+
+			TrafficStat GetStat() const throw() {
+				TrafficStat result;
+				result.incomingBytes = Read(m_incomingBytes);
+				result.incomingPackets = Read(m_incomingPackets);
+				result.outcomingBytes = Read(m_outcomingBytes);
+				result.outcomingPackets = Read(m_outcomingPackets);
+				return result;
+			}
+
+		private:
+
+			static long long Read(const volatile long long &value) throw() {
+				return ::TunnelEx::Interlocked::CompareExchange(
+					const_cast<volatile long long &>(value),
+					0,
+					0);
+			}
+
+		private:
+
+			volatile long long m_incomingBytes;
+			volatile long long m_incomingPackets;
+			volatile long long m_outcomingBytes;
+			volatile long long m_outcomingPackets;
+
+		};
+
+		//! Sliding window throughput estimator.
+		/** Bytes are accumulated in one-second slots by interlocked
+		  * operations, throughput is the average of the last completed
+		  * seconds. Slot reusing isn't atomic, so some bytes can be lost
+		  * at the second start, it's ok for estimation.
+		  */
+		class TUNNELEX_CORE_API ThroughputEstimator {
+
+		public:
+
+			ThroughputEstimator() throw();
+
+		private:
+
+			ThroughputEstimator(const ThroughputEstimator &);
+			const ThroughputEstimator & operator =(const ThroughputEstimator &);
+
+		public:
+
+			void Add(size_t bytes) throw();
+
+			//! Returns bytes per second.
+			double Get() const throw();
+
+		private:
+
+			//! @todo: hardcoded throughput estimation window (seconds)
+			enum {
+				windowSize = 10,
+				slotsNumber = windowSize + 1
+			};
+
+			struct Slot {
+				volatile long time;
+				volatile long long bytes;
+			};
+
+			Slot m_slots[slotsNumber];
+
+		};
+
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif // INCLUDED_FILE__TUNNELEX__TrafficStat_hpp__2610191731
@@ -22,6 +22,7 @@
 #include "String.hpp"
 #include "Licensing.hpp"
 #include "Locking.hpp"
+#include "MessageBlock.hpp"
 
 using namespace TunnelEx;
 
@@ -200,11 +201,13 @@ Tunnel::Tunnel(
 			const bool isStatic,
 			ServerWorker &server,
 			SharedPtr<const TunnelRule> rule,
+			SharedPtr<Singletons::MetricsPolicy::RuleCounters> metrics,
 			SharedPtr<Connection> sourceRead,
 			SharedPtr<Connection> sourceWrite)
 		: m_isStatic(isStatic),
 		m_server(server),
 		m_rule(rule),
+		m_metrics(metrics),
 		m_connectionsToClose(0),
 		m_setupComplitedConnections(0),
 		m_source(sourceRead, sourceWrite),
@@ -214,6 +217,7 @@ Tunnel::Tunnel(
 		m_isDead(false) {
 	m_destination = CreateDestinationConnections(m_destinationIndex);
 	Init();
+	m_metrics->OnTunnelOpen();
 }
 
 void Tunnel::Init() {
@@ -275,7 +279,12 @@ void Tunnel::Init() {
 			GetIncomingWriteConnection(),
 			listenerBinder);
 		sourceDataTransferSignal->ConnectToOnNewMessageBlockSignal(
-			boost::bind(&Connection::SendToRemote, &GetOutcomingWriteConnection(), _1));
+			boost::bind(
+				&Tunnel::SendToRemote,
+				this,
+				&GetOutcomingWriteConnection(),
+				Singletons::MetricsPolicy::DIRECTION_TO_DESTINATION,
+				_1));
 
 		listenerBinderServer.SetSignal(*destinationDataTransferSignal);
 		factory.CreatePostListeners(
@@ -291,7 +300,12 @@ void Tunnel::Init() {
 			GetOutcomingWriteConnection(),
 			listenerBinder);
 		destinationDataTransferSignal->ConnectToOnNewMessageBlockSignal(
-			boost::bind(&Connection::SendToRemote, &GetIncomingWriteConnection(), _1));
+			boost::bind(
+				&Tunnel::SendToRemote,
+				this,
+				&GetIncomingWriteConnection(),
+				Singletons::MetricsPolicy::DIRECTION_TO_SOURCE,
+				_1));
 
 		if (&GetIncomingReadConnection() == &GetIncomingWriteConnection()) {
 			GetIncomingReadConnection().Open(
@@ -398,6 +412,7 @@ Tunnel::~Tunnel() throw() {
 		}
 		assert(m_closedConnections == m_connectionsToClose);
 	}
+	m_metrics->OnTunnelClose();
 	ReportClosed();
 }
 
@@ -833,3 +848,27 @@ bool Tunnel::IsDestinationSetupFailed() const {
 	return GetOutcomingReadConnection().IsSetupFailed()
 		|| GetOutcomingWriteConnection().IsSetupFailed();
 }
+
+DataTransferCommand Tunnel::SendToRemote(
+			Connection *connection,
+			Singletons::MetricsPolicy::Direction direction,
+			MessageBlock &messageBlock) {
+	const size_t size = messageBlock.GetUnreadedDataSize();
+	m_metrics->AddTraffic(direction, size);
+	if (direction == Singletons::MetricsPolicy::DIRECTION_TO_DESTINATION) {
+		m_traffic.AddIncoming(size);
+	} else {
+		m_traffic.AddOutcoming(size);
+	}
+	m_throughput.Add(size);
+	return connection->SendToRemote(messageBlock);
+}
+
+TunnelStat Tunnel::GetStat() const {
+	TunnelStat result;
+	result.tunnelId = GetInstanceId();
+	result.ruleUuid = m_rule->GetUuid().GetCStr();
+	result.traffic = m_traffic.GetStat();
+	result.throughput = m_throughput.Get();
+	return result;
+}
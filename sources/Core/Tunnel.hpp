@@ -12,6 +12,9 @@
 
 #include "Instance.hpp"
 #include "SmartPtr.hpp"
+#include "Metrics.hpp"
+#include "TrafficStat.hpp"
+#include "DataTransferCommand.hpp"
 
 class ACE_Proactor;
 
@@ -22,6 +25,7 @@ namespace TunnelEx {
 	class Connection;
 	class ServerWorker;
 	class TunnelConnectionSignal;
+	class MessageBlock;
 
 	//! Connection process handler.
 	/** Opens and manages the current tunnel instance. */
@@ -60,6 +64,7 @@ namespace TunnelEx {
 				const bool isStatic,
 				ServerWorker &server,
 				SharedPtr<const TunnelRule> rule,
+				SharedPtr<Singletons::MetricsPolicy::RuleCounters> metrics,
 				SharedPtr<Connection> sourceRead,
 				SharedPtr<Connection> sourceWrite);
 
@@ -89,6 +94,13 @@ namespace TunnelEx {
 			return *m_rule;
 		}
 
+		Singletons::MetricsPolicy::RuleCounters & GetMetrics() {
+			return *m_metrics;
+		}
+		const SharedPtr<Singletons::MetricsPolicy::RuleCounters> & GetSharedMetrics() {
+			return m_metrics;
+		}
+
 		const ACE_Proactor & GetProactor() const {
 			return const_cast<Tunnel *>(this)->GetProactor();
 		}
@@ -125,6 +137,8 @@ namespace TunnelEx {
 			return m_isDead;
 		}
 
+		TunnelStat GetStat() const;
+
 	private:
 
 		void Init();
@@ -151,6 +165,11 @@ namespace TunnelEx {
 
 		void OnConnectionSetup(Instance::Id);
 		
+		DataTransferCommand SendToRemote(
+				Connection *,
+				Singletons::MetricsPolicy::Direction,
+				MessageBlock &);
+
 		void OnConnectionClose(Instance::Id);
 		void OnConnectionClosed(Instance::Id);
 
@@ -164,6 +183,9 @@ namespace TunnelEx {
 
 		ServerWorker &m_server;
 		const SharedPtr<const TunnelRule> m_rule;
+		const SharedPtr<Singletons::MetricsPolicy::RuleCounters> m_metrics;
+		Helpers::TrafficCounters m_traffic;
+		Helpers::ThroughputEstimator m_throughput;
 
 		SharedPtr<TunnelConnectionSignal> m_sourceDataTransferSignal;
 		SharedPtr<TunnelConnectionSignal> m_destinationDataTransferSignal;
@@ -20,52 +20,55 @@ namespace TunnelEx {
 	class Tunnel;
 	class MessageBlock;
 
-	class TunnelConnectionSignal : public ConnectionSignal {
-
+	//! Calls new message block slots until the first "not send" command.
+	/** Template parameter is the tunnel class, which is replaced by test
+	  * double in benchmarks.
+	  */
+	template<typename TunnelT>
+	class MessageBlockHandlingCombiner {
+	public:
+		typedef DataTransferCommand result_type;
+	public:
+		explicit MessageBlockHandlingCombiner(TunnelT &tunnel)
+				: m_tunnel(tunnel) {
+			//...//
+		}
+		MessageBlockHandlingCombiner(const MessageBlockHandlingCombiner &rhs)
+				: m_tunnel(rhs.m_tunnel) {
+			//...//
+		}
 	private:
-
-		class MessageBlockHandlingCombiner {
-		public:
-			typedef DataTransferCommand result_type;
-		public:
-			explicit MessageBlockHandlingCombiner(Tunnel &tunnel)
-					: m_tunnel(tunnel) {
-				//...//
-			}
-			MessageBlockHandlingCombiner(const MessageBlockHandlingCombiner &rhs)
-					: m_tunnel(rhs.m_tunnel) {
-				//...//
+		const MessageBlockHandlingCombiner & operator =(
+				const MessageBlockHandlingCombiner &rhs);
+	public:
+		template<typename InputIterator>
+		DataTransferCommand operator ()(InputIterator first, InputIterator last) {
+			DataTransferCommand lastSlotResult = DATA_TRANSFER_CMD_SEND_PACKET;
+			for (	;
+					first != last && lastSlotResult == DATA_TRANSFER_CMD_SEND_PACKET;
+					lastSlotResult = *first++);
+			if (lastSlotResult == DATA_TRANSFER_CMD_CLOSE_TUNNEL) {
+				m_tunnel.GetServer().CloseTunnel(m_tunnel.GetInstanceId());
 			}
-		private:
-			const MessageBlockHandlingCombiner & operator =(
-					const MessageBlockHandlingCombiner &rhs);
-		public:
-			template<typename InputIterator>
-			DataTransferCommand operator ()(InputIterator first, InputIterator last) {
-				DataTransferCommand lastSlotResult = DATA_TRANSFER_CMD_SEND_PACKET;
-				for (	;
-						first != last && lastSlotResult == DATA_TRANSFER_CMD_SEND_PACKET;
-						lastSlotResult = *first++);
-				if (lastSlotResult == DATA_TRANSFER_CMD_CLOSE_TUNNEL) {
-					m_tunnel.GetServer().CloseTunnel(m_tunnel.GetInstanceId());
+#			ifdef _DEBUG
+				// just a checking
+				switch (lastSlotResult) {
+					case DATA_TRANSFER_CMD_SEND_PACKET:
+					case DATA_TRANSFER_CMD_SKIP_PACKET:
+					case DATA_TRANSFER_CMD_CLOSE_TUNNEL:
+						break;
+					default:
+						assert(false);
+						break;
 				}
-#				ifdef _DEBUG
-					// just a checking
-					switch (lastSlotResult) {
-						case DATA_TRANSFER_CMD_SEND_PACKET:
-						case DATA_TRANSFER_CMD_SKIP_PACKET:
-						case DATA_TRANSFER_CMD_CLOSE_TUNNEL:
-							break;
-						default:
-							assert(false);
-							break;
-					}
-#				endif // _DEBUG
-				return lastSlotResult;
-			}
-		private:
-			Tunnel &m_tunnel;
-		};
+#			endif // _DEBUG
+			return lastSlotResult;
+		}
+	private:
+		TunnelT &m_tunnel;
+	};
+
+	class TunnelConnectionSignal : public ConnectionSignal {
 
 	public:
 
@@ -86,15 +89,16 @@ namespace TunnelEx {
 		typedef void(OnMessageBlockSentSlotSignature)(MessageBlock &);
 		typedef boost::function<OnMessageBlockSentSlotSignature> OnMessageBlockSentSlot;
 
+		typedef boost::signals2::signal<
+				OnNewMessageBlockSlotSignature,
+				MessageBlockHandlingCombiner<Tunnel> >
+			OnNewMessageBlockSignal;
+
 	private:
 
 		typedef boost::signals2::signal<
 				OnConnectionSetupCompletedSlotSignature>
 			OnConnectionSetupCompletedSignal;
-		typedef boost::signals2::signal<
-				OnNewMessageBlockSlotSignature,
-				MessageBlockHandlingCombiner>
-			OnNewMessageBlockSignal;
 		typedef boost::signals2::signal<OnConnectionCloseSlotSignature>
 			OnConnectionCloseSignal;
 		typedef boost::signals2::signal<OnConnectionClosedSlotSignature>
@@ -106,7 +110,7 @@ namespace TunnelEx {
 
 		explicit TunnelConnectionSignal(Tunnel &tunnel)
 				:  m_tunnel(tunnel),
-				m_onNewMessageBlockSignal(MessageBlockHandlingCombiner(m_tunnel)) {
+				m_onNewMessageBlockSignal(MessageBlockHandlingCombiner<Tunnel>(m_tunnel)) {
 			//...//
 		}
 
@@ -77,6 +77,7 @@ LogDlg::LogDlg(wxWindow *parent, wxWindowID id)
 			boost::polymorphic_downcast<ServiceWindow *>(GetParent())
 				->GetService()
 				.GetLogSize()),
+		m_lastRecordSequenceNumber(0),
 		m_logLevel(::LOG_LEVEL_INFO) {
 
 	SetMinSize(wxSize(500, 300));
@@ -175,12 +176,13 @@ void LogDlg::RefreshData() {
 		= *boost::polymorphic_downcast<wxListCtrl *>(FindWindow(CONTROL_LIST));
 
 	listCtrl.DeleteAllItems();
+	m_lastRecordSequenceNumber = 0;
 
 	std::list<texs__LogRecord> log;
 	texs__LogLevel logLevel = m_logLevel;
 	boost::polymorphic_downcast<ServiceWindow *>(GetParent())
 		->GetService()
-		.GetLogRecords(100, log);
+		.GetLogRecords(100, 0, log);
 	//! @todo: reimplement, by service configure update event [2010/04/03 23:06]
 	logLevel = boost::polymorphic_downcast<ServiceWindow *>(GetParent())
 		->GetService()
@@ -200,7 +202,12 @@ void LogDlg::AddData(unsigned int recordsCount) {
 	std::list<texs__LogRecord> log;
 	boost::polymorphic_downcast<ServiceWindow *>(GetParent())
 		->GetService()
-		.GetLogRecords(recordsCount, log);
+		.GetLogRecords(recordsCount, m_lastRecordSequenceNumber, log);
+	if (!log.empty() && log.front().sequenceNumber <= m_lastRecordSequenceNumber) {
+		// service was restarted and numbers records from the beginning
+		RefreshData();
+		return;
+	}
 	const std::list<texs__LogRecord>::const_iterator logEnd = log.end();
 	for (std::list<texs__LogRecord>::const_iterator i = log.begin(); i != logEnd; ++i) {
 		AppendRecord(*i);
@@ -210,6 +217,11 @@ void LogDlg::AddData(unsigned int recordsCount) {
 
 void LogDlg::AppendRecord(const texs__LogRecord &record) {
 
+	// records from the log file of the previous runs have no numbers
+	if (record.sequenceNumber) {
+		m_lastRecordSequenceNumber = record.sequenceNumber;
+	}
+
 	switch (record.level) {
 		case 0: // LOG_LEVEL_TRACK in release
 		case TunnelEx::LOG_LEVEL_TRACK:
@@ -118,6 +118,7 @@ private:
 	const unsigned char m_borderWidth;
 	
 	unsigned long long m_logSize;
+	unsigned long m_lastRecordSequenceNumber;
 
 	texs__LogLevel m_logLevel;
 
@@ -439,12 +439,15 @@ public:
 
 	void GetLogRecords(
 				unsigned int recordsNumber,
+				unsigned long sinceSequenceNumber,
 				std::list<texs__LogRecord> &records)
 			const {
 		for (int attempts = 0; ; ) {
 			wxMutexLocker serviceLock(m_serviceMutex);
-			const int resultCode
-				= m_service.texs__GetLogRecords(recordsNumber, records);
+			const int resultCode = m_service.texs__GetLogRecords(
+				recordsNumber,
+				sinceSequenceNumber,
+				records);
 			++attempts;
 			if (resultCode != SOAP_EOF || attempts >= 2) {
 				if (resultCode != SOAP_OK) {
@@ -1089,10 +1092,16 @@ const wxString & ServiceAdapter::GetEndpoint() const {
 
 void ServiceAdapter::GetLogRecords(
 			unsigned int recordsNumber,
+			unsigned long sinceSequenceNumber,
 			std::list<texs__LogRecord> &records)
 		const {
 	m_pimpl->RequestWithProgressBar<void>(
-		boost::bind(&Implementation::GetLogRecords, m_pimpl.get(), recordsNumber, boost::ref(records)),
+		boost::bind(
+			&Implementation::GetLogRecords,
+			m_pimpl.get(),
+			recordsNumber,
+			sinceSequenceNumber,
+			boost::ref(records)),
 		wxT("Requesting service log, please wait..."));
 }
 
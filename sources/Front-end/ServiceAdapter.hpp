@@ -90,6 +90,7 @@ public:
 	void DeleteRules(const RulesUuids &);
 	void GetLogRecords(
 			unsigned int recordsNumber,
+			unsigned long sinceSequenceNumber,
 			std::list<texs__LogRecord> &records)
 		const;
 	texs__LogLevel GetLogLevel() const;
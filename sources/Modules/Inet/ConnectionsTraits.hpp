@@ -17,7 +17,8 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 	template<bool isSecured>
 	class IncomingTcpConnection;
 
-	class IncomingTcpSslClientConnection;
+	template<bool isServer>
+	class IncomingSslTcpConnection;
 
 	class OutcomingTcpConnection;
 	
@@ -126,12 +127,21 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			}
 		};
 
+		template<>
+		struct TcpIn<true, true> {
+			// always unsecured acceptor - SSL/TLS handshake will be made
+			// by connection, without acceptor thread blocking
+			typedef AcceptionTraits::Tcp<false> AcceptionTrait;
+			typedef AcceptionTrait::Acceptor Acceptor;
+			typedef IncomingSslTcpConnection<true> Connection;
+		};
+
 		template<>
 		struct TcpIn<true, false> {
 			// always unsecured acceptor - tcp here is only transport
 			typedef AcceptionTraits::Tcp<false> AcceptionTrait;
 			typedef AcceptionTrait::Acceptor Acceptor;
-			typedef IncomingTcpSslClientConnection Connection;
+			typedef IncomingSslTcpConnection<false> Connection;
 		};
 
 		template<bool isSecured, bool isServer>
@@ -96,7 +96,7 @@ public:
 				if (Log::GetInstance().IsDebugRegistrationOn()) {
 					Log::GetInstance().AppendDebug(
 						"Ping time for address from the endpoint \"%1%\" is %2% msec.",
-						ConvertString<String>(m_endpoint.GetUuid()).GetCStr(),
+						m_endpoint.GetUuid(),
 						m_pingTime);
 				}
 			} else {
@@ -105,7 +105,7 @@ public:
 					if (Log::GetInstance().IsDebugRegistrationOn()) {
 						Log::GetInstance().AppendDebug(
 							"Timeout of exceeded for ping address from the endpoint \"%1%\".",
-							ConvertString<String>(m_endpoint.GetUuid()).GetCStr());
+							m_endpoint.GetUuid());
 					}
 				} else {
 					const Error error(errno);
@@ -341,7 +341,7 @@ DestinationPingFilter::DestinationPingFilter(
 	if (!m_isActive) {
 		Log::GetInstance().AppendDebug(
 			"Destinations pinging not started, rule %1%, filter %2%.",
-			ConvertString<String>(GetRule().GetUuid()).GetCStr(),
+			GetRule().GetUuid(),
 			GetInstanceId());
 		return;
 	}
@@ -355,7 +355,7 @@ DestinationPingFilter::DestinationPingFilter(
 	if (Log::GetInstance().IsDebugRegistrationOn()) {
 		Log::GetInstance().AppendDebug(
 			"Destinations pinging started, rule %1%, filter %2%.",
-			ConvertString<String>(GetRule().GetUuid()).GetCStr(),
+			GetRule().GetUuid(),
 			GetInstanceId());
 	}
 }
@@ -415,7 +415,7 @@ void DestinationPingFilter::ChangeRule(TunnelRule &rule) {
 				if (log.IsDebugRegistrationOn()) {
 					log.AppendDebug(
 						"Endpoint %1% has been removed from the destination pinging list.",
-						ConvertString<String>(uuid).GetCStr());
+						uuid);
 				}
 			} else {
 				++i;
@@ -0,0 +1,422 @@
+/**************************************************************************
+ *   Created: 2026/10/19 12:38
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "HostResolver.hpp"
+
+#include "Core/Log.hpp"
+#include "Core/Exceptions.hpp"
+
+using namespace TunnelEx;
+using namespace TunnelEx::Mods::Inet;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//! @todo: hardcoded DNS cache settings
+	const time_t minPositiveTtl = 1;
+	const time_t maxPositiveTtl = 60 * 60;
+	const time_t fallbackPositiveTtl = 60;
+	const time_t negativeTtl = 5;
+	const time_t maxStaleTime = 5 * 60;
+
+	typedef std::vector<ACE_INET_Addr> Addresses;
+	typedef std::vector<unsigned char> NameServers;
+
+	bool ParseAddress(const std::wstring &host, ACE_INET_Addr &result) {
+		const String hostA = ConvertString<String>(host.c_str());
+		in_addr ipv4;
+		if (ACE_OS::inet_pton(AF_INET, hostA.GetCStr(), &ipv4) == 1) {
+			return result.set(0, ipv4.s_addr, 0) == 0;
+		}
+		return false;
+	}
+
+	//! Makes DNS query for A records, adds found addresses to the result.
+	/** All module sockets are AF_INET, so AAAA records are not requested.
+	  */
+	void QueryDns(
+				const std::wstring &host,
+				const NameServers &nameServers,
+				Addresses &result,
+				time_t &ttl) {
+
+		PDNS_RECORD records = nullptr;
+		const DNS_STATUS status = DnsQuery_W(
+			host.c_str(),
+			DNS_TYPE_A,
+			DNS_QUERY_STANDARD,
+			nameServers.empty()
+				?	nullptr
+				:	const_cast<unsigned char *>(&nameServers[0]),
+			&records,
+			nullptr);
+		if (status != 0) {
+			return;
+		}
+
+		for (PDNS_RECORD i = records; i; i = i->pNext) {
+			if (	i->wType != DNS_TYPE_A
+					|| i->Flags.S.Section != DnsSectionAnswer) {
+				continue;
+			}
+			ACE_INET_Addr address;
+			// IP4_ADDRESS is in network byte order
+			address.set(0, ACE_UINT32(i->Data.A.IpAddress), 0);
+			result.push_back(address);
+			ttl = std::min(ttl, time_t(i->dwTtl));
+		}
+
+		DnsRecordListFree(records, DnsFreeRecordList);
+
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+class HostResolverImpl::Implementation : private boost::noncopyable {
+
+public:
+
+	typedef ACE_Thread_Mutex Mutex;
+	typedef ACE_Guard<Mutex> Lock;
+	typedef ACE_Condition_Thread_Mutex Condition;
+
+	struct Record {
+		Addresses addresses;
+		time_t expirationTime;
+		//! Time of the next refresh attempt for the expired record.
+		time_t refreshTime;
+		bool isResolving;
+		size_t nextAddress;
+	};
+	typedef boost::unordered_map<std::wstring, Record> Records;
+
+public:
+
+	Implementation()
+			: m_resolvedCondition(m_mutex),
+			m_refreshCondition(m_mutex),
+			m_isStopped(false),
+			m_hits(0),
+			m_negativeHits(0),
+			m_staleHits(0),
+			m_misses(0),
+			m_refreshes(0) {
+		//...//
+	}
+
+public:
+
+	bool Resolve(const std::wstring &host, ACE_INET_Addr &result) {
+
+		Lock lock(m_mutex);
+
+		for ( ; ; ) {
+			const Records::iterator pos = m_records.find(host);
+			if (pos == m_records.end()) {
+				Record &record = m_records[host];
+				record.expirationTime = 0;
+				record.refreshTime = 0;
+				record.isResolving = true;
+				record.nextAddress = 0;
+				break;
+			}
+			Record &record = pos->second;
+			const time_t now = time(nullptr);
+			if (record.expirationTime > now) {
+				++(record.addresses.empty() ? m_negativeHits : m_hits);
+				return GetNext(record, result);
+			} else if (
+					!record.addresses.empty()
+					&& record.expirationTime + maxStaleTime > now) {
+				if (!record.isResolving && record.refreshTime <= now) {
+					record.isResolving = true;
+					m_refreshQueue.push_back(host);
+					m_refreshCondition.signal();
+				}
+				++m_staleHits;
+				return GetNext(record, result);
+			} else if (record.isResolving) {
+				// other thread resolves this name now
+				m_resolvedCondition.wait();
+				continue;
+			}
+			record.isResolving = true;
+			break;
+		}
+
+		++m_misses;
+		Query(host, lock);
+
+		const Records::iterator pos = m_records.find(host);
+		assert(pos != m_records.end());
+		return GetNext(pos->second, result);
+
+	}
+
+	void Refresh() {
+		Lock lock(m_mutex);
+		for ( ; ; ) {
+			while (!m_isStopped && m_refreshQueue.empty()) {
+				m_refreshCondition.wait();
+			}
+			if (m_isStopped) {
+				break;
+			}
+			const std::wstring host = m_refreshQueue.front();
+			m_refreshQueue.pop_front();
+			// Query stores failed record and wakes up waiters itself, so the
+			// name will be refreshed again later, the thread has to continue
+			// with other names.
+			try {
+				Query(host, lock);
+			} catch (const TunnelEx::LocalException &ex) {
+				Log::GetInstance().AppendError(
+					ConvertString<String>(ex.GetWhat()).GetCStr());
+			} catch (const std::exception &ex) {
+				Format message("Failed to refresh host name \"%1%\": \"%2%\".");
+				message % ConvertString<String>(host.c_str()).GetCStr() % ex.what();
+				Log::GetInstance().AppendError(message.str());
+			} catch (...) {
+				Format message(
+					"Unknown system error occurred at host name \"%1%\" refreshing.");
+				message % ConvertString<String>(host.c_str()).GetCStr();
+				Log::GetInstance().AppendSystemError(message.str());
+			}
+			++m_refreshes;
+		}
+	}
+
+	void Stop() {
+		Lock lock(m_mutex);
+		m_isStopped = true;
+		m_refreshCondition.broadcast();
+	}
+
+	void SetNameServers(const std::vector<std::string> &servers) {
+		NameServers nameServers;
+		if (!servers.empty()) {
+			nameServers.resize(
+				sizeof(IP4_ARRAY) + (servers.size() - 1) * sizeof(IP4_ADDRESS));
+			IP4_ARRAY &array = *reinterpret_cast<IP4_ARRAY *>(&nameServers[0]);
+			array.AddrCount = DWORD(servers.size());
+			for (size_t i = 0; i < servers.size(); ++i) {
+				in_addr address;
+				if (ACE_OS::inet_pton(AF_INET, servers[i].c_str(), &address) != 1) {
+					throw LogicalException(L"Invalid DNS server address");
+				}
+				array.AddrArray[i] = address.s_addr;
+			}
+		}
+		Lock lock(m_mutex);
+		m_nameServers.swap(nameServers);
+		for (Records::iterator i = m_records.begin(); i != m_records.end(); ) {
+			if (!i->second.isResolving) {
+				i = m_records.erase(i);
+			} else {
+				++i;
+			}
+		}
+	}
+
+	Stat GetStat() const {
+		Stat result;
+		Lock lock(m_mutex);
+		result.hits = m_hits;
+		result.negativeHits = m_negativeHits;
+		result.staleHits = m_staleHits;
+		result.misses = m_misses;
+		result.refreshes = m_refreshes;
+		result.size = long(m_records.size());
+		return result;
+	}
+
+private:
+
+	static bool GetNext(Record &record, ACE_INET_Addr &result) {
+		if (record.addresses.empty()) {
+			return false;
+		}
+		result = record.addresses[record.nextAddress++ % record.addresses.size()];
+		return true;
+	}
+
+	//! Resolves name and stores result, unlocks cache while DNS query.
+	void Query(const std::wstring &host, Lock &lock) {
+
+		const NameServers nameServers(m_nameServers);
+		Addresses addresses;
+		time_t ttl = maxPositiveTtl;
+
+		lock.release();
+		try {
+			QueryDns(host, nameServers, addresses, ttl);
+			if (addresses.empty() && nameServers.empty()) {
+				// DNS is not available or doesn't know the name, but it
+				// can be resolved by other way (hosts file, NetBIOS)
+				ACE_INET_Addr address;
+				if (address.set(0, host.c_str(), 1, AF_INET) == 0) {
+					addresses.push_back(address);
+				}
+				ttl = fallbackPositiveTtl;
+			}
+		} catch (...) {
+			lock.acquire();
+			StoreFailed(host);
+			throw;
+		}
+		lock.acquire();
+
+		if (addresses.empty()) {
+			Log::GetInstance().AppendDebug(
+				"Failed to resolve host name \"%1%\".",
+				host);
+			StoreFailed(host);
+			return;
+		}
+
+		ttl = std::max(ttl, minPositiveTtl);
+		if (Log::GetInstance().IsDebugRegistrationOn()) {
+			Log::GetInstance().AppendDebug(
+				"Host name \"%1%\" resolved to %2% address(es) for %3% seconds.",
+				host,
+				addresses.size(),
+				ttl);
+		}
+
+		Store(host, addresses, ttl);
+
+	}
+
+	void Store(const std::wstring &host, const Addresses &addresses, time_t ttl) {
+		Record &record = m_records[host];
+		record.addresses = addresses;
+		record.expirationTime = time(nullptr) + ttl;
+		record.refreshTime = 0;
+		record.isResolving = false;
+		record.nextAddress = 0;
+		m_resolvedCondition.broadcast();
+	}
+
+	//! Stores failed resolving result.
+	/** If the record has addresses which still can be used (stale time
+	  * limit is not reached), they are kept, and the refresh will be
+	  * retried after the negative caching time.
+	  */
+	void StoreFailed(const std::wstring &host) {
+		const Records::iterator pos = m_records.find(host);
+		const time_t now = time(nullptr);
+		if (	pos == m_records.end()
+				|| pos->second.addresses.empty()
+				|| pos->second.expirationTime + maxStaleTime <= now) {
+			Store(host, Addresses(), negativeTtl);
+			return;
+		}
+		Record &record = pos->second;
+		record.refreshTime = now + negativeTtl;
+		record.isResolving = false;
+		m_resolvedCondition.broadcast();
+	}
+
+private:
+
+	mutable Mutex m_mutex;
+	Condition m_resolvedCondition;
+	Condition m_refreshCondition;
+
+	Records m_records;
+	std::deque<std::wstring> m_refreshQueue;
+	NameServers m_nameServers;
+	bool m_isStopped;
+
+	long m_hits;
+	long m_negativeHits;
+	long m_staleHits;
+	long m_misses;
+	long m_refreshes;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+HostResolverImpl::HostResolverImpl()
+		: m_pimpl(new Implementation) {
+	if (	m_threadManager.spawn(
+				&HostResolverImpl::RefreshThreadMain,
+				this,
+				THR_SCOPE_PROCESS | THR_JOINABLE)
+			== -1) {
+		delete m_pimpl;
+		throw SystemException(L"Failed to start host names resolving thread");
+	}
+}
+
+HostResolverImpl::~HostResolverImpl() throw() {
+	try {
+		m_pimpl->Stop();
+		m_threadManager.wait();
+	} catch (...) {
+		Format message(
+			"Unknown system error occurred: %1%:%2%."
+				" Please restart the service"
+				" and contact product support to resolve this issue."
+				" %3% %4%");
+		message
+			% __FILE__ % __LINE__
+			% TUNNELEX_NAME % TUNNELEX_BUILD_IDENTITY;
+		Log::GetInstance().AppendFatalError(message.str());
+		assert(false);
+	}
+	delete m_pimpl;
+}
+
+ACE_THR_FUNC_RETURN HostResolverImpl::RefreshThreadMain(void *param) {
+	try {
+		static_cast<HostResolverImpl *>(param)->m_pimpl->Refresh();
+	} catch (const TunnelEx::LocalException &ex) {
+		Log::GetInstance().AppendFatalError(
+			ConvertString<String>(ex.GetWhat()).GetCStr());
+	} catch (const std::exception &ex) {
+		Log::GetInstance().AppendFatalError(ex.what());
+		throw;
+	} catch (...) {
+		Log::GetInstance().AppendSystemError(
+			"Unknown system error occurred in the host names resolving thread.");
+		throw;
+	}
+	return NULL;
+}
+
+bool HostResolverImpl::Resolve(
+			const std::wstring &host,
+			NetworkPort port,
+			ACE_INET_Addr &result) {
+	ACE_INET_Addr address;
+	if (	!ParseAddress(host, address)
+			&& !m_pimpl->Resolve(boost::to_lower_copy(host), address)) {
+		return false;
+	}
+	address.set_port_number(port);
+	result = address;
+	return true;
+}
+
+void HostResolverImpl::SetNameServers(const std::vector<std::string> &servers) {
+	m_pimpl->SetNameServers(servers);
+}
+
+HostResolverImpl::Stat HostResolverImpl::GetStat() const throw() {
+	return m_pimpl->GetStat();
+}
+
+//////////////////////////////////////////////////////////////////////////
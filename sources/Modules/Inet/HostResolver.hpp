@@ -0,0 +1,85 @@
+/**************************************************************************
+ *   Created: 2026/10/19 12:31
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__HostResolver_hpp__2610191231
+#define INCLUDED_FILE__TUNNELEX__HostResolver_hpp__2610191231
+
+#include "InetEndpointAddress.hpp"
+
+namespace TunnelEx { namespace Mods { namespace Inet {
+
+	//! Process-wide host names resolver with DNS records cache.
+	/** Resolved addresses are cached for DNS records TTL, failed names -
+	  * for the short time (negative caching). Expired records are used
+	  * some time more while they are refreshed by the resolver thread (also
+	  * if the refresh fails - it will be retried), so tunnel opening waits
+	  * for DNS only at the first host resolving, and
+	  * concurrent resolving of the same host makes only one DNS query.
+	  * If host has several addresses (A records) they will be returned one
+	  * by one to spread connections.
+	  */
+	class HostResolverImpl : private boost::noncopyable {
+
+	public:
+
+		struct Stat {
+			//! Names found in the cache.
+			long hits;
+			//! Failed names found in the cache.
+			long negativeHits;
+			//! Expired names found in the cache and used while refreshing.
+			long staleHits;
+			//! Names resolved with waiting.
+			long misses;
+			//! Names refreshed in the background.
+			long refreshes;
+			//! Current number of names in the cache.
+			long size;
+		};
+
+	public:
+
+		HostResolverImpl();
+		~HostResolverImpl() throw();
+
+	public:
+
+		//! Resolves host name or IP address string.
+		/** @return false if host name is unknown
+		  */
+		bool Resolve(
+					const std::wstring &host,
+					NetworkPort port,
+					ACE_INET_Addr &result);
+
+		//! Sets DNS servers (IPv4 addresses) instead of system servers.
+		/** Clears the cache. Empty list restores system DNS servers.
+		  */
+		void SetNameServers(const std::vector<std::string> &);
+
+		Stat GetStat() const throw();
+
+	private:
+
+		static ACE_THR_FUNC_RETURN RefreshThreadMain(void *);
+
+	private:
+
+		class Implementation;
+		Implementation *m_pimpl;
+
+		ACE_Thread_Manager m_threadManager;
+
+	};
+
+	typedef ACE_Singleton<HostResolverImpl, ACE_Thread_Mutex> HostResolver;
+
+} } }
+
+#endif // INCLUDED_FILE__TUNNELEX__HostResolver_hpp__2610191231
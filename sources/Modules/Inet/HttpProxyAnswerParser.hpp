@@ -0,0 +1,170 @@
+/**************************************************************************
+ *   Created: 2026/10/19 13:26
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__HttpProxyAnswerParser_hpp__2610191326
+#define INCLUDED_FILE__TUNNELEX__HttpProxyAnswerParser_hpp__2610191326
+
+#include "ProxyExceptions.hpp"
+
+namespace TunnelEx { namespace Mods { namespace Inet {
+
+	//! Incremental parser for HTTP proxy server answer headers.
+	/** Takes answer by parts as it received, doesn't allocate memory and
+	  * doesn't copy data, except status reason phrase (it will be
+	  * truncated if too long). Answer headers are skipped, parsing
+	  * stops right after the headers end, so the next answer or tunnel
+	  * data can follow it in the same data block.
+	  */
+	class HttpProxyAnswerParser {
+
+	public:
+
+		HttpProxyAnswerParser() {
+			Reset();
+		}
+
+	public:
+
+		void Reset() throw() {
+			m_state = STATE_VERSION;
+			m_statePos = 0;
+			m_statusCode = 0;
+			m_reasonSize = 0;
+		}
+
+		//! Parses next part of the answer.
+		/** @return number of bytes which belong to the answer
+		  * @throw ProxyWorkingException if answer has wrong format
+		  */
+		size_t Parse(const char *data, size_t size) {
+			size_t i = 0;
+			for ( ; i < size && m_state != STATE_COMPLETED; ++i) {
+				Parse(data[i]);
+			}
+			return i;
+		}
+
+		bool IsCompleted() const throw() {
+			return m_state == STATE_COMPLETED;
+		}
+
+		unsigned int GetStatusCode() const throw() {
+			assert(IsCompleted());
+			return m_statusCode;
+		}
+
+		std::string GetReason() const {
+			assert(IsCompleted());
+			return std::string(m_reason.data(), m_reasonSize);
+		}
+
+	private:
+
+		void Parse(char ch) {
+
+			switch (m_state) {
+
+				case STATE_VERSION:
+					// "HTTP/d.d"
+					if (m_statePos < 5) {
+						if (toupper(static_cast<unsigned char>(ch)) != "HTTP/"[m_statePos]) {
+							throw ProxyWorkingException(
+								L"Failed to parse proxy server HTTP-headers");
+						}
+					} else if (	m_statePos == 6
+								? ch != '.'
+								: !isdigit(static_cast<unsigned char>(ch))) {
+						throw ProxyWorkingException(
+							L"Failed to parse proxy server HTTP-headers");
+					}
+					if (++m_statePos == 8) {
+						m_state = STATE_CODE;
+						m_statePos = 0;
+					}
+					break;
+
+				case STATE_CODE:
+					if (isdigit(static_cast<unsigned char>(ch))) {
+						if (++m_statePos > 9) {
+							throw ProxyWorkingException(
+								L"Failed to parse proxy server HTTP-headers");
+						}
+						m_statusCode = m_statusCode * 10 + (ch - '0');
+					} else if (ch == ' ' || ch == '\t') {
+						if (m_statePos > 0) {
+							m_state = STATE_REASON;
+						}
+					} else if (ch == '\r' || ch == '\n') {
+						if (m_statePos == 0) {
+							throw ProxyWorkingException(
+								L"Failed to parse proxy server HTTP-headers");
+						}
+						m_state = STATE_REASON;
+						Parse(ch);
+					} else {
+						throw ProxyWorkingException(
+							L"Failed to parse proxy server HTTP-headers");
+					}
+					break;
+
+				case STATE_REASON:
+					if (ch == '\n') {
+						m_state = STATE_HEADERS;
+						// "\r\n" of "\r\n\r\n"
+						m_statePos = 2;
+					} else if (ch == '\r') {
+						//...//
+					} else if (m_reasonSize > 0 || (ch != ' ' && ch != '\t')) {
+						if (m_reasonSize < m_reason.size()) {
+							m_reason[m_reasonSize++] = ch;
+						}
+					}
+					break;
+
+				case STATE_HEADERS:
+					if (ch == "\r\n\r\n"[m_statePos]) {
+						if (++m_statePos == 4) {
+							m_state = STATE_COMPLETED;
+						}
+					} else {
+						m_statePos = ch == '\r' ? 1 : 0;
+					}
+					break;
+
+				default:
+					assert(false);
+					break;
+
+			}
+
+		}
+
+	private:
+
+		enum State {
+			STATE_VERSION,
+			STATE_CODE,
+			STATE_REASON,
+			STATE_HEADERS,
+			STATE_COMPLETED
+		};
+
+		State m_state;
+		size_t m_statePos;
+
+		unsigned int m_statusCode;
+
+		boost::array<char, 128> m_reason;
+		size_t m_reasonSize;
+
+	};
+
+} } }
+
+#endif // INCLUDED_FILE__TUNNELEX__HttpProxyAnswerParser_hpp__2610191326
@@ -11,6 +11,7 @@
 #define INCLUDED_FILE__TUNNELEX__HttpProxyConnection_hpp__091215
 
 #include "OutcomingTcpConnection.hpp"
+#include "HttpProxyAnswerParser.hpp"
 #include "ProxyExceptions.hpp"
 
 #include "Core/MessageBlock.hpp"
@@ -69,7 +70,11 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			StartReadingRemote();
 			m_currentProxy = m_address.GetProxyList().begin();
 			assert(m_currentProxy != m_address.GetProxyList().end());
-			SetupCurrentProxy();
+			if (m_address.IsProxyPipelining()) {
+				SetupAllProxies();
+			} else {
+				SetupCurrentProxy();
+			}
 		}
 
 		virtual void ReadRemote(MessageBlock &messageBlock) {
@@ -79,47 +84,49 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 				return;
 			}
 			
-			m_currentProxyAnswer
-				+= std::string(messageBlock.GetData(), messageBlock.GetUnreadedDataSize());
-			if (!boost::contains(m_currentProxyAnswer, "\r\n\r\n")) {
-				return;
-			}
-			
-			std::string proxyAnswer;
-			proxyAnswer.swap(m_currentProxyAnswer);
-#			ifdef DEV_VER
-			{
-				boost::filesystem::path dumpPath
-					= Helpers::GetModuleFilePathA().branch_path();
-				dumpPath /= "HttpProxyAnswer.html";
-				std::ofstream f(
-					dumpPath.string().c_str(),
-					std::ios::trunc | std::ios::binary);
-				f.write(&proxyAnswer[0], std::streamsize(proxyAnswer.size()));
-			}
-#			endif
-			
 			try {
-				ExtractHeaderInfo(proxyAnswer);
-				if (Log::GetInstance().IsDebugRegistrationOn()) {
-					Log::GetInstance().AppendDebug(
-						"Proxy server %1%:%2% setup completed for %3%.",
-						ConvertString<String>(m_currentProxy->host.c_str()).GetCStr(),
-						m_currentProxy->port,
-						GetInstanceId());
-				}
-				++m_currentProxy;
-				m_isSetupComplited
-					= m_currentProxy == m_address.GetProxyList().end();
-				if (m_isSetupComplited) {
-					StopReadingRemote();
-					Log::GetInstance().AppendDebug(
-						"Proxy servers setup completed for %1%.",
-						GetInstanceId());
-					Base::Setup();
-				} else {
-					SetupCurrentProxy();
+
+				while (messageBlock.GetUnreadedDataSize() > 0) {
+
+					messageBlock.Read(
+						m_proxyAnswer.Parse(
+							messageBlock.GetData(),
+							messageBlock.GetUnreadedDataSize()));
+					if (!m_proxyAnswer.IsCompleted()) {
+						assert(messageBlock.GetUnreadedDataSize() == 0);
+						return;
+					}
+			
+					CheckAnswer(m_proxyAnswer);
+					m_proxyAnswer.Reset();
+					if (Log::GetInstance().IsDebugRegistrationOn()) {
+						Log::GetInstance().AppendDebug(
+							"Proxy server %1%:%2% setup completed for %3%.",
+							ConvertString<String>(m_currentProxy->host.c_str()).GetCStr(),
+							m_currentProxy->port,
+							GetInstanceId());
+					}
+				
+					++m_currentProxy;
+					m_isSetupComplited
+						= m_currentProxy == m_address.GetProxyList().end();
+					if (m_isSetupComplited) {
+						StopReadingRemote();
+						Log::GetInstance().AppendDebug(
+							"Proxy servers setup completed for %1%.",
+							GetInstanceId());
+						Base::Setup();
+						if (messageBlock.GetUnreadedDataSize() > 0) {
+							// remote side has sent data right after the proxy answer
+							Base::ReadRemote(messageBlock);
+						}
+						break;
+					} else if (!m_address.IsProxyPipelining()) {
+						SetupCurrentProxy();
+					}
+
 				}
+
 			} catch (const ProxyWorkingException &ex) {
 				m_isSetupComplited = true;
 				StopReadingRemote();
@@ -134,22 +141,49 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 	protected:
 
 		void SetupCurrentProxy() {
-			ProxyList::const_iterator nextProxy = m_currentProxy;
+			std::string request;
+			AppendRequest(m_currentProxy, request);
+			SendToRemote(*CreateMessageBlock(request.size(), request.c_str()));
+		}
+
+		//! Sends requests for all proxies in the chain without waiting answers.
+		/** Each next request will be forwarded by previous proxy after its
+		  * tunnel will be established, proxy should not drop data which has
+		  * been received before its answer.
+		  */
+		void SetupAllProxies() {
+			std::string requests;
+			for (	ProxyList::const_iterator i = m_currentProxy;
+					i != m_address.GetProxyList().end();
+					++i) {
+				AppendRequest(i, requests);
+			}
+			SendToRemote(*CreateMessageBlock(requests.size(), requests.c_str()));
+		}
+
+		void AppendRequest(
+					const ProxyList::const_iterator &proxy,
+					std::string &request)
+				const {
+			ProxyList::const_iterator nextProxy = proxy;
 			std::advance(nextProxy, 1);
 			if (nextProxy != m_address.GetProxyList().end()) {
-				SetupProxy(*m_currentProxy, nextProxy->host, nextProxy->port);
+				AppendProxyRequest(*proxy, nextProxy->host, nextProxy->port, request);
 			} else {
-				SetupProxy(
-					*m_currentProxy,
+				AppendProxyRequest(
+					*proxy,
 					m_address.GetHostName(),
-					m_address.GetPort());
+					m_address.GetPort(),
+					request);
 			}
 		}
 
-		void SetupProxy(
+		void AppendProxyRequest(
 					const Proxy &proxy,
 					const std::wstring &targetHost,
-					const NetworkPort targetPort) {
+					const NetworkPort targetPort,
+					std::string &request)
+				const {
 
 			if (Log::GetInstance().IsDebugRegistrationOn()) {
 				Log::GetInstance().AppendDebug(
@@ -182,45 +216,16 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			}
 			cmd << "\r\n";
 
-			const std::string &cmdStr = cmd.str();
-			SendToRemote(*CreateMessageBlock(cmdStr.size(), cmdStr.c_str()));
+			request += cmd.str();
 		
 		}
 
 	private:
 
-		static void ExtractHeaderInfo(const std::string &headers) {
-			bool isAnswerChecked = false;
-			typedef boost::split_iterator<std::string::const_iterator> It;
-			for (	It i = boost::make_split_iterator(
-						headers,
-						boost::first_finder("\r\n", boost::is_equal()));
-					i != It();
-					++i) {
-				if (!isAnswerChecked) {
-					CheckAnswer(*i);
-					isAnswerChecked = true;
-				} else {
-					// extract other headers here
-					break;
-				}
-			}
-			if (!isAnswerChecked) {
-				throw ProxyWorkingException(L"Failed to get proxy server answer");
-			}
-		}
-
-		template<class Range>
-		static void CheckAnswer(const Range &line) {
-			boost::smatch what;
-			const boost::regex expr(
-				"HTTP/\\d\\.\\d\\s+(\\d+)\\s+(.+)",
-				boost::regex_constants::icase);
-			if (!boost::regex_match(boost::begin(line), boost::end(line), what, expr)) {
-				throw ProxyWorkingException(L"Failed to parse proxy server HTTP-headers");
-			} else if (what[1] != "200") {
+		static void CheckAnswer(const HttpProxyAnswerParser &answer) {
+			if (answer.GetStatusCode() != 200) {
 				Format format("%1% (error code: %2%)");
-				format % what[2] % what[1];
+				format % answer.GetReason() % answer.GetStatusCode();
 				throw ProxyWorkingException(ConvertString<WString>(format.str().c_str()).GetCStr());
 			}
 		}
@@ -231,7 +236,7 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 		bool m_isSetupComplited;
 
-		std::string m_currentProxyAnswer;
+		HttpProxyAnswerParser m_proxyAnswer;
 		ProxyList::const_iterator m_currentProxy;
 
 	};
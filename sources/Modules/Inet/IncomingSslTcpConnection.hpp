@@ -0,0 +1,291 @@
+/**************************************************************************
+ *   Created: 2026/10/19 11:05
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#pragma once
+
+#include "TcpConnection.hpp"
+#include "InetEndpointAddress.hpp"
+#include "ConnectionsTraits.hpp"
+#include "SslSessionCache.hpp"
+#include "Core/Endpoint.hpp"
+#include "Core/Log.hpp"
+#include "Core/Exceptions.hpp"
+#include "Core/Error.hpp"
+
+namespace TunnelEx { namespace Mods { namespace Inet {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Incoming TCP connection with SSL/TLS.
+	/** TCP connection is accepted by an unsecured acceptor, SSL/TLS
+	  * handshake doesn't block the acceptor thread - it is started at the
+	  * connection setup and driven by data reading, so handshakes of many
+	  * connections go in parallel at the proactor threads.
+	  */
+	template<bool isServer>
+	class IncomingSslTcpConnection
+			: public TcpConnection<ConnectionsTraits::TcpSecureIncoming::Stream> {
+
+	public:
+
+		typedef ConnectionsTraits::TcpSecureIncoming MyTrait;
+		typedef ConnectionsTraits::TcpUnsecureIncoming UnsecureTrait;
+		typedef MyTrait::Stream DecodeStream;
+		typedef UnsecureTrait::Stream RawStream;
+		typedef AcceptionTraits::Tcp<false>::Acceptor Acceptor;
+		typedef TcpConnection<DecodeStream> Base;
+
+	public:
+
+		explicit IncomingSslTcpConnection(
+					const RuleEndpoint &ruleEndpoint,
+					SharedPtr<const EndpointAddress> ruleEndpointAddress,
+					const Acceptor &acceptor)
+				: Base(ruleEndpoint, ruleEndpointAddress) {
+			AcceptConnection(acceptor, ruleEndpoint, *ruleEndpointAddress);
+		}
+
+		virtual ~IncomingSslTcpConnection() throw() {
+			assert(m_rawStream.get_handle() == ACE_INVALID_HANDLE);
+		}
+
+	public:
+
+		virtual bool IsOneWay() const {
+			return false;
+		}
+
+		virtual AutoPtr<EndpointAddress> GetRemoteAddress() const {
+			return AutoPtr<EndpointAddress>(new TcpEndpointAddress(*m_remoteAddress));
+		}
+
+	protected:
+
+		virtual void CloseIoHandle() throw() {
+			assert(m_rawStream.get_handle() != ACE_INVALID_HANDLE);
+			CloseDataStream();
+			m_rawStream.close();
+		}
+
+		virtual void Setup() {
+			assert(!GetDataStream().IsDecryptorEncryptorMode());
+			GetDataStream().SwitchToDecryptorEncryptorMode();
+			SetupSslConnection(false);
+		}
+
+		virtual void ReadRemote(MessageBlock &messageBlock) {
+			assert(GetDataStream().IsDecryptorEncryptorMode());
+			if (	GetDataStream().IsConnected()
+					|| messageBlock.GetUnreadedDataSize() == 0) {
+				Base::ReadRemote(messageBlock);
+				return;
+			}
+			assert(!IsSetupCompleted());
+			if (!SetupSslConnection(true, &messageBlock)) {
+				return;
+			}
+			assert(
+				GetDataStream().IsConnected()
+				|| messageBlock.GetUnreadedDataSize() == 0);
+			if (GetDataStream().IsConnected()) {
+				Base::ReadRemote(messageBlock);
+			}
+		}
+
+	protected:
+
+		virtual ACE_SOCK & GetIoStream() throw() {
+			return m_rawStream;
+		}
+		virtual const ACE_SOCK & GetIoStream() const throw() {
+			return const_cast<IncomingSslTcpConnection *>(this)->GetIoStream();
+		}
+
+	private:
+
+		void SslConnect() {
+			static_assert(
+				false,
+				"Implements SSL connection process (connect or accept).");
+		}
+		void SslConnect(MessageBlock &) {
+			static_assert(
+				false,
+				"Implements SSL connection process (connect or accept).");
+		}
+
+		const ACE_SSL_Context & GetSslContext(const TcpEndpointAddress &) const {
+			static_assert(
+				false,
+				"Implements SSL connection process (connect or accept).");
+		}
+
+		//! Cancels setup with the handshake error, certificate denial
+		//! reason comes from SslSockStream::Exception.
+		void HandleAcceptError(const LocalException &) {
+			static_assert(
+				false,
+				"Implements SSL connection process (connect or accept).");
+		}
+
+	private:
+
+		void AcceptConnection(
+					const Acceptor &acceptor,
+					const RuleEndpoint &ruleEndpoint,
+					const EndpointAddress &ruleEndpointAddress) {
+
+			ACE_Time_Value timeout(ruleEndpoint.GetOpenTimeout());
+			ACE_INET_Addr aceRemoteAddr;
+			if (acceptor.accept(m_rawStream, &aceRemoteAddr, &timeout) != 0) {
+				const Error error(errno);
+				WFormat message(L"Failed to accept incoming connection: \"%1% (%2%)\"");
+				message % error.GetStringW() % error.GetErrorNo();
+				throw ConnectionOpeningException(message.str().c_str());
+			}
+			AutoPtr<const TcpEndpointAddress> remoteAddress(
+				new TcpEndpointAddress(aceRemoteAddr));
+
+			std::auto_ptr<DecodeStream> decodeStream(
+				new DecodeStream(
+					GetSslContext(
+						*boost::polymorphic_downcast<const TcpEndpointAddress *>(
+							&ruleEndpointAddress))));
+			decodeStream->set_handle(m_rawStream.get_handle());
+			SetDataStream(decodeStream);
+
+			remoteAddress.Swap(m_remoteAddress);
+
+		}
+
+		bool SetupSslConnection(
+					bool isReadingStarted,
+					MessageBlock *messageBlock = nullptr) {
+
+			try {
+				!messageBlock
+					?	SslConnect()
+					:	SslConnect(*messageBlock);
+			} catch (const TunnelEx::LocalException &ex) {
+				if (isReadingStarted) {
+					StopReadingRemote();
+				}
+				HandleAcceptError(ex);
+				return false;
+			}
+
+			if (!GetDataStream().GetEncrypted().empty()) {
+				auto cleanFunc = [](Stream *stream) {
+					stream->ClearEncrypted();
+				};
+				std::unique_ptr<Stream, decltype(cleanFunc)> cleaner(
+					&GetDataStream(),
+					cleanFunc);
+				WriteDirectly(
+					*CreateMessageBlock(
+						GetDataStream().GetEncrypted().size(),
+						&GetDataStream().GetEncrypted()[0]));
+			}
+
+			if (!GetDataStream().IsConnected()) {
+				if (!isReadingStarted) {
+					StartReadingRemote();
+				}
+				return true;
+			}
+
+			CompleteSslConnect();
+			if (isReadingStarted) {
+				StopReadingRemote();
+			}
+			Base::Setup();
+			return true;
+
+		}
+
+		void CompleteSslConnect() {
+			assert(
+				SSL_get_peer_certificate(GetDataStream().ssl()) != 0
+				|| boost::polymorphic_downcast<const TcpEndpointAddress *>(
+						GetRuleEndpointAddress().Get())
+					->GetRemoteCertificates().GetSize() == 0);
+			assert(
+				SSL_get_peer_certificate(GetDataStream().ssl()) == 0
+				|| SSL_get_verify_result(GetDataStream().ssl()) == X509_V_OK);
+			SslSessionCache::instance()->OnHandshakeCompleted(*GetDataStream().ssl());
+			Log::GetInstance().AppendDebug(
+				isServer
+					?	"SSL/TLS connection for %1% created (accepted)."
+					:	"SSL/TLS connection for %1% created (connected).",
+				GetInstanceId());
+		}
+
+	private:
+
+		TunnelEx::AutoPtr<const TunnelEx::Mods::Inet::TcpEndpointAddress>
+			m_remoteAddress;
+		RawStream m_rawStream;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template<>
+	void IncomingSslTcpConnection<false>::SslConnect() {
+		GetDataStream().Connect();
+	}
+	template<>
+	void IncomingSslTcpConnection<false>::SslConnect(MessageBlock &messageBlock) {
+		GetDataStream().Connect(messageBlock);
+	}
+
+	template<>
+	const ACE_SSL_Context & IncomingSslTcpConnection<false>::GetSslContext(
+				const TcpEndpointAddress &address)
+			const {
+		return address.GetSslClientContext();
+	}
+
+	template<>
+	void IncomingSslTcpConnection<false>::HandleAcceptError(
+				const LocalException &ex) {
+		WFormat message(
+			L"Failed to create secure (SSL/TLS) incoming connection for %2%: %1%");
+		message % ex.GetWhat() % GetInstanceId();
+		CancelSetup(message.str().c_str());
+	}
+
+	template<>
+	void IncomingSslTcpConnection<true>::SslConnect() {
+		GetDataStream().Accept();
+	}
+	template<>
+	void IncomingSslTcpConnection<true>::SslConnect(MessageBlock &messageBlock) {
+		GetDataStream().Accept(messageBlock);
+	}
+
+	template<>
+	const ACE_SSL_Context & IncomingSslTcpConnection<true>::GetSslContext(
+				const TcpEndpointAddress &address)
+			const {
+		return address.GetSslServerContext();
+	}
+
+	template<>
+	void IncomingSslTcpConnection<true>::HandleAcceptError(
+				const LocalException &ex) {
+		SslSessionCache::instance()->OnHandshakeFailed(*GetDataStream().ssl());
+		WFormat message(L"Failed to accept incoming connection: \"%1%\"");
+		message % ex.GetWhat();
+		CancelSetup(message.str().c_str());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} } }
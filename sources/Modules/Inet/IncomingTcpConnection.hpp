@@ -113,106 +113,4 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 	};
 
-	template<>
-	bool IncomingTcpConnection<true>::IsOneWay() const {
-		return GetIoStream().get_handle() == ACE_INVALID_HANDLE;
-	}
-	
-	template<>
-	std::auto_ptr<IncomingTcpConnection<true>::Stream>
-	IncomingTcpConnection<true>::CreateStream(
-				const EndpointAddress &address)
-			const {
-		std::auto_ptr<Stream> result(
-			new Stream(
-				boost::polymorphic_downcast<const TcpEndpointAddress *>(&address)
-					->GetSslServerContext()));
-		return result;
-	}
-
-	template<>
-	void IncomingTcpConnection<true>::HandleAcceptSuccess(Stream &stream) const {
-		assert(
-			SSL_get_peer_certificate(stream.ssl()) != 0
-			|| boost::polymorphic_downcast<const TcpEndpointAddress *>(
-					GetRuleEndpointAddress().Get())
-				->GetRemoteCertificates().GetSize() == 0);
-		assert(
-			SSL_get_peer_certificate(stream.ssl()) == 0
-			|| SSL_get_verify_result(stream.ssl()) == X509_V_OK);
-		Log::GetInstance().AppendDebug(
-			"SSL/TLS connection for %1% created (accepted).",
-			GetInstanceId());
-		stream.SwitchToDecryptorEncryptorMode();
-	}
-
-	template<>
-	void IncomingTcpConnection<true>::HandleAcceptError(Stream &stream) const {
-
-		using namespace Helpers::Crypto;
-
-		const Error sysError(errno);
-		const OpenSslError openSslError(OpenSslError::GetLast(true));
-
-		if (sysError.IsError() || openSslError.GetErrorsNumb() > 0) {
-			
-			stream.close();
-
-			WFormat message(L"Failed to accept incoming connection: \"%1% (%2%)\"");
-			const wchar_t *const accessDeniedNoCertMessage
-				= L"access denied, remote certificate does not presented";
-			const wchar_t *const accessDeniedWronCertMessage
-				= L"access denied, remote certificate does not allowed";
-
-			if (sysError.IsError()) {
-			
-				if (openSslError.GetErrorsNumb() > 0) {
-					Log::GetInstance().AppendDebug(openSslError.GetAsString());
-				}
-
-				if (!sysError.CheckError()) {
-					
-					switch (ERR_GET_REASON(sysError.GetErrorNo())) {
-						case SSL_R_PEER_DID_NOT_RETURN_A_CERTIFICATE:
-							message % accessDeniedNoCertMessage;
-							break;
-						case SSL_R_NO_CERTIFICATE_RETURNED:
-							message % accessDeniedWronCertMessage;
-							break;
-						default:
-							if (openSslError.CheckError(sysError.GetErrorNo())) {
-								message % OpenSslError::ErrorNoToString(sysError.GetErrorNo());
-						} else {
-							message % sysError.GetStringW();
-						}
-						break;
-					}
-				
-				} else {
-					message % sysError.GetStringW();
-				}
-			
-			} else {
-			
-				if (openSslError.IsReason(SSL_R_PEER_DID_NOT_RETURN_A_CERTIFICATE)) { 
-					message % accessDeniedNoCertMessage;
-				} else if (openSslError.IsReason(SSL_R_NO_CERTIFICATE_RETURNED)) {
-					message % accessDeniedWronCertMessage;
-				} else {
-					message % openSslError.GetAsString();
-				}
-
-			}
-		
-			message % sysError.GetErrorNo();
-
-			throw ConnectionOpeningException(message.str().c_str());
-
-		}
-
-		assert(stream.get_handle() == ACE_INVALID_HANDLE);
-		ACE_UNUSED_ARG(stream);
-
-	}
-
 } } }
@@ -12,6 +12,7 @@
 
 #include "UdpConnection.hpp"
 #include "ConnectionsTraits.hpp"
+#include "UdpSendQueue.hpp"
 
 #include "Core/Error.hpp"
 #include "Core/Log.hpp"
@@ -36,10 +37,6 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 	private:
 
-		typedef ACE_RW_Mutex SendMutex;
-		typedef ACE_Read_Guard<SendMutex> SendReadLock;
-		typedef ACE_Write_Guard<SendMutex> SendWriteLock;
-
 		typedef ACE_Thread_Mutex AcceptorMutex;
 		typedef ACE_Guard<AcceptorMutex> AcceptorLock;
 
@@ -50,11 +47,13 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 					const TunnelEx::RuleEndpoint &ruleEndpoint,
 					SharedPtr<const EndpointAddress> ruleEndpointAddress,
 					boost::shared_ptr<Stream> &socket,
+					boost::shared_ptr<UdpSendQueue> &sendQueue,
 					AutoPtr<MessageBlock> incomingData,
 					Acceptor *const acceptor)
 				: UdpConnection(ruleEndpoint, ruleEndpointAddress, 60), //! @todo: hardcoded idle time
 				m_remoteAddress(address),
 				m_socket(socket),
+				m_sendQueue(sendQueue),
 				m_incomingData(incomingData),
 				m_acceptor(acceptor) {
 			//...//
@@ -118,13 +117,16 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 		virtual DataTransferCommand Write(MessageBlock &messageBlock) {
 			assert(messageBlock.GetUnreadedDataSize() > 0);
-			const ssize_t sentBytesNumb = m_socket->send(
+			// Socket is shared with acceptor and works in non-blocking mode,
+			// waiting for free space in the system send buffer stops all
+			// other connections of the proactor thread, so the datagram waits
+			// in the queue, which is sent by the acceptor.
+			const bool isSent = m_sendQueue->Send(
+				*m_socket,
 				messageBlock.GetData(),
 				messageBlock.GetUnreadedDataSize(),
 				m_remoteAddress);
-			if (	(sentBytesNumb < 0
-						|| size_t(sentBytesNumb) != messageBlock.GetUnreadedDataSize())
-					&& Log::GetInstance().IsDebugRegistrationOn()) {
+			if (!isSent && Log::GetInstance().IsDebugRegistrationOn()) {
 				const Error error(errno);
 				const UdpEndpointAddress addr(m_remoteAddress);
 				Log::GetInstance().AppendDebug(
@@ -140,6 +142,7 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 		const ACE_INET_Addr m_remoteAddress;
 		boost::shared_ptr<Stream> m_socket;
+		boost::shared_ptr<UdpSendQueue> m_sendQueue;
 		AutoPtr<MessageBlock> m_incomingData;
 		AcceptorMutex m_acceptorMutex;
 		Acceptor *m_acceptor;
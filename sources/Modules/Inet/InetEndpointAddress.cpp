@@ -18,9 +18,13 @@
 #include "ConnectionsTraits.hpp"
 #include "EndpointResourceIdentifierParsers.hpp"
 #include "Licensing.hpp"
+#include "SslSessionCache.hpp"
+#include "SslContextCache.hpp"
+#include "HostResolver.hpp"
 
 #include "Core/Exceptions.hpp"
 #include "Core/String.hpp"
+#include "Core/Locking.hpp"
 
 using namespace TunnelEx;
 using namespace TunnelEx::Helpers;
@@ -34,6 +38,7 @@ namespace {
 		static Licensing::FsLocalStorageState licenseState;
 		return licenseState;
 	}
+	volatile long isSslAesGcmPreferred = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -272,7 +277,9 @@ public:
 			m_port(rhs.m_port),
 			m_adapter(rhs.m_adapter),
 			m_server(rhs.m_server) {
-		if (rhs.m_addr.get()) {
+		// resolved host name not copied - each copy takes actual address
+		// from the resolver cache
+		if (rhs.m_addr.get() && !rhs.IsResolvedByName()) {
 			m_addr.reset(new ACE_INET_Addr(*rhs.m_addr));
 		}
 	}
@@ -305,7 +312,7 @@ public:
 		if (!m_adapter.empty()) {
 			if (boost::iequals(m_adapter, L"all")) {
 				if (m_host != L"*") {
-					m_addr.reset(new ACE_INET_Addr(m_port, m_host.c_str(), AF_INET));
+					m_addr = Resolve();
 				} else {
 					m_addr.reset(new ACE_INET_Addr(m_port, static_cast<ACE_UINT32>(INADDR_ANY)));
 				}
@@ -370,13 +377,34 @@ public:
 		} else if (m_host == L"*") {
 			m_addr.reset(new ACE_INET_Addr(m_port, static_cast<ACE_UINT32>(INADDR_ANY)));
 		} else {
-			m_addr.reset(new ACE_INET_Addr(m_port, m_host.c_str(), AF_INET));
+			m_addr = Resolve();
 		}
 
 		return *m_addr;
 
 	}
 
+private:
+
+	bool IsResolvedByName() const {
+		return
+			!m_host.empty()
+			&& m_host != L"*"
+			&& (m_adapter.empty() || boost::iequals(m_adapter, L"all"));
+	}
+
+	std::auto_ptr<ACE_INET_Addr> Resolve() const {
+		std::auto_ptr<ACE_INET_Addr> result(new ACE_INET_Addr);
+		if (!HostResolver::instance()->Resolve(m_host, m_port, *result)) {
+			// address is not cached, so the name will be resolved again
+			// at the next connection opening
+			WFormat message(L"Failed to resolve host name \"%1%\"");
+			message % m_host;
+			throw ConnectionOpeningException(message.str().c_str());
+		}
+		return result;
+	}
+
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -486,6 +514,10 @@ const ACE_INET_Addr & InetEndpointAddress::GetAceInetAddr() const {
 	return m_pimpl->GetAceInetAddr();
 }
 
+void InetEndpointAddress::SetNameServers(const std::vector<std::string> &servers) {
+	HostResolver::instance()->SetNameServers(servers);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 class TcpEndpointAddress::Implementation {
@@ -493,12 +525,14 @@ class TcpEndpointAddress::Implementation {
 public:
 
 	Implementation()
-			: m_forceSslStatus(FSS_NONE) {
+			: m_isProxyPipelining(false),
+			m_forceSslStatus(FSS_NONE) {
 		//...//
 	}
 
 	explicit Implementation(const WString &resourceIdentifier)
-			: m_forceSslStatus(FSS_NONE) {
+			: m_isProxyPipelining(false),
+			m_forceSslStatus(FSS_NONE) {
 		const std::wstring path = resourceIdentifier.GetCStr();
 		EndpointResourceIdentifierParsers::UrlSplitConstIterator pathIt
 			= boost::make_split_iterator(
@@ -510,6 +544,14 @@ public:
 			L"proxy",
 			boost::bind(&ParseEndpointProxy, _1, boost::ref(m_proxyList)),
 			true);
+		EndpointResourceIdentifierParsers::ParseUrlParam(
+			pathIt,
+			L"proxy_pipelining",
+			boost::bind(
+				&EndpointResourceIdentifierParsers::ParseUrlParamValue<bool>,
+				_1,
+				boost::ref(m_isProxyPipelining)),
+			false);
 		EndpointResourceIdentifierParsers::ParseEndpointCertificates(
 			pathIt,
 			m_certificate,
@@ -517,16 +559,22 @@ public:
 	}
 
 	~Implementation() {
-		if (m_sslClientContext.get()) {
-			SSL_CTX_flush_sessions(m_sslClientContext->context(), 0);
+		FlushSslSessions();
+	}
+
+	//! Removes sessions of contexts which are not shared with other endpoints.
+	void FlushSslSessions() throw() {
+		if (m_sslClientContext.unique()) {
+			SslSessionCache::instance()->Flush(*m_sslClientContext->context());
 		}
-		if (m_sslServerContext.get()) {
-			SSL_CTX_flush_sessions(m_sslServerContext->context(), 0);
+		if (m_sslServerContext.unique()) {
+			SslSessionCache::instance()->Flush(*m_sslServerContext->context());
 		}
 	}
 
 	Implementation(const Implementation &rhs)
 			: m_proxyList(rhs.m_proxyList),
+			m_isProxyPipelining(rhs.m_isProxyPipelining),
 			m_resourceIdentifier(rhs.m_resourceIdentifier),
 			m_certificate(rhs.m_certificate),
 			m_remoteCertificates(rhs.m_remoteCertificates),
@@ -560,6 +608,46 @@ public:
 		return m_sslClientContext || m_forceSslStatus == FSS_CLIENT;
 	}
 
+	boost::shared_ptr<ACE_SSL_Context> GetSslContext(
+				bool isServer,
+				Server::ConstRef server)
+			const {
+		// license has to be checked for each endpoint, not only at the
+		// context creation
+		CheckSslLicense();
+		const bool isAnonymous
+			=	!m_privateKey
+				&& m_certificate == TcpEndpointAddress::GetAnonymousSslCertificateMagicName();
+		if (isAnonymous || m_remotePublicCertificate) {
+			// anonymous certificate is unique for each endpoint as well as
+			// the copied remote certificate, so context can't be shared
+			return boost::shared_ptr<ACE_SSL_Context>(
+				CreateSslContext(isServer, server).release());
+		}
+		return SslContextCache::instance()->Get(
+			isServer,
+			m_certificate,
+			m_remoteCertificates,
+			boost::bind(
+				&Implementation::CreateSslContext,
+				this,
+				isServer,
+				boost::cref(server)));
+	}
+
+	static void CheckSslLicense() {
+		static Licensing::SslLicense sslLicense(&GetLicensingState());
+		if (!sslLicense.IsFeatureAvailable(true)) {
+			Log::GetInstance().AppendWarn(
+				"Could not use SSL/TLS."
+					" The functionality you have requested requires"
+					" a License Upgrade. Please purchase a License that"
+					" will enable this feature at http://" TUNNELEX_DOMAIN "/order"
+					" or get free trial at http://" TUNNELEX_DOMAIN "/order/trial.");
+			throw LocalException(L"Could not use SSL/TLS, License Upgrade required");
+		}
+	}
+
 	std::auto_ptr<ACE_SSL_Context> CreateSslContext(
 				bool isServer,
 				Server::ConstRef server)
@@ -588,18 +676,38 @@ public:
 			SSL_CTX_set_session_cache_mode(result->context(), sessionCacheMode);
 		}
 
-		static Licensing::SslLicense sslLicense(&GetLicensingState());
-		if (!sslLicense.IsFeatureAvailable(true)) {
-			Log::GetInstance().AppendWarn(
-				"Could not use SSL/TLS."
-					" The functionality you have requested requires"
-					" a License Upgrade. Please purchase a License that"
-					" will enable this feature at http://" TUNNELEX_DOMAIN "/order"
-					" or get free trial at http://" TUNNELEX_DOMAIN "/order/trial.");
-			throw LocalException(L"Could not use SSL/TLS, License Upgrade required");
+		if (Interlocked::CompareExchange(isSslAesGcmPreferred, 1, 1) == 1) {
+			// AEAD ciphers with hardware AES support are much cheaper for the
+			// records encryption at proactor threads.
+			if (	SSL_CTX_set_cipher_list(
+						result->context(),
+						"AESGCM:" SSL_DEFAULT_CIPHER_LIST)
+					!= 1) {
+				Log::GetInstance().AppendWarn(
+					"Failed to set preferred SSL/TLS ciphers,"
+						" default ciphers order will be used.");
+			} else if (isServer) {
+				SSL_CTX_set_options(
+					result->context(),
+					SSL_OP_CIPHER_SERVER_PREFERENCE);
+			}
 		}
 
-		{
+		const bool isAnonymous
+			=	!m_privateKey
+				&& m_certificate == TcpEndpointAddress::GetAnonymousSslCertificateMagicName();
+
+		if (!isAnonymous && !m_remotePublicCertificate) {
+			// sessions will be shared with all endpoints with the same
+			// certificates
+			SslSessionCache::instance()->Attach(
+				*result->context(),
+				isServer,
+				m_certificate,
+				m_remoteCertificates);
+		} else {
+			// anonymous certificate is unique for each endpoint as well as
+			// the copied remote certificate, so sessions can't be shared
 			typedef boost::uint32_t SessionId;
 			static SessionId id = 0;
 			++id;
@@ -610,10 +718,6 @@ public:
 				sizeof(SessionId));
 		}
 
-		const bool isAnonymous
-			=	!m_privateKey
-				&& m_certificate == TcpEndpointAddress::GetAnonymousSslCertificateMagicName();
-
 		// Certificate set
 		if (isServer || !isAnonymous) {
 			if (!m_privateKey) {
@@ -738,6 +842,7 @@ private:
 public:
 
 	ProxyList m_proxyList;
+	bool m_isProxyPipelining;
 	mutable std::auto_ptr<ACE_INET_Addr> m_proxyAddr;
 
 	WString m_resourceIdentifier;
@@ -1025,6 +1130,9 @@ const WString & TcpEndpointAddress::GetResourceIdentifier() const {
 				GetCertificate(),
 				GetRemoteCertificates(),
 				GetProxyList());
+			if (m_pimpl->m_isProxyPipelining) {
+				m_pimpl->m_resourceIdentifier += L"&proxy_pipelining=true";
+			}
 		} else {
 			m_pimpl->m_resourceIdentifier = CreateEndpointResourceIdentifier(
 				GetProto(),
@@ -1100,10 +1208,20 @@ void TcpEndpointAddress::SetProxyList(const ProxyList &newList) {
 	m_pimpl->m_proxyAddr.reset();
 }
 
+bool TcpEndpointAddress::IsProxyPipelining() const {
+	return m_pimpl->m_isProxyPipelining;
+}
+
+void TcpEndpointAddress::SetProxyPipelining(bool isOn) {
+	ClearResourceIdentifierCache();
+	m_pimpl->m_isProxyPipelining = isOn;
+}
+
 void TcpEndpointAddress::ClearResourceIdentifierCache() throw() {
 	InetEndpointAddress::ClearResourceIdentifierCache();
 	try {
 		m_pimpl->m_resourceIdentifier.Clear();
+		m_pimpl->FlushSslSessions();
 		m_pimpl->m_sslServerContext.reset();
 		m_pimpl->m_sslClientContext.reset();
 	} catch (...) {
@@ -1152,7 +1270,7 @@ const ACE_SSL_Context & TcpEndpointAddress::GetSslServerContext() const {
 	} else if (m_pimpl->m_forceSslStatus == Implementation::FSS_CLIENT) {
 		throw LogicalException(L"Internal error: SSL/TLS context for server endpoint does not provided");
 	}
-	m_pimpl->m_sslServerContext = m_pimpl->CreateSslContext(true, *GetServer());
+	m_pimpl->m_sslServerContext = m_pimpl->GetSslContext(true, *GetServer());
 	return *m_pimpl->m_sslServerContext;
 }
 
@@ -1166,7 +1284,7 @@ const ACE_SSL_Context & TcpEndpointAddress::GetSslClientContext() const {
 	} else if (m_pimpl->m_forceSslStatus == Implementation::FSS_SERVER) {
 		throw LogicalException(L"Internal error: SSL/TLS context for client endpoint does not provided");
 	}
-	m_pimpl->m_sslClientContext = m_pimpl->CreateSslContext(false, *GetServer());
+	m_pimpl->m_sslClientContext = m_pimpl->GetSslContext(false, *GetServer());
 	return *m_pimpl->m_sslClientContext;
 }
 
@@ -1234,6 +1352,10 @@ const WString & TcpEndpointAddress::GetAnonymousSslCertificateMagicName() {
 	return name;
 }
 
+void TcpEndpointAddress::SetSslAesGcmPreference(bool isPreferred) {
+	Interlocked::Exchange(isSslAesGcmPreferred, isPreferred ? 1 : 0);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 class UdpEndpointAddress::Implementation {
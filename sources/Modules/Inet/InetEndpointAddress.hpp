@@ -111,6 +111,14 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 		Server::ConstPtr GetServer() const;
 
+	public:
+
+		//! Sets DNS servers (IPv4 addresses) for host names resolving.
+		/** Empty list restores system DNS servers.
+		  * @throw TunnelEx::LogicalException if server address is invalid
+		  */
+		static void SetNameServers(const std::vector<std::string> &);
+
 	protected:
 
 		virtual void ClearResourceIdentifierCache() throw();
@@ -159,6 +167,13 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 		const ProxyList & GetProxyList() const;
 		void SetProxyList(const ProxyList &);
 
+		//! Sends requests for all proxies in the chain at once.
+		/** Saves round-trip for each proxy in the chain, but works only if
+		  * proxy doesn't drop data received before its answer.
+		  */
+		bool IsProxyPipelining() const;
+		void SetProxyPipelining(bool);
+
 	public:
 
 		virtual bool IsHasMultiClientsType() const;
@@ -236,6 +251,12 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 		static const ::TunnelEx::WString & GetAnonymousSslCertificateMagicName();
 
+		//! Sets AES-GCM ciphers preference for new SSL/TLS contexts.
+		/** If set, AES-GCM ciphers are placed first in the ciphers list
+		  * and server uses its own ciphers order. Off by default.
+		  */
+		static void SetSslAesGcmPreference(bool);
+
 	protected:
 
 		virtual TunnelEx::AutoPtr<TunnelEx::Connection> CreateConnection(
@@ -0,0 +1,113 @@
+/**************************************************************************
+ *   Created: 2026/10/20 10:16
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "InetMetrics.hpp"
+#include "SslSessionCache.hpp"
+#include "SslContextCache.hpp"
+#include "HostResolver.hpp"
+
+using namespace TunnelEx;
+using namespace TunnelEx::Mods::Inet;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	long long Read(const volatile long long &value) throw() {
+		return Interlocked::CompareExchange(
+			const_cast<volatile long long &>(value),
+			0,
+			0);
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+InetMetricsImpl::InetMetricsImpl()
+		: m_udpSendDrops(0) {
+	//...//
+}
+
+InetMetricsImpl::~InetMetricsImpl() throw() {
+	//...//
+}
+
+void InetMetricsImpl::OnUdpSendDrop() throw() {
+	Interlocked::ExchangeAdd(m_udpSendDrops, 1);
+}
+
+void InetMetricsImpl::Export(std::string &result) const {
+
+	std::ostringstream os;
+	os.imbue(std::locale::classic());
+
+	os << "# HELP tunnelex_udp_send_drops_total UDP datagrams dropped by incoming sessions as the listener send queue is full." << std::endl;
+	os << "# TYPE tunnelex_udp_send_drops_total counter" << std::endl;
+	os << "tunnelex_udp_send_drops_total " << Read(m_udpSendDrops) << std::endl;
+
+	{
+		const SslSessionCacheImpl::Stat stat = SslSessionCache::instance()->GetStat();
+		os << "# HELP tunnelex_ssl_session_cache_hits_total SSL/TLS sessions found in the cache." << std::endl;
+		os << "# TYPE tunnelex_ssl_session_cache_hits_total counter" << std::endl;
+		os << "tunnelex_ssl_session_cache_hits_total " << stat.hits << std::endl;
+		os << "# HELP tunnelex_ssl_session_cache_misses_total SSL/TLS sessions not found in the cache or expired." << std::endl;
+		os << "# TYPE tunnelex_ssl_session_cache_misses_total counter" << std::endl;
+		os << "tunnelex_ssl_session_cache_misses_total " << stat.misses << std::endl;
+		os << "# HELP tunnelex_ssl_session_cache_timeouts_total Expired SSL/TLS sessions removed at lookup." << std::endl;
+		os << "# TYPE tunnelex_ssl_session_cache_timeouts_total counter" << std::endl;
+		os << "tunnelex_ssl_session_cache_timeouts_total " << stat.timeouts << std::endl;
+		os << "# HELP tunnelex_ssl_session_cache_size SSL/TLS sessions in the cache." << std::endl;
+		os << "# TYPE tunnelex_ssl_session_cache_size gauge" << std::endl;
+		os << "tunnelex_ssl_session_cache_size " << stat.size << std::endl;
+		os << "# HELP tunnelex_ssl_handshakes_total Completed SSL/TLS handshakes." << std::endl;
+		os << "# TYPE tunnelex_ssl_handshakes_total counter" << std::endl;
+		os << "tunnelex_ssl_handshakes_total{resumed=\"true\"} " << stat.resumedHandshakes << std::endl;
+		os << "tunnelex_ssl_handshakes_total{resumed=\"false\"} " << stat.fullHandshakes << std::endl;
+		os << "# HELP tunnelex_ssl_handshakes_per_second SSL/TLS handshakes completed at the last full second." << std::endl;
+		os << "# TYPE tunnelex_ssl_handshakes_per_second gauge" << std::endl;
+		os << "tunnelex_ssl_handshakes_per_second " << stat.handshakesPerSecond << std::endl;
+	}
+
+	{
+		const SslContextCacheImpl::Stat stat = SslContextCache::instance()->GetStat();
+		os << "# HELP tunnelex_ssl_context_cache_hits_total Shared SSL/TLS contexts found in the cache." << std::endl;
+		os << "# TYPE tunnelex_ssl_context_cache_hits_total counter" << std::endl;
+		os << "tunnelex_ssl_context_cache_hits_total " << stat.hits << std::endl;
+		os << "# HELP tunnelex_ssl_context_cache_misses_total Shared SSL/TLS contexts created." << std::endl;
+		os << "# TYPE tunnelex_ssl_context_cache_misses_total counter" << std::endl;
+		os << "tunnelex_ssl_context_cache_misses_total " << stat.misses << std::endl;
+		os << "# HELP tunnelex_ssl_context_cache_size Shared SSL/TLS contexts in the cache." << std::endl;
+		os << "# TYPE tunnelex_ssl_context_cache_size gauge" << std::endl;
+		os << "tunnelex_ssl_context_cache_size " << stat.size << std::endl;
+	}
+
+	{
+		const HostResolverImpl::Stat stat = HostResolver::instance()->GetStat();
+		os << "# HELP tunnelex_dns_cache_lookups_total Host names resolving requests by result." << std::endl;
+		os << "# TYPE tunnelex_dns_cache_lookups_total counter" << std::endl;
+		os << "tunnelex_dns_cache_lookups_total{result=\"hit\"} " << stat.hits << std::endl;
+		os << "tunnelex_dns_cache_lookups_total{result=\"negative_hit\"} " << stat.negativeHits << std::endl;
+		os << "tunnelex_dns_cache_lookups_total{result=\"stale_hit\"} " << stat.staleHits << std::endl;
+		os << "tunnelex_dns_cache_lookups_total{result=\"miss\"} " << stat.misses << std::endl;
+		os << "# HELP tunnelex_dns_cache_refreshes_total Host names refreshed in the background." << std::endl;
+		os << "# TYPE tunnelex_dns_cache_refreshes_total counter" << std::endl;
+		os << "tunnelex_dns_cache_refreshes_total " << stat.refreshes << std::endl;
+		os << "# HELP tunnelex_dns_cache_size Host names in the cache." << std::endl;
+		os << "# TYPE tunnelex_dns_cache_size gauge" << std::endl;
+		os << "tunnelex_dns_cache_size " << stat.size << std::endl;
+	}
+
+	result += os.str();
+
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,46 @@
+/**************************************************************************
+ *   Created: 2026/10/20 10:14
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__InetMetrics_hpp__2610201014
+#define INCLUDED_FILE__TUNNELEX__InetMetrics_hpp__2610201014
+
+#include "Core/Metrics.hpp"
+
+namespace TunnelEx { namespace Mods { namespace Inet {
+
+	//! Module metrics, registered in the service metrics at module loading.
+	class InetMetricsImpl
+			: public TunnelEx::Singletons::MetricsPolicy::Source,
+			private boost::noncopyable {
+
+	public:
+
+		InetMetricsImpl();
+		virtual ~InetMetricsImpl() throw();
+
+	public:
+
+		//! Registers UDP datagram dropped as the listener send queue is full.
+		void OnUdpSendDrop() throw();
+
+	public:
+
+		virtual void Export(std::string &) const;
+
+	private:
+
+		volatile long long m_udpSendDrops;
+
+	};
+
+	typedef ACE_Singleton<InetMetricsImpl, ACE_Thread_Mutex> InetMetrics;
+
+} } }
+
+#endif // INCLUDED_FILE__TUNNELEX__InetMetrics_hpp__2610201014
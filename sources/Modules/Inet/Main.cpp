@@ -10,6 +10,8 @@
 #include "Prec.h"
 #include "Api.h"
 
+#include "InetMetrics.hpp"
+
 #include "Core/Log.hpp"
 #include "Core/Error.hpp"
 
@@ -27,7 +29,9 @@ BOOL WINAPI DllMain(HINSTANCE, DWORD fdwReason, LPVOID) {
 			return FALSE;
 		}
 		ACE::set_handle_limit();
+		Metrics::GetInstance().RegisterSource(*Mods::Inet::InetMetrics::instance());
 	} else if (fdwReason == DLL_PROCESS_DETACH) {
+		Metrics::GetInstance().UnregisterSource(*Mods::Inet::InetMetrics::instance());
 		const int finiResult = ACE::fini();
 		finiResult;
 		assert(finiResult != -1);
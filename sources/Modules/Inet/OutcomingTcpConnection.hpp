@@ -12,6 +12,7 @@
 #include "TcpConnection.hpp"
 #include "InetEndpointAddress.hpp"
 #include "ConnectionsTraits.hpp"
+#include "SslSessionCache.hpp"
 #include "Core/Endpoint.hpp"
 #include "Core/Exceptions.hpp"
 #include "Core/Error.hpp"
@@ -88,6 +89,7 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			try {
 				SslConnect();
 			} catch (const TunnelEx::LocalException &ex) {
+				ForgetSslSession();
 				WFormat message(L"Failed to create secure (SSL/TLS) connection for %2%: %1%");
 				message % ex.GetWhat() % GetInstanceId();
 				CancelSetup(message.str().c_str());
@@ -133,6 +135,7 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 				SslConnect(messageBlock);
 			} catch (const TunnelEx::LocalException &ex) {
 				StopReadingRemote();
+				ForgetSslSession();
 				WFormat message(L"Failed to create SSL/TLS connection for %2%: %1%");
 				message % ex.GetWhat() % GetInstanceId();
 				CancelSetup(message.str().c_str());
@@ -205,6 +208,13 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 				"Implements SSL connection process (connect or accept).");
 		}
 
+		//! Removes session of the failed handshake from the sessions cache.
+		void ForgetSslSession() {
+			static_assert(
+				false,
+				"Implements SSL connection process (connect or accept).");
+		}
+
 	private:
 
 		void OpenConnection(
@@ -240,6 +250,9 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 	template<>
 	void OutcomingSslTcpConnection<false>::SslConnect() {
+		SslSessionCache::instance()->RestoreClientSession(
+			*GetDataStream().ssl(),
+			GetRuleEndpointAddress()->GetResourceIdentifier());
 		GetDataStream().Connect();
 	}
 	template<>
@@ -255,6 +268,10 @@ namespace TunnelEx { namespace Mods { namespace Inet {
  			|| boost::polymorphic_downcast<const TcpEndpointAddress *>(
  					GetRuleEndpointAddress().Get())
  				->GetRemoteCertificates().GetSize() == 0);
+		SslSessionCache::instance()->SaveClientSession(
+			*GetDataStream().ssl(),
+			GetRuleEndpointAddress()->GetResourceIdentifier());
+		SslSessionCache::instance()->OnHandshakeCompleted(*GetDataStream().ssl());
 		Log::GetInstance().AppendDebug(
 			"SSL/TLS connection for %1% created (connected).",
 			GetInstanceId());
@@ -267,6 +284,13 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 		return address.GetSslClientContext();
 	}
 
+	template<>
+	void OutcomingSslTcpConnection<false>::ForgetSslSession() {
+		SslSessionCache::instance()->OnHandshakeFailed(
+			*GetDataStream().ssl(),
+			GetRuleEndpointAddress()->GetResourceIdentifier());
+	}
+
 	template<>
 	void OutcomingSslTcpConnection<true>::SslConnect() {
 		GetDataStream().Accept();
@@ -286,6 +310,7 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 		assert(
 			SSL_get_peer_certificate(GetDataStream().ssl()) == 0
 			|| SSL_get_verify_result(GetDataStream().ssl()) == X509_V_OK);
+		SslSessionCache::instance()->OnHandshakeCompleted(*GetDataStream().ssl());
 		Log::GetInstance().AppendDebug(
 			"SSL/TLS connection for %1% created (accepted).",
 			GetInstanceId());
@@ -298,6 +323,11 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 		return address.GetSslServerContext();
 	}
 
+	template<>
+	void OutcomingSslTcpConnection<true>::ForgetSslSession() {
+		SslSessionCache::instance()->OnHandshakeFailed(*GetDataStream().ssl());
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 
 } } }
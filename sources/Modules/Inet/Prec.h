@@ -18,6 +18,9 @@
 // adapters info getting
 #include <IPHlpApi.h>
 #pragma comment(lib, "IPHLPAPI.lib")
+// host names resolving with TTL
+#include <WinDNS.h>
+#pragma comment(lib, "Dnsapi.lib")
 #ifdef X509_EXTENSIONS
 #	undef X509_EXTENSIONS
 #endif
@@ -32,6 +35,9 @@
 #include "Constants.h"
 #include "UseUnused.hpp"
 
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
 #include "CompileWarningsAce.h"
 #	include <ace/Init_ACE.h>
 #	include <ace/SOCK_Acceptor.h>
@@ -49,14 +55,17 @@
 #	include <ace/Ping_Socket.h>
 #	include <ace/Guard_T.h>
 #	include <ace/Thread_Mutex.h>
+#	include <ace/Condition_Thread_Mutex.h>
 #	include <ace/Reactor.h>
 #	include <ace/Thread_Manager.h>
 #	include <ace/Truncate.h>
+#	include <ace/Singleton.h>
 #include "CompileWarningsAce.h"
 
 #include "CompileWarningsBoost.h"
 #	include <boost/noncopyable.hpp>
 #	include <boost/shared_ptr.hpp>
+#	include <boost/weak_ptr.hpp>
 #	include <boost/ref.hpp>
 #	include <boost/bind.hpp>
 #	include <boost/function.hpp>
@@ -70,6 +79,12 @@
 #	include <boost/type_traits/is_same.hpp>
 #	include <boost/mpl/assert.hpp>
 #	include <boost/thread.hpp>
+#	include <boost/unordered_map.hpp>
+#	include <boost/array.hpp>
+#	include <boost/multi_index_container.hpp>
+#	include <boost/multi_index/hashed_index.hpp>
+#	include <boost/multi_index/sequenced_index.hpp>
+#	include <boost/multi_index/member.hpp>
 #include "CompileWarningsBoost.h"
 
 #include <numeric>
@@ -77,6 +92,7 @@
 #include <fstream>
 #include <string>
 #include <list>
+#include <deque>
 #include <map>
 #include <set>
 #include <memory>
@@ -0,0 +1,164 @@
+/**************************************************************************
+ *   Created: 2026/10/19 11:52
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "SslContextCache.hpp"
+
+#include "Core/Log.hpp"
+
+using namespace TunnelEx;
+using namespace TunnelEx::Mods::Inet;
+
+//////////////////////////////////////////////////////////////////////////
+
+class SslContextCacheImpl::Implementation : private boost::noncopyable {
+
+public:
+
+	typedef ACE_Thread_Mutex Mutex;
+	typedef ACE_Guard<Mutex> Lock;
+
+	typedef std::wstring Key;
+	typedef boost::unordered_map<Key, boost::weak_ptr<ACE_SSL_Context>>
+		Contexts;
+
+public:
+
+	Implementation()
+			: m_hits(0),
+			m_misses(0) {
+		//...//
+	}
+
+public:
+
+	static Key CreateKey(
+				bool isServer,
+				const SslCertificateId &certificate,
+				const SslCertificateIdCollection &remoteCertificates) {
+		Key result = isServer ? L"server" : L"client";
+		// verification mode
+		result += remoteCertificates.GetSize() > 0 ? L">peer" : L">none";
+		result.push_back(L'>');
+		result += certificate.GetCStr();
+		for (size_t i = 0; i < remoteCertificates.GetSize(); ++i) {
+			result.push_back(L'|');
+			result += remoteCertificates[i].GetCStr();
+		}
+		return result;
+	}
+
+	boost::shared_ptr<ACE_SSL_Context> Get(
+				const Key &key,
+				const ContextFactory &factory) {
+
+		{
+			const Lock lock(m_mutex);
+			const boost::shared_ptr<ACE_SSL_Context> result = Find(key);
+			if (result) {
+				++m_hits;
+				return result;
+			}
+		}
+
+		// Certificates and private key loading is slow, so context is
+		// created without lock, other endpoints could get their contexts
+		// at this time. If the same context has been created by another
+		// thread in parallel - it will be used and new one destroyed
+		// (after lock releasing).
+		const boost::shared_ptr<ACE_SSL_Context> created(factory().release());
+
+		const Lock lock(m_mutex);
+
+		{
+			const boost::shared_ptr<ACE_SSL_Context> result = Find(key);
+			if (result) {
+				++m_hits;
+				return result;
+			}
+		}
+
+		// context creation is rare, so expired records can be removed here
+		for (Contexts::iterator i = m_contexts.begin(); i != m_contexts.end(); ) {
+			if (i->second.expired()) {
+				i = m_contexts.erase(i);
+			} else {
+				++i;
+			}
+		}
+
+		m_contexts[key] = created;
+		++m_misses;
+
+		Log::GetInstance().AppendDebugEx(
+			[this]() -> Format {
+				Format message("Created new shared SSL/TLS context (%1% contexts).");
+				message % m_contexts.size();
+				return message;
+			});
+
+		return created;
+
+	}
+
+	Stat GetStat() const {
+		Stat result;
+		Lock lock(m_mutex);
+		result.hits = m_hits;
+		result.misses = m_misses;
+		result.size = long(m_contexts.size());
+		return result;
+	}
+
+private:
+
+	boost::shared_ptr<ACE_SSL_Context> Find(const Key &key) const {
+		const Contexts::const_iterator pos = m_contexts.find(key);
+		return pos != m_contexts.end()
+			?	pos->second.lock()
+			:	boost::shared_ptr<ACE_SSL_Context>();
+	}
+
+private:
+
+	mutable Mutex m_mutex;
+	Contexts m_contexts;
+
+	long m_hits;
+	long m_misses;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+SslContextCacheImpl::SslContextCacheImpl()
+		: m_pimpl(new Implementation) {
+	//...//
+}
+
+SslContextCacheImpl::~SslContextCacheImpl() throw() {
+	delete m_pimpl;
+}
+
+boost::shared_ptr<ACE_SSL_Context> SslContextCacheImpl::Get(
+			bool isServer,
+			const SslCertificateId &certificate,
+			const SslCertificateIdCollection &remoteCertificates,
+			const ContextFactory &factory) {
+	return m_pimpl->Get(
+		Implementation::CreateKey(isServer, certificate, remoteCertificates),
+		factory);
+}
+
+SslContextCacheImpl::Stat SslContextCacheImpl::GetStat() const throw() {
+	return m_pimpl->GetStat();
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+/**************************************************************************
+ *   Created: 2026/10/19 11:47
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__SslContextCache_hpp__2610191147
+#define INCLUDED_FILE__TUNNELEX__SslContextCache_hpp__2610191147
+
+#include "Core/SslCertificatesStorage.hpp"
+#include "Core/String.hpp"
+
+namespace TunnelEx { namespace Mods { namespace Inet {
+
+	//! Process-wide SSL/TLS contexts cache.
+	/** Contexts are shared by all endpoints with the same local
+	  * certificate, remote (verification) certificates and role, so
+	  * certificates and private key are loaded only once for all rules
+	  * and tunnels. Context must not be changed after creation. Cache
+	  * doesn't own contexts - context will be destroyed with the last
+	  * endpoint which uses it.
+	  */
+	class SslContextCacheImpl : private boost::noncopyable {
+
+	public:
+
+		typedef boost::function<std::auto_ptr<ACE_SSL_Context>(void)>
+			ContextFactory;
+
+		struct Stat {
+			//! Contexts found in the cache.
+			long hits;
+			//! Contexts created.
+			long misses;
+			//! Current number of contexts in the cache.
+			long size;
+		};
+
+	public:
+
+		SslContextCacheImpl();
+		~SslContextCacheImpl() throw();
+
+	public:
+
+		//! Returns shared context or creates new by factory.
+		boost::shared_ptr<ACE_SSL_Context> Get(
+					bool isServer,
+					const TunnelEx::SslCertificateId &certificate,
+					const TunnelEx::SslCertificateIdCollection &remoteCertificates,
+					const ContextFactory &);
+
+		Stat GetStat() const throw();
+
+	private:
+
+		class Implementation;
+		Implementation *m_pimpl;
+
+	};
+
+	typedef ACE_Singleton<SslContextCacheImpl, ACE_Thread_Mutex> SslContextCache;
+
+} } }
+
+#endif // INCLUDED_FILE__TUNNELEX__SslContextCache_hpp__2610191147
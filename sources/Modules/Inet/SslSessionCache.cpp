@@ -0,0 +1,487 @@
+/**************************************************************************
+ *   Created: 2026/10/19 10:24
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "SslSessionCache.hpp"
+
+#include "Core/Locking.hpp"
+#include "Core/Log.hpp"
+#include "Core/Exceptions.hpp"
+
+namespace mi = boost::multi_index;
+using namespace TunnelEx;
+using namespace TunnelEx::Mods::Inet;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//! @todo: hardcoded SSL/TLS sessions cache size
+	const size_t maxSessionsNumber = 20000;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	typedef std::string SessionKey;
+	typedef std::vector<unsigned char> SessionData;
+
+	struct Session {
+		SessionKey key;
+		SessionData data;
+		time_t expirationTime;
+	};
+
+	struct ByKey {
+		//...//
+	};
+	struct ByUsage {
+		//...//
+	};
+
+	typedef boost::multi_index_container<
+			Session,
+			mi::indexed_by<
+				mi::hashed_unique<
+					mi::tag<ByKey>,
+					mi::member<Session, SessionKey, &Session::key> >,
+				mi::sequenced<
+					mi::tag<ByUsage> > > >
+		Sessions;
+	typedef Sessions::index<ByKey>::type SessionByKey;
+	typedef Sessions::index<ByUsage>::type SessionByUsage;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	SessionKey CreateServerSessionKey(
+				const unsigned char *sidCtx,
+				size_t sidCtxLen,
+				const unsigned char *id,
+				size_t idLen) {
+		SessionKey result(reinterpret_cast<const char *>(sidCtx), sidCtxLen);
+		result.append(reinterpret_cast<const char *>(id), idLen);
+		return result;
+	}
+
+	SessionKey CreateClientSessionKey(const SSL &ssl, const WString &remoteEndpoint) {
+		SessionKey result(
+			reinterpret_cast<const char *>(ssl.sid_ctx),
+			ssl.sid_ctx_length);
+		result.push_back('>');
+		result += ConvertString<String>(remoteEndpoint).GetCStr();
+		return result;
+	}
+
+	//! Cache is called by OpenSSL callbacks, so errors can't be thrown.
+	void ReportUnknownError(int line) throw() {
+		Format message(
+			"Unknown system error occurred: %1%:%2%."
+				" Please restart the service"
+				" and contact product support to resolve this issue."
+				" %3% %4%");
+		message
+			% __FILE__ % line
+			% TUNNELEX_NAME % TUNNELEX_BUILD_IDENTITY;
+		Log::GetInstance().AppendFatalError(message.str());
+		assert(false);
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+class SslSessionCacheImpl::Implementation : private boost::noncopyable {
+
+public:
+
+	typedef ACE_Thread_Mutex Mutex;
+	typedef ACE_Guard<Mutex> Lock;
+
+	typedef TunnelEx::SpinMutex RateMutex;
+	typedef TunnelEx::Lock<RateMutex> RateLock;
+
+public:
+
+	Implementation()
+			: m_hits(0),
+			m_misses(0),
+			m_timeouts(0),
+			m_resumedHandshakes(0),
+			m_fullHandshakes(0),
+			m_rateSecond(0),
+			m_currentSecondHandshakes(0),
+			m_lastSecondHandshakes(0) {
+		BOOST_STATIC_ASSERT(sizeof(m_ticketKeys) == 48);
+		if (RAND_bytes(m_ticketKeys, sizeof(m_ticketKeys)) <= 0) {
+			throw SystemException(
+				L"Failed to generate SSL/TLS session ticket keys");
+		}
+	}
+
+public:
+
+	void Attach(
+				SSL_CTX &context,
+				bool isServer,
+				const SslCertificateId &certificate,
+				const SslCertificateIdCollection &remoteCertificates) {
+
+		// Session ID context identifies all contexts with the same
+		// certificates set, so sessions from one of them can be resumed by
+		// others, but not by contexts with other certificates or other
+		// verification rules.
+		{
+			SHA_CTX sha;
+			SHA1_Init(&sha);
+			{
+				// verification mode, as in the contexts cache key
+				const wchar_t *const verificationMode
+					= remoteCertificates.GetSize() > 0 ? L">peer" : L">none";
+				SHA1_Update(
+					&sha,
+					verificationMode,
+					wcslen(verificationMode) * sizeof(wchar_t));
+			}
+			SHA1_Update(
+				&sha,
+				certificate.GetCStr(),
+				certificate.GetLength() * sizeof(wchar_t));
+			for (size_t i = 0; i < remoteCertificates.GetSize(); ++i) {
+				const wchar_t separator = L'\n';
+				SHA1_Update(&sha, &separator, sizeof(separator));
+				SHA1_Update(
+					&sha,
+					remoteCertificates[i].GetCStr(),
+					remoteCertificates[i].GetLength() * sizeof(wchar_t));
+			}
+			unsigned char sidCtx[SHA_DIGEST_LENGTH];
+			SHA1_Final(sidCtx, &sha);
+			BOOST_STATIC_ASSERT(sizeof(sidCtx) <= SSL_MAX_SID_CTX_LENGTH);
+			SSL_CTX_set_session_id_context(&context, sidCtx, sizeof(sidCtx));
+		}
+
+		if (!isServer) {
+			return;
+		}
+
+		SSL_CTX_set_session_cache_mode(
+			&context,
+			SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+		SSL_CTX_sess_set_new_cb(&context, &SslSessionCacheImpl::HandleNewSession);
+		SSL_CTX_sess_set_get_cb(&context, &SslSessionCacheImpl::HandleGetSession);
+		// remove callback is not set: OpenSSL calls it only for sessions from
+		// its internal store, which is turned off, so failed sessions and
+		// flushing are handled by OnHandshakeFailed and Flush
+
+#		ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEYS
+			if (	SSL_CTX_set_tlsext_ticket_keys(
+						&context,
+						m_ticketKeys,
+						sizeof(m_ticketKeys))
+					<= 0) {
+				Log::GetInstance().AppendWarn(
+					"Failed to set SSL/TLS session ticket keys,"
+						" stateless sessions resumption will not work"
+						" between endpoints.");
+			}
+#		endif
+
+	}
+
+	void Store(const SessionKey &key, SSL_SESSION &session) {
+
+		Session record;
+		record.key = key;
+		const int size = i2d_SSL_SESSION(&session, nullptr);
+		if (size <= 0) {
+			return;
+		}
+		record.data.resize(size);
+		unsigned char *data = &record.data[0];
+		i2d_SSL_SESSION(&session, &data);
+		record.expirationTime
+			= SSL_SESSION_get_time(&session) + SSL_SESSION_get_timeout(&session);
+
+		Lock lock(m_mutex);
+		SessionByKey &index = m_sessions.get<ByKey>();
+		const SessionByKey::iterator pos = index.find(key);
+		if (pos != index.end()) {
+			index.replace(pos, record);
+			m_sessions.get<ByUsage>().relocate(
+				m_sessions.get<ByUsage>().end(),
+				m_sessions.project<ByUsage>(pos));
+			return;
+		}
+		m_sessions.get<ByUsage>().push_back(record);
+		while (m_sessions.size() > maxSessionsNumber) {
+			m_sessions.get<ByUsage>().pop_front();
+		}
+
+	}
+
+	SSL_SESSION * Find(const SessionKey &key) {
+
+		SessionData data;
+		{
+			Lock lock(m_mutex);
+			SessionByKey &index = m_sessions.get<ByKey>();
+			const SessionByKey::iterator pos = index.find(key);
+			if (pos == index.end()) {
+				Interlocked::Increment(m_misses);
+				return nullptr;
+			} else if (pos->expirationTime <= time(nullptr)) {
+				index.erase(pos);
+				Interlocked::Increment(m_timeouts);
+				Interlocked::Increment(m_misses);
+				return nullptr;
+			}
+			data = pos->data;
+			m_sessions.get<ByUsage>().relocate(
+				m_sessions.get<ByUsage>().end(),
+				m_sessions.project<ByUsage>(pos));
+		}
+
+		const unsigned char *dataPtr = &data[0];
+		SSL_SESSION *const result = d2i_SSL_SESSION(
+			nullptr,
+			&dataPtr,
+			long(data.size()));
+		if (!result) {
+			Remove(key);
+			Interlocked::Increment(m_misses);
+			return nullptr;
+		}
+
+		Interlocked::Increment(m_hits);
+		return result;
+
+	}
+
+	void Remove(const SessionKey &key) {
+		Lock lock(m_mutex);
+		m_sessions.get<ByKey>().erase(key);
+	}
+
+	//! Removes all sessions with the key prefix.
+	void RemoveAll(const SessionKey &keyPrefix) {
+		Lock lock(m_mutex);
+		SessionByUsage &index = m_sessions.get<ByUsage>();
+		for (SessionByUsage::iterator i = index.begin(); i != index.end(); ) {
+			if (i->key.compare(0, keyPrefix.size(), keyPrefix) == 0) {
+				i = index.erase(i);
+			} else {
+				++i;
+			}
+		}
+	}
+
+	void OnHandshakeCompleted(SSL &ssl) {
+		Interlocked::Increment(
+			SSL_session_reused(&ssl)
+				?	m_resumedHandshakes
+				:	m_fullHandshakes);
+		const time_t now = time(nullptr);
+		RateLock lock(m_rateMutex);
+		if (m_rateSecond != now) {
+			m_lastSecondHandshakes = m_rateSecond + 1 == now
+				?	m_currentSecondHandshakes
+				:	0;
+			m_currentSecondHandshakes = 0;
+			m_rateSecond = now;
+		}
+		++m_currentSecondHandshakes;
+	}
+
+	Stat GetStat() const {
+		Stat result;
+		result.hits = m_hits;
+		result.misses = m_misses;
+		result.timeouts = m_timeouts;
+		result.resumedHandshakes = m_resumedHandshakes;
+		result.fullHandshakes = m_fullHandshakes;
+		{
+			const time_t now = time(nullptr);
+			RateLock lock(m_rateMutex);
+			if (m_rateSecond == now) {
+				result.handshakesPerSecond = m_lastSecondHandshakes;
+			} else if (m_rateSecond + 1 == now) {
+				result.handshakesPerSecond = m_currentSecondHandshakes;
+			} else {
+				result.handshakesPerSecond = 0;
+			}
+		}
+		{
+			Lock lock(m_mutex);
+			result.size = long(m_sessions.size());
+		}
+		return result;
+	}
+
+private:
+
+	mutable Mutex m_mutex;
+	Sessions m_sessions;
+
+	unsigned char m_ticketKeys[48];
+
+	volatile long m_hits;
+	volatile long m_misses;
+	volatile long m_timeouts;
+	volatile long m_resumedHandshakes;
+	volatile long m_fullHandshakes;
+
+	mutable RateMutex m_rateMutex;
+	time_t m_rateSecond;
+	long m_currentSecondHandshakes;
+	long m_lastSecondHandshakes;
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+int SslSessionCacheImpl::HandleNewSession(SSL *ssl, SSL_SESSION *session) {
+	try {
+		SslSessionCache::instance()->m_pimpl->Store(
+			CreateServerSessionKey(
+				ssl->sid_ctx,
+				ssl->sid_ctx_length,
+				session->session_id,
+				session->session_id_length),
+			*session);
+	} catch (...) {
+		ReportUnknownError(__LINE__);
+	}
+	// session is not referenced by the cache
+	return 0;
+}
+
+SSL_SESSION * SslSessionCacheImpl::HandleGetSession(
+			SSL *ssl,
+			unsigned char *id,
+			int idLen,
+			int *copy) {
+	*copy = 0;
+	try {
+		return SslSessionCache::instance()->m_pimpl->Find(
+			CreateServerSessionKey(
+				ssl->sid_ctx,
+				ssl->sid_ctx_length,
+				id,
+				idLen));
+	} catch (...) {
+		ReportUnknownError(__LINE__);
+		return nullptr;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+SslSessionCacheImpl::SslSessionCacheImpl()
+		: m_pimpl(new Implementation) {
+	//...//
+}
+
+SslSessionCacheImpl::~SslSessionCacheImpl() throw() {
+	delete m_pimpl;
+}
+
+void SslSessionCacheImpl::Attach(
+			SSL_CTX &context,
+			bool isServer,
+			const SslCertificateId &certificate,
+			const SslCertificateIdCollection &remoteCertificates) {
+	m_pimpl->Attach(context, isServer, certificate, remoteCertificates);
+}
+
+bool SslSessionCacheImpl::RestoreClientSession(
+			SSL &ssl,
+			const WString &remoteEndpoint)
+		throw() {
+	try {
+		SSL_SESSION *const session
+			= m_pimpl->Find(CreateClientSessionKey(ssl, remoteEndpoint));
+		if (!session) {
+			return false;
+		}
+		const bool result = SSL_set_session(&ssl, session) == 1;
+		SSL_SESSION_free(session);
+		return result;
+	} catch (...) {
+		ReportUnknownError(__LINE__);
+		return false;
+	}
+}
+
+void SslSessionCacheImpl::SaveClientSession(
+			const SSL &ssl,
+			const WString &remoteEndpoint)
+		throw() {
+	try {
+		SSL_SESSION *const session = SSL_get_session(&ssl);
+		if (!session) {
+			return;
+		}
+		m_pimpl->Store(CreateClientSessionKey(ssl, remoteEndpoint), *session);
+	} catch (...) {
+		ReportUnknownError(__LINE__);
+	}
+}
+
+void SslSessionCacheImpl::OnHandshakeCompleted(SSL &ssl) throw() {
+	m_pimpl->OnHandshakeCompleted(ssl);
+}
+
+void SslSessionCacheImpl::OnHandshakeFailed(const SSL &ssl) throw() {
+	try {
+		const SSL_SESSION *const session = SSL_get_session(&ssl);
+		if (!session || !session->session_id_length) {
+			return;
+		}
+		m_pimpl->Remove(
+			CreateServerSessionKey(
+				ssl.sid_ctx,
+				ssl.sid_ctx_length,
+				session->session_id,
+				session->session_id_length));
+	} catch (...) {
+		ReportUnknownError(__LINE__);
+	}
+}
+
+void SslSessionCacheImpl::OnHandshakeFailed(
+			const SSL &ssl,
+			const WString &remoteEndpoint)
+		throw() {
+	try {
+		m_pimpl->Remove(CreateClientSessionKey(ssl, remoteEndpoint));
+	} catch (...) {
+		ReportUnknownError(__LINE__);
+	}
+}
+
+void SslSessionCacheImpl::Flush(SSL_CTX &context) throw() {
+	// contexts, which are not attached, use internal store
+	SSL_CTX_flush_sessions(&context, 0);
+	if (!context.sid_ctx_length) {
+		return;
+	}
+	try {
+		m_pimpl->RemoveAll(
+			SessionKey(
+				reinterpret_cast<const char *>(context.sid_ctx),
+				context.sid_ctx_length));
+	} catch (...) {
+		ReportUnknownError(__LINE__);
+	}
+}
+
+SslSessionCacheImpl::Stat SslSessionCacheImpl::GetStat() const throw() {
+	return m_pimpl->GetStat();
+}
+
+//////////////////////////////////////////////////////////////////////////
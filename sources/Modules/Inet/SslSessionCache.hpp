@@ -0,0 +1,105 @@
+/**************************************************************************
+ *   Created: 2026/10/19 10:12
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__SslSessionCache_hpp__2610191012
+#define INCLUDED_FILE__TUNNELEX__SslSessionCache_hpp__2610191012
+
+#include "Core/SslCertificatesStorage.hpp"
+#include "Core/String.hpp"
+
+namespace TunnelEx { namespace Mods { namespace Inet {
+
+	//! Process-wide SSL/TLS sessions cache.
+	/** Sessions are shared between all SSL/TLS contexts with the same
+	  * certificates set, so clients can resume sessions after the rule
+	  * reloading, context recreation or connection to other rule with
+	  * the same certificates. Server-side sessions stored by session ID
+	  * and also can be resumed by stateless session tickets, client-side
+	  * sessions stored by remote endpoint resource identifier.
+	  */
+	class SslSessionCacheImpl : private boost::noncopyable {
+
+	public:
+
+		struct Stat {
+			//! Sessions found in the cache.
+			long hits;
+			//! Sessions not found in the cache (or expired).
+			long misses;
+			//! Expired sessions which were removed at lookup.
+			long timeouts;
+			//! Current number of sessions in the cache.
+			long size;
+			//! Handshakes completed with session resumption (by ID or ticket).
+			long resumedHandshakes;
+			//! Handshakes completed without session resumption.
+			long fullHandshakes;
+			//! Handshakes (full and resumed) completed during the last second.
+			long handshakesPerSecond;
+		};
+
+	public:
+
+		SslSessionCacheImpl();
+		~SslSessionCacheImpl() throw();
+
+	public:
+
+		//! Attaches context to the cache.
+		/** Context will share sessions with all other contexts with the same
+		  * local certificate and remote certificates.
+		  */
+		void Attach(
+					SSL_CTX &,
+					bool isServer,
+					const TunnelEx::SslCertificateId &certificate,
+					const TunnelEx::SslCertificateIdCollection &remoteCertificates);
+
+		//! Sets cached client-side session for remote endpoint, if it exists.
+		/** @return true if session was found and set
+		  */
+		bool RestoreClientSession(SSL &, const TunnelEx::WString &remoteEndpoint)
+			throw();
+		//! Stores client-side session for remote endpoint.
+		void SaveClientSession(const SSL &, const TunnelEx::WString &remoteEndpoint)
+			throw();
+
+		//! Registers completed handshake for resumption statistics.
+		void OnHandshakeCompleted(SSL &) throw();
+		//! Removes server-side session of the failed handshake.
+		void OnHandshakeFailed(const SSL &) throw();
+		//! Removes client-side session for remote endpoint after failed handshake.
+		void OnHandshakeFailed(const SSL &, const TunnelEx::WString &remoteEndpoint)
+			throw();
+
+		//! Removes all sessions of the context.
+		/** Sessions are stored out of OpenSSL, so SSL_CTX_flush_sessions
+		  * doesn't remove them.
+		  */
+		void Flush(SSL_CTX &) throw();
+
+		Stat GetStat() const throw();
+
+	private:
+
+		static int HandleNewSession(SSL *, SSL_SESSION *);
+		static SSL_SESSION * HandleGetSession(SSL *, unsigned char *, int, int *);
+
+	private:
+
+		class Implementation;
+		Implementation *m_pimpl;
+
+	};
+
+	typedef ACE_Singleton<SslSessionCacheImpl, ACE_Thread_Mutex> SslSessionCache;
+
+} } }
+
+#endif // INCLUDED_FILE__TUNNELEX__SslSessionCache_hpp__2610191012
@@ -137,18 +137,39 @@ std::wstring SslSockStream::Exception::GetLastError() {
 		return L"protocol error";
 	} else {
 		WFormat message(L"%1% (%2%)");
+		const wchar_t *const accessDeniedNoCertMessage
+			= L"access denied, remote certificate does not presented";
+		const wchar_t *const accessDeniedWronCertMessage
+			= L"access denied, remote certificate does not allowed";
 		if (sysError.IsError() || openSslError.GetErrorsNumb() == 0) {
 			if (openSslError.GetErrorsNumb() > 0) {
 				Log::GetInstance().AppendDebug(openSslError.GetAsString());
 			}
-			if (	!sysError.CheckError()
-					&& openSslError.CheckError(sysError.GetErrorNo())) {
-				const std::string errorStr
-					= OpenSslError::ErrorNoToString(sysError.GetErrorNo());
-				message % ConvertString<WString>(errorStr.c_str()).GetCStr();
+			if (!sysError.CheckError()) {
+				switch (ERR_GET_REASON(sysError.GetErrorNo())) {
+					case SSL_R_PEER_DID_NOT_RETURN_A_CERTIFICATE:
+						message % accessDeniedNoCertMessage;
+						break;
+					case SSL_R_NO_CERTIFICATE_RETURNED:
+						message % accessDeniedWronCertMessage;
+						break;
+					default:
+						if (openSslError.CheckError(sysError.GetErrorNo())) {
+							const std::string errorStr
+								= OpenSslError::ErrorNoToString(sysError.GetErrorNo());
+							message % ConvertString<WString>(errorStr.c_str()).GetCStr();
+						} else {
+							message % sysError.GetStringW();
+						}
+						break;
+				}
 			} else {
 				message % sysError.GetStringW();
 			}
+		} else if (openSslError.IsReason(SSL_R_PEER_DID_NOT_RETURN_A_CERTIFICATE)) {
+			message % accessDeniedNoCertMessage;
+		} else if (openSslError.IsReason(SSL_R_NO_CERTIFICATE_RETURNED)) {
+			message % accessDeniedWronCertMessage;
 		} else {
 			message % ConvertString<WString>(openSslError.GetAsString());
 		}
@@ -190,7 +211,10 @@ SslSockStream::SslSockStream(const ACE_SSL_Context &context)
 		m_isDecryptorEncryptorMode(false),
 		m_biorOrig(0),
 		m_biowOrig(0) {
-	//...//
+	m_buffers.encryptedMessage = nullptr;
+	m_buffers.encryptedMessageReadPos = 0;
+	m_buffers.outMessage = nullptr;
+	m_buffers.outMessageSpace = 0;
 }
 
 SslSockStream::~SslSockStream() throw() {
@@ -291,24 +315,47 @@ void SslSockStream::SwitchToStreamMode() throw() {
 
 }
 
-void SslSockStream::Decrypt(const MessageBlock &messageBlock) const {
+void SslSockStream::Decrypt(
+			const MessageBlock &encrypted,
+			MessageBlock &decrypted,
+			size_t decryptedSpace)
+		const {
 
 	assert(m_buffers.out.size() == 0);
 	assert(IsDecryptorEncryptorMode());
+	assert(!m_buffers.outMessage);
 
-	m_buffers.encryptedMessage = &messageBlock;
+	m_buffers.encryptedMessage = &encrypted;
 	m_buffers.encryptedMessageReadPos = 0;
-	m_buffers.decryptionSub.resize(messageBlock.GetUnreadedDataSize());
 	m_buffers.decryptionFull.resize(0);
 
+	size_t overflowSize = 0;
+
 	for ( ; ; ) {
-		const ssize_t receviedBytes
-			= recv(&m_buffers.decryptionSub[0], m_buffers.decryptionSub.size());
+		
+		// Decryption goes directly into the message block memory, internal
+		// buffer used only if data doesn't fit into the block (for ex.,
+		// if SSL-compression is on).
+		char *buffer;
+		size_t bufferSize;
+		if (decryptedSpace > 0) {
+			bufferSize = decryptedSpace;
+			buffer = decrypted.GetWritableSpace(bufferSize);
+		} else {
+			bufferSize = std::max(
+				encrypted.GetUnreadedDataSize(),
+				size_t(SSL3_RT_MAX_PLAIN_LENGTH));
+			m_buffers.decryptionFull.resize(overflowSize + bufferSize);
+			buffer = &m_buffers.decryptionFull[overflowSize];
+		}
+		
+		const ssize_t receviedBytes = recv(buffer, bufferSize);
 		if (receviedBytes == -1) {
 			const Error error(errno);
 			if (error.GetErrorNo() == EWOULDBLOCK) {
 				break;
 			}
+			m_buffers.decryptionFull.resize(0);
 			m_buffers.out.resize(0);
 			WFormat message(L"Failed to decrypt SSL data: \"%1% (%2%)\"");
 			if (!error.CheckError() && OpenSslError::CheckError(error.GetErrorNo())) {
@@ -321,41 +368,52 @@ void SslSockStream::Decrypt(const MessageBlock &messageBlock) const {
 			message % error.GetErrorNo();
 			throw SystemException(message.str().c_str());
 		} else if (receviedBytes > 0) {
-			const auto oldSize = m_buffers.decryptionFull.size();
-			m_buffers.decryptionFull.resize(oldSize + receviedBytes);
-			copy(
-				m_buffers.decryptionSub.begin(),
-				m_buffers.decryptionSub.begin() + receviedBytes,
-				m_buffers.decryptionFull.begin() + oldSize);
+			assert(size_t(receviedBytes) <= bufferSize);
+			if (decryptedSpace > 0) {
+				decrypted.TakeWritableSpace(receviedBytes);
+				decryptedSpace -= receviedBytes;
+			} else {
+				overflowSize += receviedBytes;
+			}
 		} else {
 			break;
 		}
+
 	}
 
+	m_buffers.decryptionFull.resize(overflowSize);
+
 	assert(
 		m_buffers.encryptedMessage->GetUnreadedDataSize()
 		== m_buffers.encryptedMessageReadPos);
 
 }
 
-void SslSockStream::Encrypt(const MessageBlock &messageBlock) const {
+void SslSockStream::Encrypt(
+			const MessageBlock &source,
+			MessageBlock &encrypted,
+			size_t encryptedSpace)
+		const {
 
-	assert(messageBlock.GetUnreadedDataSize() > 0);
+	assert(source.GetUnreadedDataSize() > 0);
 	assert(IsDecryptorEncryptorMode());
 
 	m_buffers.out.resize(0);
+	m_buffers.outMessage = &encrypted;
+	m_buffers.outMessageSpace = encryptedSpace;
 	ssize_t sendPos = 0;
 
 	for ( ; ; ) {
-		const ssize_t bytesToSend = messageBlock.GetUnreadedDataSize() - sendPos;
+		const ssize_t bytesToSend = source.GetUnreadedDataSize() - sendPos;
 		const ssize_t sentBytes
-			= send(messageBlock.GetData() + sendPos, bytesToSend);
+			= send(source.GetData() + sendPos, bytesToSend);
 		if (sentBytes == -1) {
 			const Error error(errno);
 			assert(error.GetErrorNo() != EWOULDBLOCK);
 			if (error.GetErrorNo() == EWOULDBLOCK) {
 				break;
 			}
+			m_buffers.outMessage = nullptr;
 			m_buffers.out.resize(0);
 			WFormat message(L"Error at SSL data sending: \"%1% (%2%)\"");
 			if (!error.CheckError() && OpenSslError::CheckError(error.GetErrorNo())) {
@@ -374,14 +432,28 @@ void SslSockStream::Encrypt(const MessageBlock &messageBlock) const {
 		}
 	}
 
+	m_buffers.outMessage = nullptr;
+
 }
 
 int SslSockStream::BioWrite(const char *buf, size_t len, int &errVal) {
 	assert(IsDecryptorEncryptorMode());
 	assert(len > 0);
 	try {
-		m_buffers.out.reserve(m_buffers.out.size() + len);
-		copy(buf, buf + len, back_inserter(m_buffers.out));
+		size_t outMessageLen = 0;
+		if (m_buffers.outMessage && m_buffers.outMessageSpace > 0) {
+			outMessageLen = std::min(len, m_buffers.outMessageSpace);
+			ACE_OS::memcpy(
+				m_buffers.outMessage->GetWritableSpace(outMessageLen),
+				buf,
+				outMessageLen);
+			m_buffers.outMessage->TakeWritableSpace(outMessageLen);
+			m_buffers.outMessageSpace -= outMessageLen;
+		}
+		if (outMessageLen < len) {
+			m_buffers.out.reserve(m_buffers.out.size() + len - outMessageLen);
+			copy(buf + outMessageLen, buf + len, back_inserter(m_buffers.out));
+		}
 		errVal = 0; // Ok, go ahead
 		return ACE_Utils::truncate_cast<int>(len);
 	} catch (const std::exception &ex) {
@@ -44,8 +44,9 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 		struct BufferSet {
 			const MessageBlock *encryptedMessage;
 			size_t encryptedMessageReadPos;
-			Buffer decryptionSub;
 			Buffer decryptionFull;
+			MessageBlock *outMessage;
+			size_t outMessageSpace;
 			Buffer out;
 		};
 
@@ -86,13 +87,32 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			return m_isDecryptorEncryptorMode;
 		}
 
-		void Decrypt(const MessageBlock &) const;
-		void Encrypt(const MessageBlock &) const;
-
+		//! Decrypts data directly into the message block memory.
+		/** Decrypted data, which doesn't fit into the given space of the
+		  * decrypted-block, will be stored in the internal buffer (see
+		  * GetDecrypted). */
+		void Decrypt(
+					const MessageBlock &encrypted,
+					MessageBlock &decrypted,
+					size_t decryptedSpace)
+				const;
+		//! Encrypts data directly into the message block memory.
+		/** Encrypted data, which doesn't fit into the given space of the
+		  * encrypted-block, and also data which should be sent to the
+		  * remote side at decryption or handshake, will be stored in the
+		  * internal buffer (see GetEncrypted). */
+		void Encrypt(
+					const MessageBlock &source,
+					MessageBlock &encrypted,
+					size_t encryptedSpace)
+				const;
+
+		//! Returns decrypted data which doesn't fit into the decrypted-block.
 		const Buffer & GetDecrypted() const {
 			return m_buffers.decryptionFull;
 		}
 
+		//! Returns encrypted data which doesn't fit into the encrypted-block.
 		const Buffer & GetEncrypted() const {
 			return m_buffers.out;
 		}
@@ -114,6 +114,24 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			return const_cast<TcpConnection *>(this)->GetDataStream();
 		}
 
+		//! Creates new message block with data from the block and buffer.
+		AutoPtr<MessageBlock> JoinMessageBlock(
+					const MessageBlock &head,
+					const std::vector<char> &tail)
+				const {
+			assert(!tail.empty());
+			const size_t size = head.GetUnreadedDataSize() + tail.size();
+			AutoPtr<MessageBlock> result = CreateMessageBlock(size);
+			char *const buffer = result->GetWritableSpace(size);
+			ACE_OS::memcpy(buffer, head.GetData(), head.GetUnreadedDataSize());
+			ACE_OS::memcpy(
+				buffer + head.GetUnreadedDataSize(),
+				&tail[0],
+				tail.size());
+			result->TakeWritableSpace(size);
+			return result;
+		}
+
 		void CloseDataStream() throw() {
 			static_assert(
 				boost::is_same<Stream, ACE_SOCK_Stream>::value,
@@ -155,7 +173,14 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			return;
 		}
 		
-		GetDataStream().Decrypt(messageBlock);
+		// Plain data is smaller than encrypted data if SSL-record is not
+		// split between message blocks and SSL-compression is not used, for
+		// other cases stream buffers the rest.
+		const size_t decryptedSpace = messageBlock.GetUnreadedDataSize();
+		AutoPtr<MessageBlock> messageBlockDecrypted
+			= CreateMessageBlock(decryptedSpace);
+		GetDataStream().Decrypt(messageBlock, *messageBlockDecrypted, decryptedSpace);
+		messageBlock.Read();
 
 		AutoPtr<MessageBlock> messageBlockEncrypted;
 		if (!GetDataStream().GetEncrypted().empty()) {
@@ -170,19 +195,10 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 				&GetDataStream().GetEncrypted()[0]);
 		}
 
-		AutoPtr<MessageBlock> messageBlockDecrypted;
-		MessageBlock *messageBlockToSend = &messageBlock;
-		if (GetDataStream().GetDecrypted().size() > messageBlock.GetBlockSize()) {
-			messageBlockDecrypted = CreateMessageBlock(
-				GetDataStream().GetDecrypted().size(),
-				&GetDataStream().GetDecrypted()[0]);
-			messageBlockToSend = messageBlockDecrypted.Get();
-		} else if (!GetDataStream().GetDecrypted().empty()) {
-			messageBlock.SetData(
-				&GetDataStream().GetDecrypted()[0],
-				GetDataStream().GetDecrypted().size());
-		} else {
-			messageBlock.Read();
+		if (!GetDataStream().GetDecrypted().empty()) {
+			messageBlockDecrypted = JoinMessageBlock(
+				*messageBlockDecrypted,
+				GetDataStream().GetDecrypted());
 		}
 
 		streamLock.unlock();
@@ -190,7 +206,10 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 		if (messageBlockEncrypted) {
 			WriteDirectly(*messageBlockEncrypted);
 		}
-		Base::ReadRemote(*messageBlockToSend);
+		Base::ReadRemote(
+			messageBlockDecrypted->GetUnreadedDataSize() > 0
+				?	*messageBlockDecrypted
+				:	messageBlock);
 
 	}
 
@@ -205,10 +224,14 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			return Base::Write(messageBlock);
 		}
 
-		GetDataStream().Encrypt(messageBlock);
+		const size_t plainSize = messageBlock.GetUnreadedDataSize();
+		const size_t encryptedSpace
+			= plainSize
+				+ (plainSize / SSL3_RT_MAX_PLAIN_LENGTH + 1)
+					* (SSL3_RT_HEADER_LENGTH + SSL3_RT_MAX_ENCRYPTED_OVERHEAD);
+		AutoPtr<MessageBlock> messageBlockEncrypted
+			= CreateMessageBlock(encryptedSpace);
 		
-		AutoPtr<MessageBlock> messageBlockEncrypted;
-		MessageBlock *messageBlockToSend = &messageBlock;
 		{
 			auto cleanFunc = [&streamLock](Stream *stream) {
 				stream->ClearEncrypted();
@@ -217,23 +240,19 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			std::unique_ptr<Stream, decltype(cleanFunc)> cleaner(
 				&GetDataStream(),
 				cleanFunc);
-			if (GetDataStream().GetEncrypted().size() <= messageBlock.GetBlockSize()) {
-				if (GetDataStream().GetEncrypted().empty()) {
-					messageBlock.Read();
-				} else {
-					messageBlock.SetData(
-						&GetDataStream().GetEncrypted()[0],
-						GetDataStream().GetEncrypted().size());
-				}
-			} else {
-				messageBlockEncrypted = CreateMessageBlock(
-					GetDataStream().GetEncrypted().size(),
-					&GetDataStream().GetEncrypted()[0]);
-				messageBlockToSend = messageBlockEncrypted.Get();
+			GetDataStream().Encrypt(messageBlock, *messageBlockEncrypted, encryptedSpace);
+			if (!GetDataStream().GetEncrypted().empty()) {
+				messageBlockEncrypted = JoinMessageBlock(
+					*messageBlockEncrypted,
+					GetDataStream().GetEncrypted());
 			}
 		}
+		messageBlock.Read();
 
-		return Base::Write(*messageBlockToSend);
+		return Base::Write(
+			messageBlockEncrypted->GetUnreadedDataSize() > 0
+				?	*messageBlockEncrypted
+				:	messageBlock);
 
 	}
 
@@ -15,7 +15,7 @@
 #include "ConnectionsTraits.hpp"
 #include "TcpConnectionAcceptor.hpp"
 #include "InetEndpointAddress.hpp"
-#include "IncomingTcpSslClientConnection.hpp"
+#include "IncomingSslTcpConnection.hpp"
 #include "Core/Acceptor.hpp"
 #include "Core/Exceptions.hpp"
 #include "Core/Log.hpp"
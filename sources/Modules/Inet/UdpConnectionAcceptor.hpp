@@ -13,12 +13,14 @@
 #include "Api.h"
 #include "IncomingUdpConnection.hpp"
 #include "UdpConnectionAcceptor.hpp"
+#include "UdpSendQueue.hpp"
 #include "InetEndpointAddress.hpp"
 #include "AceSockDgramCloser.h"
 #include "Core/Acceptor.hpp"
 #include "Core/Exceptions.hpp"
 #include "Core/Log.hpp"
 #include "Core/Error.hpp"
+#include "Core/Locking.hpp"
 
 namespace TunnelEx { namespace Mods { namespace Inet {
 
@@ -36,10 +38,47 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 
 	private:
 
-		typedef ACE_Thread_Mutex DataConnectionMutex;
-		typedef ACE_Guard<DataConnectionMutex> DataConnectionLock;
+		typedef TunnelEx::ReadWriteSpinMutex DataConnectionMutex;
+		typedef TunnelEx::ReadLock<DataConnectionMutex> DataConnectionReadLock;
+		typedef TunnelEx::WriteLock<DataConnectionMutex> DataConnectionWriteLock;
 
-		typedef std::map<ACE_INET_Addr, Connection *> Connections;
+		struct AddressHash {
+			size_t operator ()(const ACE_INET_Addr &address) const {
+				return address.hash();
+			}
+		};
+
+		//! Session reference, lets send data without bucket lock.
+		/** The session sends data to the tunnel only under the reference
+		  * mutex, the mutex is recursive as the session could be closed
+		  * by the same thread at sending. */
+		struct DataConnectionRef : private boost::noncopyable {
+			explicit DataConnectionRef(Connection *connection)
+					: connection(connection) {
+				//...//
+			}
+			RecursiveMutex mutex;
+			Connection *connection;
+		};
+
+		typedef boost::unordered_map<
+				ACE_INET_Addr,
+				boost::shared_ptr<DataConnectionRef>,
+				AddressHash>
+			Connections;
+
+		//! Sessions bucket.
+		/** Sessions are spread between buckets by remote address hash, so
+		  * the lookup for each incoming datagram takes only read-lock for one
+		  * small table and doesn't wait for sessions opening or closing in
+		  * other buckets. */
+		struct DataConnectionsBucket {
+			DataConnectionMutex mutex;
+			Connections connections;
+		};
+
+		//! @todo: hardcoded sessions buckets number
+		typedef boost::array<DataConnectionsBucket, 64> DataConnections;
 
 	public:
 
@@ -48,7 +87,13 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 					const TunnelEx::RuleEndpoint &ruleEndpoint,
 					SharedPtr<const EndpointAddress> ruleEndpointAddress)
 				: Base(ruleEndpoint, ruleEndpointAddress),
-				m_socket(new ACE_SOCK_Dgram, &AceSockDgramCloser) {
+				m_socket(new ACE_SOCK_Dgram, &AceSockDgramCloser),
+				//! @todo: hardcoded UDP listener send queue size
+				m_sendQueue(new UdpSendQueue(4 * 1024 * 1024)),
+				//! @todo: hardcoded max UDP datagram size
+				m_receiveBuffer(64 * 1024),
+				//! @todo: hardcoded max datagrams number per one reactor event
+				m_receiveBatchSize(64) {
 
 			const ACE_INET_Addr &inetAddr = address.GetAceInetAddr();
 			if (inetAddr.is_any() && inetAddr.get_port_number() == 0) {
@@ -65,20 +110,63 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 				throw ConnectionOpeningException(exception.str().c_str());
 			}
 
+			if (m_socket->enable(ACE_NONBLOCK) != 0) {
+				const Error error(errno);
+				WFormat exception(L"Failed to switch UDP listener to non-blocking mode: %1% (%2%)");
+				exception % error.GetStringW() % error.GetErrorNo();
+				throw ConnectionOpeningException(exception.str().c_str());
+			}
+
+			// All incoming sessions send through this socket, so default system
+			// send buffer is too small for it.
+			//! @todo: hardcoded UDP listener send buffer size
+			int sendBufferSize = 1024 * 1024;
+			if (	m_socket->set_option(
+						SOL_SOCKET,
+						SO_SNDBUF,
+						&sendBufferSize,
+						sizeof(sendBufferSize))
+					!= 0) {
+				const Error error(errno);
+				Log::GetInstance().AppendWarn(
+					(Format("Failed to set UDP listener send buffer size: %1% (%2%).")
+							% error.GetStringA()
+							% error.GetErrorNo())
+						.str());
+			}
+
 		}
 
 		virtual ~UdpConnectionAcceptor() throw() {
-			foreach (auto connection, m_dataConnections) {
-				connection.second->NotifyAcceptorClose(*this);
+			foreach (auto &bucket, m_dataConnections) {
+				foreach (auto connection, bucket.connections) {
+					RecursiveLock lock(connection.second->mutex);
+					if (connection.second->connection) {
+						connection.second->connection->NotifyAcceptorClose(*this);
+					}
+				}
 			}
 		}
 
 	public:
 
 		void NotifyConnectionClose(const Connection &connection) {
-			DataConnectionLock lock(m_dataConnectionMutex);
-			assert(m_dataConnections.find(connection.GetRemoteAceAddress()) != m_dataConnections.end());
-			m_dataConnections.erase(connection.GetRemoteAceAddress());
+			boost::shared_ptr<DataConnectionRef> ref;
+			{
+				DataConnectionsBucket &bucket
+					= GetDataConnectionsBucket(connection.GetRemoteAceAddress());
+				DataConnectionWriteLock lock(bucket.mutex);
+				const auto pos
+					= bucket.connections.find(connection.GetRemoteAceAddress());
+				assert(pos != bucket.connections.end());
+				ref = pos->second;
+				bucket.connections.erase(pos);
+			}
+			// waits for data sending by other thread, bucket is unlocked, so
+			// the sending could close other sessions from the same bucket
+			RecursiveLock lock(ref->mutex);
+			assert(ref->connection == &connection);
+			ref->connection = nullptr;
 		}
 
 	public:
@@ -97,13 +185,20 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 					GetRuleEndpoint(),
 					GetRuleEndpointAddress(),
 					m_socket,
+					m_sendQueue,
 					m_dataConnectionIncomingBuffer,
 					this));
 
 			{
-				DataConnectionLock lock(m_dataConnectionMutex);
-				assert(m_dataConnections.find(m_senderAddrCache) == m_dataConnections.end());
-				m_dataConnections.insert(std::make_pair(m_senderAddrCache, result.Get()));
+				DataConnectionsBucket &bucket
+					= GetDataConnectionsBucket(m_senderAddrCache);
+				DataConnectionWriteLock lock(bucket.mutex);
+				assert(bucket.connections.find(m_senderAddrCache) == bucket.connections.end());
+				bucket.connections.insert(
+					std::make_pair(
+						m_senderAddrCache,
+						boost::shared_ptr<DataConnectionRef>(
+							new DataConnectionRef(result.Get()))));
 			}
 			
 			return result;
@@ -113,48 +208,67 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 		virtual bool TryToAttach() {
 
 			assert(!m_dataConnectionIncomingBuffer);
-			int dataLen;
-			if (	ACE_OS::ioctl(m_socket->get_handle(), FIONREAD, &dataLen) == -1
-					|| dataLen <= 0) {
-				const Error error(errno);
-				WFormat exception(L"Failed to get incoming UDP data size: %1% (%2%)");
-				exception % error.GetStringW() % error.GetErrorNo();
-				throw ConnectionOpeningException(exception.str().c_str());
-			}
 
-			AutoPtr<MessageBlock> messageBlock(CreateMessageBlock(dataLen));
-			const ssize_t readResult = m_socket->recv(
-				messageBlock->GetWritableSpace(dataLen),
-				dataLen,
-				m_senderAddrCache);
-			if (readResult == -1) {
-				const Error error(errno);
-				if (error.GetErrorNo() == ECONNRESET) {
-					return true;
+			// Reactor signals only about the first datagram, but the socket
+			// queue often already has more, so all available datagrams are
+			// drained here without waiting for the next event and without
+			// FIONREAD-request for each datagram size.
+			for (size_t i = 0; i < m_receiveBatchSize; ++i) {
+
+				const ssize_t readResult = m_socket->recv(
+					&m_receiveBuffer[0],
+					m_receiveBuffer.size(),
+					m_senderAddrCache);
+				if (readResult == -1) {
+					const Error error(errno);
+					if (error.GetErrorNo() == EWOULDBLOCK) {
+						break;
+					} else if (error.GetErrorNo() == ECONNRESET) {
+						continue;
+					}
+					WFormat exception(L"Failed to read incoming UDP data: %1% (%2%)");
+					exception % error.GetStringW() % error.GetErrorNo();
+					throw ConnectionOpeningException(exception.str().c_str());
+				} else if (readResult == 0) {
+					continue;
 				}
-				WFormat exception(L"Failed to read incoming UDP data: %1% (%2%)");
-				exception % error.GetStringW() % error.GetErrorNo();
-				throw ConnectionOpeningException(exception.str().c_str());
-			} else if (readResult == 0) {
-				assert(false); // just want to see when it happens
-				return true;
-			}
-			assert(readResult <= ssize_t(dataLen));
-			messageBlock->TakeWritableSpace(readResult);
-
-			DataConnectionLock lock(m_dataConnectionMutex);
-			const auto connection = m_dataConnections.find(m_senderAddrCache);
-			if (connection == m_dataConnections.end()) {
-				m_dataConnectionIncomingBuffer = messageBlock;
-				return false;
+				assert(size_t(readResult) <= m_receiveBuffer.size());
+
+				AutoPtr<MessageBlock> messageBlock(
+					CreateMessageBlock(readResult, &m_receiveBuffer[0]));
+
+				boost::shared_ptr<DataConnectionRef> ref;
+				{
+					DataConnectionsBucket &bucket
+						= GetDataConnectionsBucket(m_senderAddrCache);
+					DataConnectionReadLock lock(bucket.mutex);
+					const auto pos = bucket.connections.find(m_senderAddrCache);
+					if (pos != bucket.connections.end()) {
+						ref = pos->second;
+					}
+				}
+				if (!ref) {
+					m_dataConnectionIncomingBuffer = messageBlock;
+					return false;
+				}
+
+				// Bucket lock is not held here as sending could close
+				// the session and closing takes bucket write lock.
+				RecursiveLock lock(ref->mutex);
+				if (ref->connection) {
+					ref->connection->SendToTunnel(*messageBlock);
+				}
+
 			}
-			
-			connection->second->SendToTunnel(*messageBlock);
 
 			return true;
 
 		}
 
+		virtual void HandleOutput() {
+			m_sendQueue->Flush(*m_socket);
+		}
+
 		virtual AutoPtr<EndpointAddress> GetLocalAddress() const {
 			ACE_INET_Addr addr;
 			if (m_socket->get_local_addr(addr) != 0) {
@@ -166,14 +280,24 @@ namespace TunnelEx { namespace Mods { namespace Inet {
 			return AutoPtr<EndpointAddress>(new UdpEndpointAddress(addr));
 		}
 
+	private:
+
+		DataConnectionsBucket & GetDataConnectionsBucket(
+					const ACE_INET_Addr &address) {
+			return m_dataConnections[AddressHash()(address) % m_dataConnections.size()];
+		}
+
 	private:
 
 		boost::shared_ptr<Stream> m_socket;
+		boost::shared_ptr<UdpSendQueue> m_sendQueue;
+
+		std::vector<char> m_receiveBuffer;
+		const size_t m_receiveBatchSize;
 
-		DataConnectionMutex m_dataConnectionMutex;
 		ACE_INET_Addr m_senderAddrCache;
 		AutoPtr<MessageBlock> m_dataConnectionIncomingBuffer;
-		Connections m_dataConnections;
+		DataConnections m_dataConnections;
 
 	};
 
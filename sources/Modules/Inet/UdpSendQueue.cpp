@@ -0,0 +1,88 @@
+/**************************************************************************
+ *   Created: 2026/10/20 16:07
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "UdpSendQueue.hpp"
+#include "InetMetrics.hpp"
+
+using namespace TunnelEx;
+using namespace TunnelEx::Mods::Inet;
+
+//////////////////////////////////////////////////////////////////////////
+
+UdpSendQueue::UdpSendQueue(size_t maxSize)
+		: m_maxSize(maxSize),
+		m_size(0),
+		m_isEmpty(1) {
+	//...//
+}
+
+bool UdpSendQueue::Send(
+			ACE_SOCK_Dgram &socket,
+			const char *data,
+			size_t size,
+			const ACE_INET_Addr &address) {
+
+	if (Interlocked::CompareExchange(m_isEmpty, 1, 1) == 1) {
+		const ssize_t sentBytesNumb = socket.send(data, size, address);
+		if (sentBytesNumb >= 0 || errno != EWOULDBLOCK) {
+			return sentBytesNumb >= 0 && size_t(sentBytesNumb) == size;
+		}
+	}
+
+	Lock lock(m_mutex);
+	if (m_size + size > m_maxSize) {
+		InetMetrics::instance()->OnUdpSendDrop();
+		errno = EWOULDBLOCK;
+		return false;
+	}
+	m_queue.resize(m_queue.size() + 1);
+	Datagram &datagram = m_queue.back();
+	datagram.address = address;
+	datagram.data.assign(data, data + size);
+	m_size += size;
+	Interlocked::Exchange(m_isEmpty, 0);
+
+	// Write readiness could be already handled while the datagram was
+	// not in the queue, so the queue has to be sent here, Winsock signals
+	// write readiness only after failed sending.
+	FlushUnsafe(socket);
+
+	return true;
+
+}
+
+void UdpSendQueue::Flush(ACE_SOCK_Dgram &socket) {
+	Lock lock(m_mutex);
+	FlushUnsafe(socket);
+}
+
+void UdpSendQueue::FlushUnsafe(ACE_SOCK_Dgram &socket) {
+	while (!m_queue.empty()) {
+		const Datagram &datagram = m_queue.front();
+		if (	socket.send(
+					&datagram.data[0],
+					datagram.data.size(),
+					datagram.address)
+					< 0
+				&& errno == EWOULDBLOCK) {
+			break;
+		}
+		// other errors - the datagram is lost as by the network
+		assert(m_size >= datagram.data.size());
+		m_size -= datagram.data.size();
+		m_queue.pop_front();
+	}
+	if (m_queue.empty()) {
+		Interlocked::Exchange(m_isEmpty, 1);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
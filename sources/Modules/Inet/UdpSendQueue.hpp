@@ -0,0 +1,72 @@
+/**************************************************************************
+ *   Created: 2026/10/20 16:05
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__UdpSendQueue_hpp__2610201605
+#define INCLUDED_FILE__TUNNELEX__UdpSendQueue_hpp__2610201605
+
+#include "Core/Locking.hpp"
+
+namespace TunnelEx { namespace Mods { namespace Inet {
+
+	//! Datagrams which wait for free space in the socket send buffer.
+	/** Incoming UDP sessions send through the shared non-blocking listener
+	  * socket. A datagram which doesn't fit into the system send buffer is
+	  * stored here and sent when the socket is ready for writing again.
+	  * Each datagram is sent by one system call as Winsock has no batched
+	  * sending. While the queue is empty sending doesn't take any lock.
+	  */
+	class UdpSendQueue : private boost::noncopyable {
+
+	private:
+
+		typedef TunnelEx::SpinMutex Mutex;
+		typedef TunnelEx::Lock<Mutex> Lock;
+
+		struct Datagram {
+			ACE_INET_Addr address;
+			std::vector<char> data;
+		};
+
+	public:
+
+		explicit UdpSendQueue(size_t maxSize);
+
+	public:
+
+		//! Sends datagram or puts it into the queue if the socket is busy.
+		/** Datagram is dropped as by the network if the queue is full.
+		  * @return true if the datagram is sent or queued
+		  */
+		bool Send(
+					ACE_SOCK_Dgram &,
+					const char *data,
+					size_t size,
+					const ACE_INET_Addr &);
+
+		//! Sends queued datagrams until socket send buffer is full again.
+		void Flush(ACE_SOCK_Dgram &);
+
+	private:
+
+		void FlushUnsafe(ACE_SOCK_Dgram &);
+
+	private:
+
+		const size_t m_maxSize;
+
+		Mutex m_mutex;
+		std::deque<Datagram> m_queue;
+		size_t m_size;
+		volatile long m_isEmpty;
+
+	};
+
+} } }
+
+#endif // INCLUDED_FILE__TUNNELEX__UdpSendQueue_hpp__2610201605
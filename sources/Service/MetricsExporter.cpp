@@ -0,0 +1,193 @@
+/**************************************************************************
+ *   Created: 2026/10/19 16:58
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "MetricsExporter.hpp"
+
+#include "Core/Metrics.hpp"
+#include "Core/Log.hpp"
+
+using namespace TunnelEx;
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+	//! @todo: hardcoded metrics request limits
+	const size_t maxRequestSize = 4 * 1024;
+	const DWORD requestTimeoutMs = 5 * 1000;
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+MetricsExporter::MetricsExporter(unsigned short port)
+		: m_port(port),
+		m_socket(INVALID_SOCKET),
+		m_isStopped(false) {
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		Log::GetInstance().AppendSystemError(
+			"Failed to start metrics export: could not initialize sockets.");
+		return;
+	}
+
+	m_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (m_socket == INVALID_SOCKET) {
+		Format message("Failed to start metrics export: could not create socket (%1%).");
+		message % WSAGetLastError();
+		Log::GetInstance().AppendSystemError(message.str());
+		return;
+	}
+
+	const BOOL isExclusive = TRUE;
+	setsockopt(
+		m_socket,
+		SOL_SOCKET,
+		SO_EXCLUSIVEADDRUSE,
+		reinterpret_cast<const char *>(&isExclusive),
+		sizeof(isExclusive));
+
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(m_port);
+	if (	bind(m_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address))
+				== SOCKET_ERROR
+			|| listen(m_socket, SOMAXCONN) == SOCKET_ERROR) {
+		Format message("Failed to start metrics export on port %1%: %2%.");
+		message % m_port % WSAGetLastError();
+		Log::GetInstance().AppendError(message.str());
+		closesocket(m_socket);
+		m_socket = INVALID_SOCKET;
+		return;
+	}
+
+	m_thread = boost::thread(boost::bind(&MetricsExporter::Serve, this));
+
+	Log::GetInstance().AppendInfo(
+		(Format("Metrics export started on 127.0.0.1:%1%.") % m_port).str());
+
+}
+
+MetricsExporter::~MetricsExporter() throw() {
+	try {
+		m_isStopped = true;
+		if (m_socket != INVALID_SOCKET) {
+			// unblocks accept
+			closesocket(m_socket);
+		}
+		m_thread.join();
+		WSACleanup();
+	} catch (...) {
+		Format message(
+			"Unknown system error occurred: %1%:%2%."
+				" Please restart the service"
+				" and contact product support to resolve this issue."
+				" %3% %4%");
+		message
+			% __FILE__ % __LINE__
+			% TUNNELEX_NAME % TUNNELEX_BUILD_IDENTITY;
+		Log::GetInstance().AppendFatalError(message.str());
+		assert(false);
+	}
+}
+
+void MetricsExporter::Serve() {
+	for ( ; ; ) {
+		const SOCKET client = accept(m_socket, NULL, NULL);
+		if (client == INVALID_SOCKET) {
+			if (m_isStopped) {
+				break;
+			}
+			Log::GetInstance().AppendDebug(
+				"Failed to accept metrics request: %1%.",
+				WSAGetLastError());
+			continue;
+		}
+		try {
+			HandleRequest(client);
+		} catch (const std::exception &ex) {
+			Log::GetInstance().AppendSystemError(
+				(Format("Failed to handle metrics request: \"%1%\".") % ex.what()).str());
+		}
+		closesocket(client);
+	}
+}
+
+void MetricsExporter::HandleRequest(SOCKET client) const {
+
+	setsockopt(
+		client,
+		SOL_SOCKET,
+		SO_RCVTIMEO,
+		reinterpret_cast<const char *>(&requestTimeoutMs),
+		sizeof(requestTimeoutMs));
+
+	std::string request;
+	std::vector<char> buffer(maxRequestSize);
+	while (request.find("\r\n\r\n") == std::string::npos) {
+		if (request.size() >= maxRequestSize) {
+			return;
+		}
+		const int received = recv(
+			client,
+			&buffer[0],
+			int(maxRequestSize - request.size()),
+			0);
+		if (received <= 0) {
+			return;
+		}
+		request.append(&buffer[0], received);
+	}
+
+	const char *status;
+	std::string body;
+	if (request.compare(0, 4, "GET ") != 0) {
+		status = "405 Method Not Allowed";
+	} else {
+		const std::string::size_type pathEnd = request.find_first_of(" ?", 4);
+		if (	pathEnd == std::string::npos
+				|| request.compare(4, pathEnd - 4, "/metrics") != 0) {
+			status = "404 Not Found";
+		} else {
+			status = "200 OK";
+			Metrics::GetInstance().Export(body);
+		}
+	}
+
+	Format headers(
+		"HTTP/1.0 %1%\r\n"
+			"Content-Type: text/plain; version=0.0.4\r\n"
+			"Content-Length: %2%\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+	headers % status % body.size();
+	Send(client, headers.str());
+	Send(client, body);
+
+}
+
+void MetricsExporter::Send(SOCKET client, const std::string &data) {
+	for (size_t sent = 0; sent < data.size(); ) {
+		const int result = send(
+			client,
+			data.c_str() + sent,
+			int(data.size() - sent),
+			0);
+		if (result == SOCKET_ERROR) {
+			return;
+		}
+		sent += result;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,40 @@
+/**************************************************************************
+ *   Created: 2026/10/19 16:52
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#ifndef INCLUDED_FILE__TUNNELEX__MetricsExporter_hpp__2610191652
+#define INCLUDED_FILE__TUNNELEX__MetricsExporter_hpp__2610191652
+
+//! Serves runtime metrics in the Prometheus text format by HTTP.
+/** Listens only on the loopback interface, answers "GET /metrics" by
+  * one thread, one request per connection.
+  */
+class MetricsExporter : private boost::noncopyable {
+
+public:
+
+	explicit MetricsExporter(unsigned short port);
+	~MetricsExporter() throw();
+
+private:
+
+	void Serve();
+	void HandleRequest(SOCKET) const;
+
+	static void Send(SOCKET, const std::string &);
+
+private:
+
+	const unsigned short m_port;
+	SOCKET m_socket;
+	volatile bool m_isStopped;
+	boost::thread m_thread;
+
+};
+
+#endif // INCLUDED_FILE__TUNNELEX__MetricsExporter_hpp__2610191652
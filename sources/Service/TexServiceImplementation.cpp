@@ -13,12 +13,19 @@
 #include "ServiceControl/Configuration.hpp"
 #include "Legacy/LegacySupporter.hpp"
 #include "Modules/Upnp/Client.hpp"
+#include "Modules/Inet/InetEndpointAddress.hpp"
 #include "ServiceFilesSecurity.hpp"
+#include "MetricsExporter.hpp"
 #include "Core/Server.hpp"
+#include "Core/Tracer.hpp"
+#include "Core/Metrics.hpp"
 #include "Core/SslCertificatesStorage.hpp"
 #include "Core/LicenseState.hpp"
 #include "Core/Rule.hpp"
+#include "Core/RuleSetSnapshot.hpp"
+#include "Core/RuleSetJournal.hpp"
 #include "Core/Log.hpp"
+#include "Core/Error.hpp"
 #include "Core/Exceptions.hpp"
 
 namespace fs = boost::filesystem;
@@ -29,6 +36,16 @@ using namespace TunnelEx::Helpers::Crypto;
 
 //////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+	//! @todo: hardcoded rule set journal flush period and compaction threshold
+	const long rulesJournalFlushPeriodMs = 100;
+	const unsigned long long rulesJournalCompactionSize = 1024 * 1024;
+
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 class TexServiceImplementation::Implementation : private boost::noncopyable {
 
 public:
@@ -42,15 +59,85 @@ public:
 			m_errorCount(0),
 			m_warnCount(0),
 			m_isStarted(0),
-			m_startTime(time(0)) {
+			m_startTime(time(0)),
+			m_previousRunsLogSize(0) {
 		//...//
 	}
 
 	~Implementation() throw() {
-		//...//
+		m_rulesJournalThread.interrupt();
+		m_rulesJournalThread.join();
 	}
 
-	void  LoadRules() {
+	void LoadRules() {
+		LoadRulesFile();
+		try {
+			const size_t recordsNumber = RuleSetJournal::Replay(
+				GetRulesJournalFilePath().c_str(),
+				*m_ruleSet);
+			if (!m_rulesJournal.get()) {
+				m_rulesJournal.reset(new RuleSetJournal(GetRulesJournalFilePath().c_str()));
+			}
+			if (recordsNumber > 0) {
+				Log::GetInstance().AppendDebug(
+					"Applied %1% rule set journal records.",
+					recordsNumber);
+				UpdateLastRuleSetRevision();
+				CompactRules();
+			}
+		} catch (const TunnelEx::LocalException &ex) {
+			Format message("Could not open rule set journal: \"%1%\".");
+			message % ConvertString<String>(ex.GetWhat()).GetCStr();
+			Log::GetInstance().AppendError(message.str().c_str());
+			// keeps records, which have been applied before the error
+			SaveRules(*m_ruleSet);
+			// changes will be saved as full rule set, the journal records
+			// could be replayed over them at the next start
+			if (m_rulesJournal.get()) {
+				DiscardRulesJournal();
+			} else {
+				MoveRulesJournalAside(GetRulesJournalFilePath());
+				MoveRulesJournalAside(GetRulesJournalFilePath() + L".compaction");
+			}
+		}
+	}
+
+	void MoveRulesJournalAside(const std::wstring &path) const {
+		const std::wstring failedPath = path + L".failed";
+		if (	MoveFileExW(path.c_str(), failedPath.c_str(), MOVEFILE_REPLACE_EXISTING)
+				|| GetLastError() == ERROR_FILE_NOT_FOUND
+				|| DeleteFileW(path.c_str())) {
+			return;
+		}
+		const Error error(GetLastError());
+		Format message(
+			"Could not remove failed rule set journal \"%1%\": %2% (%3%),"
+				" its records will be applied at the next start.");
+		message
+			% ConvertString<String>(path.c_str()).GetCStr()
+			% error.GetStringA().GetCStr()
+			% error.GetErrorNo();
+		Log::GetInstance().AppendFatalError(message.str().c_str());
+	}
+
+	void LoadRulesFile() {
+		{
+			// the snapshot replaces XML parsing and validation while it is fresh
+			std::auto_ptr<RuleSet> ruleSet(new RuleSet);
+			try {
+				if (	RuleSetSnapshot::Load(
+							m_rulesFilePath.c_str(),
+							GetRulesSnapshotFilePath().c_str(),
+							*ruleSet)) {
+					SetRuleSet(ruleSet);
+					return;
+				}
+			} catch (const TunnelEx::LocalException &ex) {
+				Format message("Could not load rule set snapshot: \"%1%\".");
+				message % ConvertString<String>(ex.GetWhat()).GetCStr();
+				Log::GetInstance().AppendWarn(message.str().c_str());
+			}
+		}
 		std::wifstream rulesFile(m_rulesFilePath.c_str(), std::ios::binary | std::ios::in);
 		if (!rulesFile) {
 			Log::GetInstance().AppendDebug(
@@ -65,6 +152,7 @@ public:
 			try {
 				SetRuleSet(
 					std::auto_ptr<RuleSet>(new RuleSet(rulesXml.str().c_str())));
+				SaveRulesSnapshot(*m_ruleSet);
 			} catch (const TunnelEx::XmlDoesNotMatchException &) {
 				// rules xml file has wrong version
 				std::auto_ptr<RuleSet> ruleSet(new RuleSet);
@@ -76,7 +164,9 @@ public:
 		}
 	}
 
-	void SaveRules() const {
+	//! Saves full rule set, returns true if the rule set file has been written.
+	bool SaveRules(const RuleSet &ruleSet) const {
+		bool isSaved = false;
 		try {
 			const fs::wpath rulesFilePath(m_rulesFilePath);
 			fs::create_directories(rulesFilePath.branch_path());
@@ -86,14 +176,20 @@ public:
 					std::ios::binary | std::ios::out | std::ios::trunc);
 				if (rulesFile) {
 					WString rulesXml;
-					m_ruleSet->GetXml(rulesXml);
+					// generated from the rule set, validated at loading
+					ruleSet.GetXml(rulesXml, false);
 					rulesFile << rulesXml.GetCStr();
+					rulesFile.close();
+					isSaved = !rulesFile.fail();
 				} else {
 					Format message("Could not open rule set file \"%1%\".");
 					message % ConvertString<String>(m_rulesFilePath.c_str()).GetCStr();
 					Log::GetInstance().AppendFatalError(message.str().c_str());
 				}
 			}
+			if (isSaved) {
+				SaveRulesSnapshot(ruleSet);
+			}
 			if (ServiceConfiguration::GetConfigurationFileDir() == rulesFilePath.branch_path()) {
 				ServiceFilesSecurity::Set(rulesFilePath.branch_path());
 			}
@@ -102,6 +198,149 @@ public:
 			message % ex.what();
 			Log::GetInstance().AppendSystemError(message.str().c_str());
 		}
+		return isSaved;
+	}
+
+	//! Stores the rule set change, see RuleSetJournal.
+	/** Saves the full rule set if the journal is not available,
+	  * m_mutex has to be locked.
+	  */
+	template<typename Append>
+	void SaveRulesChange(const Append &append) {
+		if (m_rulesJournal.get()) {
+			try {
+				append(*m_rulesJournal);
+				return;
+			} catch (const TunnelEx::LocalException &ex) {
+				Format message("Could not append rule set journal: \"%1%\".");
+				message % ConvertString<String>(ex.GetWhat()).GetCStr();
+				Log::GetInstance().AppendWarn(message.str().c_str());
+			}
+		}
+		CompactRules();
+	}
+
+	//! Saves the full rule set and drops journal records, included in it.
+	void CompactRules() {
+		const boost::mutex::scoped_lock rulesFileLock(m_rulesFileMutex);
+		bool isStarted = false;
+		if (m_rulesJournal.get()) {
+			try {
+				m_rulesJournal->StartCompaction();
+				isStarted = true;
+			} catch (const TunnelEx::LocalException &ex) {
+				Format message("Could not start rule set journal compaction: \"%1%\".");
+				message % ConvertString<String>(ex.GetWhat()).GetCStr();
+				Log::GetInstance().AppendWarn(message.str().c_str());
+			}
+		}
+		if (SaveRules(*m_ruleSet) && isStarted) {
+			CompleteRulesCompaction();
+		}
+	}
+
+	void CompleteRulesCompaction() {
+		try {
+			m_rulesJournal->CompleteCompaction();
+		} catch (const TunnelEx::LocalException &ex) {
+			Format message("Could not complete rule set journal compaction: \"%1%\".");
+			message % ConvertString<String>(ex.GetWhat()).GetCStr();
+			Log::GetInstance().AppendWarn(message.str().c_str());
+		}
+	}
+
+	//! Drops all journal records, rule set file has been replaced.
+	void DiscardRulesJournal() {
+		if (!m_rulesJournal.get()) {
+			return;
+		}
+		const boost::mutex::scoped_lock rulesFileLock(m_rulesFileMutex);
+		try {
+			m_rulesJournal->StartCompaction();
+			m_rulesJournal->CompleteCompaction();
+		} catch (const TunnelEx::LocalException &ex) {
+			Format message("Could not discard rule set journal: \"%1%\".");
+			message % ConvertString<String>(ex.GetWhat()).GetCStr();
+			Log::GetInstance().AppendError(message.str().c_str());
+		}
+	}
+
+	void StartRulesJournalThread() {
+		if (m_rulesJournal.get()) {
+			m_rulesJournalThread = boost::thread(
+				boost::bind(&Implementation::ServeRulesJournal, this));
+		}
+	}
+
+	//! Batches journal flushing and compacts it out of the requests.
+	void ServeRulesJournal() {
+		try {
+			for ( ; ; ) {
+				boost::this_thread::sleep(ps::milliseconds(rulesJournalFlushPeriodMs));
+				FlushRulesJournal();
+				if (m_rulesJournal->GetSize() >= rulesJournalCompactionSize) {
+					CompactRulesInBackground();
+				}
+			}
+		} catch (const boost::thread_interrupted &) {
+			//...//
+		}
+		FlushRulesJournal();
+	}
+
+	void FlushRulesJournal() {
+		try {
+			m_rulesJournal->Flush();
+		} catch (const TunnelEx::LocalException &ex) {
+			Format message("Could not flush rule set journal: \"%1%\".");
+			message % ConvertString<String>(ex.GetWhat()).GetCStr();
+			Log::GetInstance().AppendError(message.str().c_str());
+		}
+	}
+
+	//! Saves rule set copy without m_mutex, requests are not blocked by file writing.
+	void CompactRulesInBackground() {
+		std::auto_ptr<RuleSet> ruleSet;
+		boost::mutex::scoped_lock rulesFileLock(m_rulesFileMutex, boost::defer_lock);
+		{
+			const boost::mutex::scoped_lock lock(m_mutex);
+			// under m_mutex to keep locking order with CompactRules
+			rulesFileLock.lock();
+			try {
+				m_rulesJournal->StartCompaction();
+			} catch (const TunnelEx::LocalException &ex) {
+				Format message("Could not start rule set journal compaction: \"%1%\".");
+				message % ConvertString<String>(ex.GetWhat()).GetCStr();
+				Log::GetInstance().AppendWarn(message.str().c_str());
+				return;
+			}
+			ruleSet.reset(new RuleSet(*m_ruleSet));
+		}
+		if (SaveRules(*ruleSet)) {
+			CompleteRulesCompaction();
+		}
+	}
+
+	std::wstring GetRulesJournalFilePath() const {
+		return m_rulesFilePath + L".journal";
+	}
+
+	std::wstring GetRulesSnapshotFilePath() const {
+		return m_rulesFilePath + L".snapshot";
+	}
+
+	//! Writes snapshot for the current rule set, the rule set file has to be saved or loaded just before.
+	void SaveRulesSnapshot(const RuleSet &ruleSet) const {
+		try {
+			RuleSetSnapshot::Save(
+				ruleSet,
+				m_rulesFilePath.c_str(),
+				GetRulesSnapshotFilePath().c_str());
+		} catch (const TunnelEx::LocalException &ex) {
+			Format message("Could not save rule set snapshot: \"%1%\".");
+			message % ConvertString<String>(ex.GetWhat()).GetCStr();
+			Log::GetInstance().AppendWarn(message.str().c_str());
+		}
 	}
 
 	ServiceConfiguration & GetConfiguration() {
@@ -167,6 +406,81 @@ public:
 		return false;
 	}
 
+	//! Reads last records of the previous service runs from the log file.
+	/** Records of the current run are kept by the log in the memory, so
+	  * the file is read only before the current run start. The file is
+	  * read by blocks from this position back until the required number
+	  * of lines is found.
+	  */
+	void ReadPreviousRunsLogRecords(
+				size_t recordsNumber,
+				std::list<texs__LogRecord> &result)
+			const {
+
+		if (!recordsNumber || !m_previousRunsLogSize) {
+			return;
+		}
+		std::ifstream log(m_logFilePath.c_str(), std::ios::in | std::ios::binary);
+		if (!log) {
+			return;
+		}
+
+		const std::streamoff end = std::streamoff(m_previousRunsLogSize);
+		std::streamoff start = end;
+		{
+			std::vector<char> buffer(4 * 1024);
+			size_t linesNumber = 0;
+			bool isFound = false;
+			while (start > 0 && !isFound) {
+				const std::streamoff blockStart
+					= start - std::min(start, std::streamoff(buffer.size()));
+				const std::streamsize blockSize = std::streamsize(start - blockStart);
+				log.seekg(blockStart);
+				if (!log.read(&buffer[0], blockSize)) {
+					return;
+				}
+				for (std::streamsize i = blockSize; i > 0; --i) {
+					const std::streamoff lineStart = blockStart + i;
+					if (	buffer[size_t(i - 1)] == '\n'
+							&& lineStart < end
+							&& ++linesNumber >= recordsNumber) {
+						start = lineStart;
+						isFound = true;
+						break;
+					}
+				}
+				if (!isFound) {
+					start = blockStart;
+				}
+			}
+		}
+
+		std::vector<char> content(size_t(end - start));
+		log.seekg(start);
+		if (content.empty() || !log.read(&content[0], std::streamsize(content.size()))) {
+			return;
+		}
+		const boost::regex recordExp(
+			"(\\d{4,4}\\-[a-z]{3,3}\\-\\d{2,2}\\s\\d{2,2}:\\d{2,2}:\\d{2,2}.\\d{6,6})\\s+([a-z]+(\\s[a-z]+)?):\\s([^\\r\\n]*)[\\r\\n\\t\\s]*",
+			boost::regex::perl | boost::regex::icase);
+		typedef std::vector<char>::const_iterator Iterator;
+		for (Iterator lineStart = content.begin(); lineStart != content.end(); ) {
+			const Iterator lineEnd = std::find(lineStart, Iterator(content.end()), '\n');
+			boost::match_results<Iterator> what;
+			if (boost::regex_match(lineStart, lineEnd, what, recordExp)) {
+				texs__LogRecord record;
+				// records of the previous runs have no sequence numbers
+				record.sequenceNumber = 0;
+				record.time = what[1];
+				record.level = Log::GetInstance().ResolveLevel(what[2].str().c_str());
+				record.message = what[4];
+				result.push_back(record);
+			}
+			lineStart = lineEnd != content.end() ? lineEnd + 1 : lineEnd;
+		}
+
+	}
+
 	template<class RuleSet>
 	bool UpdateRulesState(RuleSet &ruleSet) const {
 		const size_t ruleSetSize = ruleSet.GetSize();
@@ -195,7 +509,7 @@ public:
 		}
 		if (hasChanges) {
 			SetRuleSet(rulesPtr);
-			SaveRules();
+			CompactRules();
 		}
 	}
 
@@ -340,9 +654,16 @@ public:
 	const time_t m_startTime;
 	std::wstring m_rulesFilePath;
 	std::wstring m_logFilePath;
+	//! Log file size before the current run records.
+	uintmax_t m_previousRunsLogSize;
 	boost::mutex m_mutex;
+	//! Serializes full rule set saving, locked after m_mutex.
+	boost::mutex m_rulesFileMutex;
+	std::auto_ptr<RuleSetJournal> m_rulesJournal;
+	boost::thread m_rulesJournalThread;
 	std::auto_ptr<ServiceConfiguration> m_conf;
 	std::auto_ptr<SslCertificatesStorage> m_sslCertificatesStorage;
+	std::auto_ptr<MetricsExporter> m_metricsExporter;
 
 };
 
@@ -355,7 +676,9 @@ TexServiceImplementation::TexServiceImplementation(boost::optional<LogLevel> for
 
 	uintmax_t previousLogSize;
 	const bool logWasTruncated = m_pimpl->TruncateLog(conf, previousLogSize);
-	Log::GetInstance().AttachFile(conf.GetLogPath());
+	m_pimpl->m_logFilePath = conf.GetLogPath();
+	m_pimpl->m_previousRunsLogSize = logWasTruncated ? 0 : previousLogSize;
+	Log::GetInstance().AttachFile(m_pimpl->m_logFilePath);
 #	if !defined(DEV_VER)
 		if (!forcedLogLevel && conf.GetLogLevel() == TunnelEx::LOG_LEVEL_DEBUG) {
 			conf.SetLogLevel(TunnelEx::LOG_LEVEL_INFO);
@@ -373,10 +696,31 @@ TexServiceImplementation::TexServiceImplementation(boost::optional<LogLevel> for
 			(Format("Log was truncated, previous size - %1% bytes.") % previousLogSize).str());
 	}
 
+	if (conf.GetMetricsPort() != 0) {
+		m_pimpl->m_metricsExporter.reset(new MetricsExporter(conf.GetMetricsPort()));
+	}
+
+	{
+		const std::vector<std::string> nameServers = conf.GetNameServers();
+		if (!nameServers.empty()) {
+			try {
+				Mods::Inet::InetEndpointAddress::SetNameServers(nameServers);
+			} catch (const TunnelEx::LocalException &ex) {
+				Format message(
+					"Could not set DNS servers, system DNS servers will be used: \"%1%\".");
+				message % ConvertString<String>(ex.GetWhat()).GetCStr();
+				Log::GetInstance().AppendWarn(message.str().c_str());
+			}
+		}
+	}
+
+	Mods::Inet::TcpEndpointAddress::SetSslAesGcmPreference(
+		conf.IsSslAesGcmPreferred());
+
 	m_pimpl->m_rulesFilePath = conf.GetRulesPath();
-	m_pimpl->m_logFilePath = conf.GetLogPath();
 
 	m_pimpl->LoadRules();
+	m_pimpl->StartRulesJournalThread();
 
 	if (conf.IsServerStarted()) {
 		Start();
@@ -436,7 +780,7 @@ void TexServiceImplementation::GetRuleSet(std::string &result) const {
 	WString buffer;
 	try {
 		boost::mutex::scoped_lock lock(m_pimpl->m_mutex);
-		m_pimpl->m_ruleSet->GetXml(buffer);
+		m_pimpl->m_ruleSet->GetXml(buffer, false);
 	} catch (const TunnelEx::LocalException &ex) {
 		Format message("Could not serialize rules list into XML: \"%1%\".");
 		message % ConvertString<String>(ex.GetWhat()).GetCStr();
@@ -452,7 +796,8 @@ void TexServiceImplementation::UpdateRules(const std::wstring &xml) {
 		boost::mutex::scoped_lock lock(m_pimpl->m_mutex);
 		m_pimpl->UpdateRules(ruleSet.GetServices(), m_pimpl->m_ruleSet->GetServices());
 		m_pimpl->UpdateRules(ruleSet.GetTunnels(), m_pimpl->m_ruleSet->GetTunnels());
-		m_pimpl->SaveRules();
+		m_pimpl->SaveRulesChange(
+			boost::bind(&RuleSetJournal::AppendUpdate, _1, boost::cref(ruleSet)));
 		m_pimpl->UpdateLastRuleSetRevision();
 	} catch (const ::TunnelEx::LocalException &ex) {
 		Format message("Could not update rules: %1%.");
@@ -475,11 +820,16 @@ void TexServiceImplementation::EnableRules(
 			m_pimpl->EnableRule(m_pimpl->m_ruleSet->GetServices(), u, isEnabled, wasChangedNow)
 				|| m_pimpl->EnableRule(m_pimpl->m_ruleSet->GetTunnels(), u, isEnabled, wasChangedNow);
 			if (wasChangedNow) {
+				m_pimpl->SaveRulesChange(
+					boost::bind(
+						&RuleSetJournal::AppendEnable,
+						_1,
+						WString(u.c_str()),
+						isEnabled));
 				wasChanged = true;
 			}
 		}
 		if (wasChanged) {
-			m_pimpl->SaveRules();
 			m_pimpl->UpdateLastRuleSetRevision();
 		}
 	} catch (const ::TunnelEx::LocalException &ex) {
@@ -501,11 +851,12 @@ void TexServiceImplementation::DeleteRules(const std::list<std::wstring> &uuids)
 		}
 		if (	m_pimpl->DeleteRule(m_pimpl->m_ruleSet->GetServices(), u)
 				|| m_pimpl->DeleteRule(m_pimpl->m_ruleSet->GetTunnels(), u)) {
+			m_pimpl->SaveRulesChange(
+				boost::bind(&RuleSetJournal::AppendDelete, _1, WString(u.c_str())));
 			wasFound = true;
 		}
 	}
 	if (wasFound) {
-		m_pimpl->SaveRules();
 		m_pimpl->UpdateLastRuleSetRevision();
 	}
 }
@@ -538,6 +889,16 @@ void TexServiceImplementation::SetLogLevel(LogLevel level) {
 	}
 }
 
+void TexServiceImplementation::SetTracing(bool isEnabled) {
+	Tracer::GetInstance().Enable(isEnabled);
+	Log::GetInstance().AppendInfo(
+		isEnabled ? "Events tracing enabled." : "Events tracing disabled.");
+}
+
+void TexServiceImplementation::GetTrace(std::string &result) const {
+	Tracer::GetInstance().Export(result);
+}
+
 void TexServiceImplementation::GetNetworkAdapters(
 			std::list<texs__NetworkAdapterInfo> &result)
 		const {
@@ -609,60 +970,113 @@ void TexServiceImplementation::GetNetworkAdapters(
 
 void TexServiceImplementation::GetLastLogRecords(
 			unsigned int recordsNumber,
+			unsigned long sinceSequenceNumber,
 			std::list<texs__LogRecord> &destination)
 		const {
-	std::ifstream log(m_pimpl->m_logFilePath.c_str(), std::ios::in | std::ios::binary);
-	log.seekg(-1, std::ios::end);
-	unsigned int passedLines = 0;
-	bool isContentStarted = false;
-	for (std::streamsize i = 1; ; log.seekg(-(++i), std::ios::end)) {
-		if (!log) {
-			log.clear();
-			log.seekg(-(i - 1), std::ios::end);
-			break;
-		}
-		char c;
-		log.get(c);
-		if (c == '\n') {
-			if (isContentStarted && ++passedLines >= recordsNumber) {
-				break;
-			}
-		} else if (!isContentStarted) {
-			isContentStarted = true;
+	std::vector<LogRecord> records;
+	Log::GetInstance().GetRecentRecords(
+		sinceSequenceNumber,
+		recordsNumber,
+		records);
+	if (	!sinceSequenceNumber
+			&& !records.empty()
+			&& records.front().sequenceNumber == 1
+			&& records.size() < recordsNumber) {
+		// all records of the current run are in the memory, older records
+		// are available only in the file
+		m_pimpl->ReadPreviousRunsLogRecords(
+			recordsNumber - records.size(),
+			destination);
+	}
+	foreach (const LogRecord &record, records) {
+		texs__LogRecord texsRecord;
+		texsRecord.sequenceNumber = record.sequenceNumber;
+		texsRecord.time = record.time;
+		texsRecord.level = record.level;
+		texsRecord.message = record.message;
+		destination.push_back(texsRecord);
+	}
+}
+
+void TexServiceImplementation::GetTunnelStats(
+			unsigned int offset,
+			unsigned int limit,
+			texs__TunnelStats &result)
+		const {
+
+	result.totalNumber = 0;
+	result.tunnels.clear();
+
+	std::vector<TunnelStat> stats;
+	if (Server::GetInstance().IsStarted()) {
+		try {
+			Server::GetInstance().GetTunnelStats(stats);
+		} catch (const ::TunnelEx::LocalException &ex) {
+			// server has been stopped after the check
+			Log::GetInstance().AppendDebug(
+				ConvertString<String>(ex.GetWhat()).GetCStr());
 		}
 	}
-	const unsigned short bufferStep
-#		ifdef _DEBUG
-			= 10;
-#		else
-			= 512;
-#		endif // _DEBUG
-	std::vector<char> buffer(bufferStep, 0);
-	size_t pos = 0;
-	boost::regex recordExp(
-		"(\\d{4,4}\\-[a-z]{3,3}\\-\\d{2,2}\\s\\d{2,2}:\\d{2,2}:\\d{2,2}.\\d{6,6})\\s+([a-z]+(\\s[a-z]+)?):\\s([^\\r\\n]*)[\\r\\n\\t\\s]*",
-		boost::regex::perl | boost::regex::icase);
-	while (!log.getline(&buffer[pos], std::streamsize(buffer.size() - pos)).eof()) {
-		if (log.fail()) {
-			pos = buffer.size() - 1;
-			buffer.resize(buffer.size() + bufferStep);
-			log.clear(log.rdstate() & ~std::ios::failbit);
-		} else {
-			pos = 0;
-			boost::cmatch what;
-			if (boost::regex_match(&buffer[0], what, recordExp)) {
-				texs__LogRecord record;
-				record.time = what[1];
-				record.level = Log::GetInstance().ResolveLevel(what[2].str().c_str());
-				record.message = what[4];
-				destination.push_back(record);
-			}
+	result.totalNumber = (unsigned int)stats.size();
+	if (offset >= stats.size()) {
+		return;
+	}
+
+	// only the requested page have to be ordered
+	const size_t end = std::min<size_t>(stats.size(), size_t(offset) + limit);
+	std::partial_sort(
+		stats.begin(),
+		stats.begin() + end,
+		stats.end(),
+		[](const TunnelStat &lhs, const TunnelStat &rhs) {
+			return lhs.throughput > rhs.throughput;
+		});
+
+	for (size_t i = offset; i < end; ++i) {
+		const TunnelStat &stat = stats[i];
+		texs__TunnelStat texsStat;
+		texsStat.id = stat.tunnelId;
+		texsStat.ruleUuid = stat.ruleUuid;
+		texsStat.incomingBytes = stat.traffic.incomingBytes;
+		texsStat.incomingPackets = stat.traffic.incomingPackets;
+		texsStat.outcomingBytes = stat.traffic.outcomingBytes;
+		texsStat.outcomingPackets = stat.traffic.outcomingPackets;
+		texsStat.throughput = stat.throughput;
+		result.tunnels.push_back(texsStat);
+	}
+
+}
+
+void TexServiceImplementation::GetAllocatorsStat(
+			std::list<texs__AllocatorsStat> &result)
+		const {
+
+	std::vector<Singletons::MetricsPolicy::AllocatorsStat> stats;
+	Metrics::GetInstance().GetAllocatorsStat(stats);
+
+	std::list<texs__AllocatorsStat> texsStats;
+	foreach (const Singletons::MetricsPolicy::AllocatorsStat &stat, stats) {
+		texs__AllocatorsStat texsStat;
+		texsStat.ruleUuid = stat.ruleUuid.GetCStr();
+		for (int i = 0; i < Singletons::MetricsPolicy::numberOfAllocatorPools; ++i) {
+			texs__AllocatorPoolStat pool;
+			pool.pool = Singletons::MetricsPolicy::GetAllocatorPoolName(
+				Singletons::MetricsPolicy::AllocatorPool(i));
+			pool.live = stat.pools[i].live;
+			pool.peak = stat.pools[i].peak;
+			pool.failures = stat.pools[i].fails;
+			texsStat.pools.push_back(pool);
 		}
+		texsStats.push_back(texsStat);
 	}
+	texsStats.swap(result);
+
 }
 
 bool TexServiceImplementation::Migrate() {
 	LegacySupporter().MigrateAllAndSave();
+	// journal records were made for the rule set before migration
+	m_pimpl->DiscardRulesJournal();
 	m_pimpl->LoadRules();
 	return true;
 }
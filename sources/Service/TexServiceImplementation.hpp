@@ -41,7 +41,22 @@ public:
 	long HitHeart() const;
 	void CheckState(texs__ServiceState &) const;
 
-	void GetLastLogRecords(unsigned int, std::list<texs__LogRecord> &) const;
+	void GetLastLogRecords(
+			unsigned int recordsNumber,
+			unsigned long sinceSequenceNumber,
+			std::list<texs__LogRecord> &)
+		const;
+
+	//! Returns page of active tunnels ordered by throughput, the highest first.
+	void GetTunnelStats(
+			unsigned int offset,
+			unsigned int limit,
+			texs__TunnelStats &)
+		const;
+
+	//! Returns message allocators pools stat, process-wide first, then
+	//! for each rule.
+	void GetAllocatorsStat(std::list<texs__AllocatorsStat> &) const;
 
 	bool Migrate();
 
@@ -81,6 +96,11 @@ public:
 	TunnelEx::LogLevel GetLogLevel() const;
 	void SetLogLevel(TunnelEx::LogLevel);
 
+	//! Enables or disables hot-path events tracer, isn't saved in configuration.
+	void SetTracing(bool isEnabled);
+	//! Returns traced events in the Chrome trace JSON.
+	void GetTrace(std::string &) const;
+
 	bool GetUpnpStatus(std::string &externalIp, std::string &localIp) const;
 
 private:
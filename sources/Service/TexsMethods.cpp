@@ -59,8 +59,26 @@ int texs__DeleteRules(soap *, std::list<std::wstring> uuidsToDelete, texs__Delet
 int texs__GetLogRecords(
 			soap *,
 			unsigned int recordsNumber,
+			unsigned long sinceSequenceNumber,
 			std::list<texs__LogRecord> &result) {
-	TexWinService::GetTexServiceInstance()->GetLastLogRecords(recordsNumber, result);
+	TexWinService::GetTexServiceInstance()->GetLastLogRecords(
+		recordsNumber,
+		sinceSequenceNumber,
+		result);
+	return SOAP_OK;
+}
+
+int texs__GetTunnelStats(
+			soap *,
+			unsigned int offset,
+			unsigned int limit,
+			texs__TunnelStats &result) {
+	TexWinService::GetTexServiceInstance()->GetTunnelStats(offset, limit, result);
+	return SOAP_OK;
+}
+
+int texs__GetAllocatorsStat(soap *, std::list<texs__AllocatorsStat> &result) {
+	TexWinService::GetTexServiceInstance()->GetAllocatorsStat(result);
 	return SOAP_OK;
 }
 
@@ -91,6 +109,19 @@ int texs__SetLogLevel(
 	return SOAP_OK;
 }
 
+int texs__SetTracing(
+			soap *,
+			bool isEnabled,
+			struct texs__SetTracingResult *) {
+	TexWinService::GetTexServiceInstance()->SetTracing(isEnabled);
+	return SOAP_OK;
+}
+
+int texs__GetTrace(soap *, std::string &result) {
+	TexWinService::GetTexServiceInstance()->GetTrace(result);
+	return SOAP_OK;
+}
+
 int texs__GetLogLevel(struct soap*, enum texs__LogLevel &getLogLevelResult) {
 	switch (TexWinService::GetTexServiceInstance()->GetLogLevel()) {
 		case TunnelEx::LOG_LEVEL_TRACK:
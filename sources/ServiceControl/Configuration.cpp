@@ -115,6 +115,13 @@ protected:
 		return GetNode(*m_doc, tag);
 	}
 
+	//! Returns nil if optional node is not set.
+	static boost::shared_ptr<Node> FindNode(Document &doc, const char *tag) {
+		std::string query = "//Configuration[@Version = \"1.2\"]/";
+		query += tag;
+		return doc.GetXPath()->Query(query.c_str());
+	}
+
 	void ValidateDocAndThrow(Document &doc) {
 		try {
 			Schema schema(GetSchemaFilePath());
@@ -226,6 +233,87 @@ public:
 		SetNodeContent("ServerState", val ? L"started" : L"stopped");
 	}
 
+	unsigned short GetMetricsPort() const {
+		const boost::shared_ptr<const Node> node = FindNode(*m_doc, "Metrics");
+		if (!node) {
+			return 0;
+		}
+		std::wstring buffer;
+		try {
+			return boost::lexical_cast<unsigned short>(node->GetAttribute("Port", buffer));
+		} catch (const boost::bad_lexical_cast &) {
+			return 0;
+		}
+	}
+
+	void SetMetricsPort(unsigned short port) {
+		boost::shared_ptr<Document> newDoc = Document::CreateDuplicate(*m_doc);
+		boost::shared_ptr<Node> node = FindNode(*newDoc, "Metrics");
+		if (!node) {
+			node = newDoc->GetRoot()->CreateNewChild("Metrics");
+		}
+		node->SetAttribute("Port", boost::lexical_cast<std::wstring>(port));
+		ValidateDocAndThrow(*newDoc);
+		m_doc = newDoc;
+		m_isChanged = true;
+	}
+
+	std::vector<std::string> GetNameServers() const {
+		std::vector<std::string> result;
+		const boost::shared_ptr<const Node> node = FindNode(*m_doc, "Dns");
+		if (!node) {
+			return result;
+		}
+		std::string buffer;
+		std::istringstream servers(node->GetAttribute("Servers", buffer));
+		std::string server;
+		while (servers >> server) {
+			result.push_back(server);
+		}
+		return result;
+	}
+
+	void SetNameServers(const std::vector<std::string> &servers) {
+		std::string attribute;
+		for (size_t i = 0; i < servers.size(); ++i) {
+			if (i > 0) {
+				attribute.push_back(' ');
+			}
+			attribute += servers[i];
+		}
+		boost::shared_ptr<Document> newDoc = Document::CreateDuplicate(*m_doc);
+		boost::shared_ptr<Node> node = FindNode(*newDoc, "Dns");
+		if (!node) {
+			node = newDoc->GetRoot()->CreateNewChild("Dns");
+		}
+		node->SetAttribute("Servers", attribute);
+		ValidateDocAndThrow(*newDoc);
+		m_doc = newDoc;
+		m_isChanged = true;
+	}
+
+	bool IsSslAesGcmPreferred() const {
+		const boost::shared_ptr<const Node> node = FindNode(*m_doc, "Ssl");
+		if (!node) {
+			return false;
+		}
+		std::wstring buffer;
+		node->GetAttribute("PreferAesGcm", buffer);
+		return buffer == L"true" || buffer == L"1";
+	}
+
+	void SetSslAesGcmPreference(bool isPreferred) {
+		boost::shared_ptr<Document> newDoc = Document::CreateDuplicate(*m_doc);
+		boost::shared_ptr<Node> node = FindNode(*newDoc, "Ssl");
+		if (!node) {
+			node = newDoc->GetRoot()->CreateNewChild("Ssl");
+		}
+		node->SetAttribute("PreferAesGcm", isPreferred ? "true" : "false");
+		ValidateDocAndThrow(*newDoc);
+		m_doc = newDoc;
+		m_isChanged = true;
+	}
+
 	bool Save(const std::wstring &confFilePath) {
 		fs::create_directories(fs::wpath(confFilePath).branch_path());
 		return m_doc->Save(confFilePath);
@@ -362,6 +450,30 @@ void ServiceConfiguration::SetServerStarted(bool val) {
 	m_pimpl->SetServerStarted(val);
 }
 
+unsigned short ServiceConfiguration::GetMetricsPort() const {
+	return m_pimpl->GetMetricsPort();
+}
+
+void ServiceConfiguration::SetMetricsPort(unsigned short port) {
+	m_pimpl->SetMetricsPort(port);
+}
+
+std::vector<std::string> ServiceConfiguration::GetNameServers() const {
+	return m_pimpl->GetNameServers();
+}
+
+void ServiceConfiguration::SetNameServers(const std::vector<std::string> &servers) {
+	m_pimpl->SetNameServers(servers);
+}
+
+bool ServiceConfiguration::IsSslAesGcmPreferred() const {
+	return m_pimpl->IsSslAesGcmPreferred();
+}
+
+void ServiceConfiguration::SetSslAesGcmPreference(bool isPreferred) {
+	m_pimpl->SetSslAesGcmPreference(isPreferred);
+}
+
 const wchar_t* ServiceConfiguration::GetConfigurationFile() {
 	return L"ServiceConfiguration.xml";
 }
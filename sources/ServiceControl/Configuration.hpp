@@ -100,6 +100,27 @@ public:
 	  */
 	void SetServerStarted(bool);
 
+	//! Returns local port for the metrics export, 0 if export is disabled.
+	unsigned short GetMetricsPort() const;
+	/** @throw ConfigurationNotFoundException
+	  * @throw ConfigurationHasInvalidFormatException
+	  */
+	void SetMetricsPort(unsigned short);
+
+	//! Returns DNS servers (IPv4 addresses), empty if system servers are used.
+	std::vector<std::string> GetNameServers() const;
+	/** @throw ConfigurationNotFoundException
+	  * @throw ConfigurationHasInvalidFormatException
+	  */
+	void SetNameServers(const std::vector<std::string> &);
+
+	//! Returns true if AES-GCM ciphers are preferred for SSL/TLS, false by default.
+	bool IsSslAesGcmPreferred() const;
+	/** @throw ConfigurationNotFoundException
+	  * @throw ConfigurationHasInvalidFormatException
+	  */
+	void SetSslAesGcmPreference(bool);
+
 	bool Save(const wchar_t *confFilePath = 0);
 	bool IsChanged() const;
 
@@ -30,6 +30,7 @@
 #include <vector>
 #include <map>
 #include <fstream>
+#include <sstream>
 #include <numeric>
 #include <string>
 #include <memory>
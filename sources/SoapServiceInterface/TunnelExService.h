@@ -67,6 +67,7 @@ int texs__DeleteRules(
 
 class texs__LogRecord {
 public:
+	unsigned long sequenceNumber;
 	std::string time;
 	unsigned int level;
 	std::string message;
@@ -75,8 +76,50 @@ public:
 //gsoap texs service method-action: GetLogRecords "urn:#getLogRecords"
 int texs__GetLogRecords(
 		unsigned int recordsNumber,
+		unsigned long sinceSequenceNumber,
 		std::list<texs__LogRecord> &getLogRecordsResult);
 
+class texs__TunnelStat {
+public:
+	ULONG64 id;
+	std::wstring ruleUuid;
+	LONG64 incomingBytes;
+	LONG64 incomingPackets;
+	LONG64 outcomingBytes;
+	LONG64 outcomingPackets;
+	double throughput;
+};
+
+class texs__TunnelStats {
+public:
+	unsigned int totalNumber;
+	std::list<texs__TunnelStat> tunnels;
+};
+
+//gsoap texs service method-action: GetTunnelStats "urn:#getTunnelStats"
+int texs__GetTunnelStats(
+		unsigned int offset,
+		unsigned int limit,
+		texs__TunnelStats &getTunnelStatsResult);
+
+class texs__AllocatorPoolStat {
+public:
+	std::string pool;
+	long live;
+	long peak;
+	LONG64 failures;
+};
+
+class texs__AllocatorsStat {
+public:
+	//! Empty for process-wide stat.
+	std::wstring ruleUuid;
+	std::list<texs__AllocatorPoolStat> pools;
+};
+
+//gsoap texs service method-action: GetAllocatorsStat "urn:#getAllocatorsStat"
+int texs__GetAllocatorsStat(std::list<texs__AllocatorsStat> &getAllocatorsStatResult);
+
 enum texs__LogLevel {
 	LOG_LEVEL_DEBUG,
 	LOG_LEVEL_INFO,
@@ -92,6 +135,14 @@ int texs__SetLogLevel(
 //gsoap texs service method-action: GetLogLevel "urn:#getLogLevel"
 int texs__GetLogLevel(enum texs__LogLevel &getLogLevelResult);
 
+//gsoap texs service method-action: SetTracing "urn:#setTracing"
+int texs__SetTracing(
+		bool isEnabled,
+		struct texs__SetTracingResult {} *setTracingResult);
+
+//gsoap texs service method-action: GetTrace "urn:#getTrace"
+int texs__GetTrace(std::string &getTraceResult);
+
 //gsoap texs service method-action: Migrate "urn:#migrate"
 int texs__Migrate(bool &migrateResult);
 
@@ -0,0 +1,336 @@
+/**************************************************************************
+ *   Created: 2026/10/20 11:40
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Modules/Inet/InetEndpointAddress.hpp"
+
+#include "Core/Exceptions.hpp"
+
+namespace tex = TunnelEx;
+namespace inet = TunnelEx::Mods::Inet;
+namespace io = boost::asio;
+
+namespace {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	//! Local DNS server which answers A queries from the predefined records.
+	class StubDnsServer : private boost::noncopyable {
+
+	public:
+
+		enum QueryType {
+			QUERY_TYPE_A = 1,
+			QUERY_TYPE_AAAA = 28
+		};
+
+	private:
+
+		typedef std::multimap<std::string, io::ip::address_v4> Records;
+		typedef std::map<std::pair<std::string, unsigned short>, size_t> Queries;
+
+	public:
+
+		StubDnsServer()
+				: m_socket(
+					m_ioService,
+					io::ip::udp::endpoint(io::ip::address_v4::loopback(), 53)) {
+			m_ttl = 60;
+			StartReceive();
+			m_thread = boost::thread(
+				boost::bind(&StubDnsServer::ServiceThreadMain, this));
+		}
+
+		~StubDnsServer() {
+			m_ioService.stop();
+			m_thread.join();
+		}
+
+	public:
+
+		void AddRecord(const std::string &host, const char *address) {
+			const boost::mutex::scoped_lock lock(m_mutex);
+			m_records.insert(
+				std::make_pair(host, io::ip::address_v4::from_string(address)));
+		}
+
+		void RemoveRecords(const std::string &host) {
+			const boost::mutex::scoped_lock lock(m_mutex);
+			m_records.erase(host);
+		}
+
+		void SetTtl(unsigned char ttl) {
+			const boost::mutex::scoped_lock lock(m_mutex);
+			m_ttl = ttl;
+		}
+
+		size_t GetQueriesNumber(const std::string &host, QueryType type) const {
+			const boost::mutex::scoped_lock lock(m_mutex);
+			const Queries::const_iterator pos
+				= m_queries.find(std::make_pair(host, static_cast<unsigned short>(type)));
+			return pos != m_queries.end() ? pos->second : 0;
+		}
+
+	private:
+
+		void ServiceThreadMain() {
+			m_ioService.run();
+		}
+
+		void StartReceive() {
+			m_socket.async_receive_from(
+				io::buffer(m_request),
+				m_remoteEndpoint,
+				boost::bind(
+					&StubDnsServer::HandleReceive,
+					this,
+					io::placeholders::error,
+					io::placeholders::bytes_transferred));
+		}
+
+		void HandleReceive(const boost::system::error_code &error, size_t size) {
+			if (error == io::error::operation_aborted) {
+				return;
+			}
+			if (!error) {
+				std::vector<unsigned char> answer;
+				if (CreateAnswer(size, answer)) {
+					boost::system::error_code sendError;
+					m_socket.send_to(io::buffer(answer), m_remoteEndpoint, 0, sendError);
+				}
+			}
+			StartReceive();
+		}
+
+		bool CreateAnswer(size_t requestSize, std::vector<unsigned char> &result) {
+
+			const size_t headerSize = 12;
+			if (requestSize <= headerSize) {
+				return false;
+			}
+
+			// question: labels, type and class
+			std::string host;
+			size_t pos = headerSize;
+			while (pos < requestSize && m_request[pos] != 0) {
+				const size_t labelSize = m_request[pos++];
+				if (pos + labelSize > requestSize) {
+					return false;
+				}
+				if (!host.empty()) {
+					host.push_back('.');
+				}
+				for (size_t i = 0; i < labelSize; ++i) {
+					host.push_back(
+						char(tolower(static_cast<unsigned char>(m_request[pos + i]))));
+				}
+				pos += labelSize;
+			}
+			if (pos + 5 > requestSize) {
+				return false;
+			}
+			++pos;
+			const unsigned short type
+				= static_cast<unsigned short>((m_request[pos] << 8) | m_request[pos + 1]);
+			pos += 4;
+
+			std::vector<io::ip::address_v4> addresses;
+			unsigned char ttl;
+			{
+				const boost::mutex::scoped_lock lock(m_mutex);
+				ttl = m_ttl;
+				++m_queries[std::make_pair(host, type)];
+				if (type == QUERY_TYPE_A) {
+					const std::pair<Records::const_iterator, Records::const_iterator> range
+						= m_records.equal_range(host);
+					for (Records::const_iterator i = range.first; i != range.second; ++i) {
+						addresses.push_back(i->second);
+					}
+				}
+			}
+			const bool isKnownHost = !addresses.empty() || type != QUERY_TYPE_A;
+
+			result.assign(m_request, m_request + pos);
+			result[2] = 0x81; // response, recursion desired
+			result[3] = isKnownHost ? 0x80 : 0x83; // recursion available, NXDOMAIN
+			result[6] = 0;
+			result[7] = static_cast<unsigned char>(addresses.size());
+			result[8] = result[9] = result[10] = result[11] = 0;
+
+			foreach (const io::ip::address_v4 &address, addresses) {
+				const unsigned char record[] = {
+					0xC0, 0x0C, // name - pointer to the question name
+					0x00, QUERY_TYPE_A,
+					0x00, 0x01, // class IN
+					0x00, 0x00, 0x00, ttl,
+					0x00, 0x04};
+				result.insert(result.end(), record, record + sizeof(record));
+				const io::ip::address_v4::bytes_type bytes = address.to_bytes();
+				result.insert(result.end(), bytes.begin(), bytes.end());
+			}
+
+			return true;
+
+		}
+
+	private:
+
+		mutable boost::mutex m_mutex;
+		Records m_records;
+		Queries m_queries;
+		unsigned char m_ttl;
+
+		io::io_service m_ioService;
+		io::ip::udp::socket m_socket;
+		io::ip::udp::endpoint m_remoteEndpoint;
+		unsigned char m_request[512];
+
+		boost::thread m_thread;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class HostResolver : public testing::Test {
+
+	protected:
+
+		virtual void SetUp() {
+			m_dns.reset(new StubDnsServer);
+			inet::InetEndpointAddress::SetNameServers(
+				std::vector<std::string>(1, "127.0.0.1"));
+		}
+
+		virtual void TearDown() {
+			inet::InetEndpointAddress::SetNameServers(std::vector<std::string>());
+			m_dns.reset();
+		}
+
+	protected:
+
+		//! Unique name for each run, so system DNS cache doesn't answer.
+		static std::string CreateHostName(const char *prefix) {
+			std::ostringstream result;
+			result << prefix << '-' << GetTickCount() << ".tunnelex.test";
+			return result.str();
+		}
+
+		static std::wstring ToWide(const std::string &host) {
+			return std::wstring(host.begin(), host.end());
+		}
+
+	protected:
+
+		std::auto_ptr<StubDnsServer> m_dns;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	TEST_F(HostResolver, ResolvesARecord) {
+		const std::string host = CreateHostName("stub-a");
+		m_dns->AddRecord(host, "10.1.2.3");
+		inet::TcpEndpointAddress address(ToWide(host).c_str(), 8080);
+		ASSERT_NO_THROW(address.GetAceInetAddr());
+		EXPECT_EQ(std::string("10.1.2.3"), address.GetHostAddress());
+		EXPECT_TRUE(address.GetAceInetAddr().get_port_number() == 8080);
+		EXPECT_EQ(1u, m_dns->GetQueriesNumber(host, StubDnsServer::QUERY_TYPE_A));
+		EXPECT_EQ(0u, m_dns->GetQueriesNumber(host, StubDnsServer::QUERY_TYPE_AAAA));
+	}
+
+	TEST_F(HostResolver, UsesCache) {
+		const std::string host = CreateHostName("stub-cache");
+		m_dns->AddRecord(host, "10.1.2.4");
+		{
+			inet::TcpEndpointAddress address(ToWide(host).c_str(), 80);
+			EXPECT_EQ(std::string("10.1.2.4"), address.GetHostAddress());
+		}
+		{
+			inet::UdpEndpointAddress address(ToWide(host).c_str(), 53);
+			EXPECT_EQ(std::string("10.1.2.4"), address.GetHostAddress());
+		}
+		EXPECT_EQ(1u, m_dns->GetQueriesNumber(host, StubDnsServer::QUERY_TYPE_A));
+	}
+
+	TEST_F(HostResolver, SpreadsAddresses) {
+		const std::string host = CreateHostName("stub-spread");
+		m_dns->AddRecord(host, "10.1.2.5");
+		m_dns->AddRecord(host, "10.1.2.6");
+		std::set<std::string> addresses;
+		for (size_t i = 0; i < 4; ++i) {
+			inet::TcpEndpointAddress address(ToWide(host).c_str(), 80);
+			addresses.insert(address.GetHostAddress());
+		}
+		EXPECT_EQ(2u, addresses.size());
+		EXPECT_TRUE(addresses.find("10.1.2.5") != addresses.end());
+		EXPECT_TRUE(addresses.find("10.1.2.6") != addresses.end());
+	}
+
+	TEST_F(HostResolver, UnknownHost) {
+		const std::string host = CreateHostName("stub-unknown");
+		{
+			inet::TcpEndpointAddress address(ToWide(host).c_str(), 80);
+			EXPECT_THROW(address.GetAceInetAddr(), tex::ConnectionOpeningException);
+			// address is not cached as "any" with the real port
+			EXPECT_THROW(address.GetAceInetAddr(), tex::ConnectionOpeningException);
+		}
+		const size_t queriesNumber
+			= m_dns->GetQueriesNumber(host, StubDnsServer::QUERY_TYPE_A);
+		EXPECT_LT(0u, queriesNumber);
+		{
+			// negative caching
+			inet::TcpEndpointAddress address(ToWide(host).c_str(), 80);
+			EXPECT_THROW(address.GetAceInetAddr(), tex::ConnectionOpeningException);
+		}
+		EXPECT_EQ(
+			queriesNumber,
+			m_dns->GetQueriesNumber(host, StubDnsServer::QUERY_TYPE_A));
+	}
+
+	TEST_F(HostResolver, KeepsStaleAddressesAtFailedRefresh) {
+		const std::string host = CreateHostName("stub-stale");
+		m_dns->SetTtl(1);
+		m_dns->AddRecord(host, "10.1.2.7");
+		{
+			inet::TcpEndpointAddress address(ToWide(host).c_str(), 80);
+			EXPECT_EQ(std::string("10.1.2.7"), address.GetHostAddress());
+		}
+		m_dns->RemoveRecords(host);
+		Sleep(2500);
+		{
+			// expired record is used while it is refreshed
+			inet::TcpEndpointAddress address(ToWide(host).c_str(), 80);
+			EXPECT_EQ(std::string("10.1.2.7"), address.GetHostAddress());
+		}
+		for (	size_t i = 0;
+				i < 50 && m_dns->GetQueriesNumber(host, StubDnsServer::QUERY_TYPE_A) < 2;
+				++i) {
+			Sleep(100);
+		}
+		ASSERT_LE(2u, m_dns->GetQueriesNumber(host, StubDnsServer::QUERY_TYPE_A));
+		// failed refresh doesn't replace addresses
+		for (size_t i = 0; i < 10; ++i) {
+			Sleep(100);
+			inet::TcpEndpointAddress address(ToWide(host).c_str(), 80);
+			ASSERT_NO_THROW(address.GetAceInetAddr());
+			EXPECT_EQ(std::string("10.1.2.7"), address.GetHostAddress());
+		}
+	}
+
+	TEST_F(HostResolver, InvalidNameServer) {
+		EXPECT_THROW(
+			inet::InetEndpointAddress::SetNameServers(
+				std::vector<std::string>(1, "dns.local")),
+			tex::LogicalException);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,135 @@
+/**************************************************************************
+ *   Created: 2026/10/20 12:25
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Modules/Inet/HttpProxyAnswerParser.hpp"
+
+namespace inet = TunnelEx::Mods::Inet;
+
+namespace {
+
+	const std::string answer
+		=	"HTTP/1.1 200 Connection established\r\n"
+			"Proxy-Agent: Test/1.0\r\n"
+			"\r\n";
+
+	void Parse(inet::HttpProxyAnswerParser &parser, const std::string &data) {
+		parser.Parse(data.c_str(), data.size());
+	}
+
+	TEST(HttpProxyAnswerParser, Complete) {
+		const std::string data = answer + "tunnel data";
+		inet::HttpProxyAnswerParser parser;
+		EXPECT_EQ(answer.size(), parser.Parse(data.c_str(), data.size()));
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(200u, parser.GetStatusCode());
+		EXPECT_EQ(std::string("Connection established"), parser.GetReason());
+	}
+
+	TEST(HttpProxyAnswerParser, SplitInput) {
+		for (size_t split = 1; split < answer.size(); ++split) {
+			inet::HttpProxyAnswerParser parser;
+			EXPECT_EQ(split, parser.Parse(answer.c_str(), split));
+			EXPECT_FALSE(parser.IsCompleted());
+			EXPECT_EQ(
+				answer.size() - split,
+				parser.Parse(answer.c_str() + split, answer.size() - split));
+			ASSERT_TRUE(parser.IsCompleted());
+			EXPECT_EQ(200u, parser.GetStatusCode());
+			EXPECT_EQ(std::string("Connection established"), parser.GetReason());
+		}
+	}
+
+	TEST(HttpProxyAnswerParser, ByteByByte) {
+		inet::HttpProxyAnswerParser parser;
+		foreach (const char ch, answer) {
+			EXPECT_FALSE(parser.IsCompleted());
+			EXPECT_EQ(1u, parser.Parse(&ch, 1));
+		}
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(200u, parser.GetStatusCode());
+	}
+
+	TEST(HttpProxyAnswerParser, CaseInsensitive) {
+		inet::HttpProxyAnswerParser parser;
+		Parse(parser, "http/1.0 407 Proxy Authentication Required\r\n\r\n");
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(407u, parser.GetStatusCode());
+		EXPECT_EQ(
+			std::string("Proxy Authentication Required"),
+			parser.GetReason());
+		parser.Reset();
+		Parse(parser, "HtTp/1.1 200 OK\r\n\r\n");
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(200u, parser.GetStatusCode());
+	}
+
+	TEST(HttpProxyAnswerParser, WithoutReason) {
+		inet::HttpProxyAnswerParser parser;
+		Parse(parser, "HTTP/1.0 200\r\n\r\n");
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(200u, parser.GetStatusCode());
+		EXPECT_TRUE(parser.GetReason().empty());
+	}
+
+	TEST(HttpProxyAnswerParser, BareLineFeeds) {
+		inet::HttpProxyAnswerParser parser;
+		Parse(parser, "HTTP/1.0 200 OK\nProxy-Agent: Test/1.0\n");
+		EXPECT_FALSE(parser.IsCompleted());
+		Parse(parser, "\r\n\r\n");
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(std::string("OK"), parser.GetReason());
+	}
+
+	TEST(HttpProxyAnswerParser, LongReason) {
+		const std::string reason(1024, 'x');
+		inet::HttpProxyAnswerParser parser;
+		Parse(parser, "HTTP/1.1 502 " + reason + "\r\n\r\n");
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(502u, parser.GetStatusCode());
+		EXPECT_GT(reason.size(), parser.GetReason().size());
+		EXPECT_EQ(0u, reason.find(parser.GetReason()));
+	}
+
+	TEST(HttpProxyAnswerParser, Reset) {
+		inet::HttpProxyAnswerParser parser;
+		Parse(parser, "HTTP/1.1 407 Denied\r\n\r\n");
+		ASSERT_TRUE(parser.IsCompleted());
+		parser.Reset();
+		EXPECT_FALSE(parser.IsCompleted());
+		Parse(parser, answer);
+		ASSERT_TRUE(parser.IsCompleted());
+		EXPECT_EQ(200u, parser.GetStatusCode());
+		EXPECT_EQ(std::string("Connection established"), parser.GetReason());
+	}
+
+	TEST(HttpProxyAnswerParser, Malformed) {
+		const char *const answers[] = {
+			"HTTX/1.1 200 OK\r\n\r\n",
+			"HTTP 200 OK\r\n\r\n",
+			"HTTP/1x1 200 OK\r\n\r\n",
+			"HTTP/a.1 200 OK\r\n\r\n",
+			"HTTP/1.1 OK\r\n\r\n",
+			"HTTP/1.1 2x0 OK\r\n\r\n",
+			"HTTP/1.1 \r\n\r\n",
+			"HTTP/1.1 1234567890 OK\r\n\r\n",
+			"\xC8TTP/1.1 200 OK\r\n\r\n",
+			"HTTP/1.1 200\xFF OK\r\n\r\n",
+			"<html>\r\n\r\n"
+		};
+		foreach (const char *const data, answers) {
+			inet::HttpProxyAnswerParser parser;
+			EXPECT_THROW(Parse(parser, data), inet::ProxyWorkingException)
+				<< "Answer: \"" << data << "\"";
+			EXPECT_FALSE(parser.IsCompleted());
+		}
+	}
+
+}
@@ -27,6 +27,7 @@
 
 #include "CompileWarningsBoost.h"
 #	include <boost/shared_ptr.hpp>
+#	include <boost/array.hpp>
 #	include <boost/function.hpp>
 #	include <boost/bind.hpp>
 #	include <boost/foreach.hpp>
@@ -0,0 +1,374 @@
+/**************************************************************************
+ *   Created: 2026/10/20 16:40
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Core/RuleSetJournal.hpp"
+#include "Core/Rule.hpp"
+#include "Core/String.hpp"
+
+namespace tex = TunnelEx;
+namespace fs = boost::filesystem;
+
+namespace {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const wchar_t *const firstUuid = L"AC055577-E705-4805-BAE9-D16D522DB721";
+	const wchar_t *const secondUuid = L"AC055577-E705-4805-BAE9-D16D522DB722";
+	const wchar_t *const thirdUuid = L"AC055577-E705-4805-BAE9-D16D522DB723";
+
+	void AppendRuleXml(
+				const wchar_t *uuid,
+				const wchar_t *name,
+				std::wostringstream &xml) {
+		// endpoint UUIDs differ from the rule UUID by the first symbol
+		const std::wstring uuidTail = uuid + 1;
+		xml
+			<< L"<TunnelRule Name=\"" << name << L"\" Uuid=\"" << uuid << L"\" ErrorsTreatment=\"error\" IsEnabled=\"true\">"
+			<< L"	<FilterSet />"
+			<< L"	<InputSet>"
+			<< L"		<Endpoint Uuid=\"1" << uuidTail << L"\">"
+			<< L"			<CombinedAddress ResourceIdentifier=\"tcp://*:755\" IsAcceptor=\"true\" />"
+			<< L"		</Endpoint>"
+			<< L"	</InputSet>"
+			<< L"	<DestinationSet>"
+			<< L"		<Endpoint Uuid=\"2" << uuidTail << L"\">"
+			<< L"			<CombinedAddress ResourceIdentifier=\"tcp://212.213.214.3:80\" />"
+			<< L"		</Endpoint>"
+			<< L"	</DestinationSet>"
+			<< L"</TunnelRule>";
+	}
+
+	//! Creates rule set with one or two tunnel rules.
+	tex::RuleSet CreateRuleSet(
+				const wchar_t *uuid,
+				const wchar_t *name,
+				const wchar_t *uuid2 = 0,
+				const wchar_t *name2 = 0) {
+		std::wostringstream xml;
+		xml
+			<< L"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+			<< L"<RuleSet Version=\"2.1\">";
+		AppendRuleXml(uuid, name, xml);
+		if (uuid2) {
+			AppendRuleXml(uuid2, name2, xml);
+		}
+		xml << L"</RuleSet>";
+		return tex::RuleSet(xml.str().c_str());
+	}
+
+	std::wstring GetXml(const tex::RuleSet &ruleSet) {
+		tex::WString result;
+		ruleSet.GetXml(result, false);
+		return result.GetCStr();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class RuleSetJournal : public testing::Test {
+
+	protected:
+
+		virtual void SetUp() {
+			m_filePath
+				= tex::Helpers::GetModuleFilePath().branch_path()
+					/ L"RuleSetJournalTest.journal";
+			m_compactionFilePath
+				= fs::wpath(m_filePath.string() + L".compaction");
+			RemoveFiles();
+		}
+
+		virtual void TearDown() {
+			RemoveFiles();
+		}
+
+	protected:
+
+		tex::WString GetFilePath() const {
+			return m_filePath.string().c_str();
+		}
+
+		bool IsCompactionFileExists() const {
+			return fs::exists(m_compactionFilePath);
+		}
+
+		size_t Replay(tex::RuleSet &result) const {
+			return tex::RuleSetJournal::Replay(GetFilePath(), result);
+		}
+
+		//! Appends update, disabling and deletion records.
+		void AppendRecords(tex::RuleSetJournal &journal) const {
+			journal.AppendUpdate(
+				CreateRuleSet(secondUuid, L"Changed second", thirdUuid, L"Third"));
+			journal.AppendEnable(thirdUuid, false);
+			journal.AppendDelete(firstUuid);
+			journal.Flush();
+		}
+
+		//! Checks rule set after records from AppendRecords.
+		void CheckRecordsApplied(const tex::RuleSet &ruleSet) const {
+			const tex::TunnelRuleSet &tunnels = ruleSet.GetTunnels();
+			ASSERT_EQ(2u, tunnels.GetSize());
+			EXPECT_TRUE(tunnels[0].GetUuid() == secondUuid);
+			EXPECT_TRUE(tunnels[0].GetName() == L"Changed second");
+			EXPECT_TRUE(tunnels[0].IsEnabled());
+			EXPECT_TRUE(tunnels[1].GetUuid() == thirdUuid);
+			EXPECT_TRUE(tunnels[1].GetName() == L"Third");
+			EXPECT_FALSE(tunnels[1].IsEnabled());
+		}
+
+		void ReadFile(std::vector<char> &result) const {
+			std::ifstream file(m_filePath.string().c_str(), std::ios::binary);
+			ASSERT_TRUE(file ? true : false);
+			result.assign(
+				std::istreambuf_iterator<char>(file),
+				std::istreambuf_iterator<char>());
+		}
+
+		void WriteFile(const std::vector<char> &data) const {
+			std::ofstream file(
+				m_filePath.string().c_str(),
+				std::ios::binary | std::ios::trunc);
+			ASSERT_TRUE(file ? true : false);
+			file.write(&data[0], data.size());
+		}
+
+	private:
+
+		void RemoveFiles() {
+			fs::remove(m_filePath);
+			fs::remove(m_compactionFilePath);
+		}
+
+	private:
+
+		fs::wpath m_filePath;
+		fs::wpath m_compactionFilePath;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	TEST_F(RuleSetJournal, ReplayNotExisting) {
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First");
+		const std::wstring xml = GetXml(ruleSet);
+		EXPECT_EQ(0u, Replay(ruleSet));
+		EXPECT_EQ(xml, GetXml(ruleSet));
+	}
+
+	TEST_F(RuleSetJournal, Replay) {
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			EXPECT_EQ(0u, journal.GetSize());
+			AppendRecords(journal);
+			EXPECT_LT(0u, journal.GetSize());
+		}
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+		EXPECT_EQ(3u, Replay(ruleSet));
+		CheckRecordsApplied(ruleSet);
+	}
+
+	TEST_F(RuleSetJournal, ReplayWhileOpened) {
+		tex::RuleSetJournal journal(GetFilePath());
+		AppendRecords(journal);
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+		EXPECT_EQ(3u, Replay(ruleSet));
+		CheckRecordsApplied(ruleSet);
+	}
+
+	TEST_F(RuleSetJournal, Reopen) {
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			journal.AppendUpdate(CreateRuleSet(secondUuid, L"Changed second"));
+			journal.Flush();
+		}
+		unsigned long long size = 0;
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			size = journal.GetSize();
+			EXPECT_LT(0u, size);
+			journal.AppendUpdate(CreateRuleSet(thirdUuid, L"Third"));
+			journal.AppendEnable(thirdUuid, false);
+			journal.AppendDelete(firstUuid);
+			journal.Flush();
+			EXPECT_LT(size, journal.GetSize());
+		}
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+		EXPECT_EQ(4u, Replay(ruleSet));
+		CheckRecordsApplied(ruleSet);
+	}
+
+	TEST_F(RuleSetJournal, IdempotentReapply) {
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			AppendRecords(journal);
+		}
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+		EXPECT_EQ(3u, Replay(ruleSet));
+		const std::wstring xml = GetXml(ruleSet);
+		// rule set already has all changes, as after saving without journal cleaning
+		EXPECT_EQ(3u, Replay(ruleSet));
+		EXPECT_EQ(xml, GetXml(ruleSet));
+		CheckRecordsApplied(ruleSet);
+	}
+
+	TEST_F(RuleSetJournal, UnknownRules) {
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			journal.AppendEnable(thirdUuid, false);
+			journal.AppendDelete(thirdUuid);
+			journal.Flush();
+		}
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First");
+		const std::wstring xml = GetXml(ruleSet);
+		EXPECT_EQ(2u, Replay(ruleSet));
+		EXPECT_EQ(xml, GetXml(ruleSet));
+	}
+
+	TEST_F(RuleSetJournal, TornFinalRecord) {
+
+		unsigned long long firstRecordsSize = 0;
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			journal.AppendUpdate(
+				CreateRuleSet(secondUuid, L"Changed second", thirdUuid, L"Third"));
+			journal.AppendEnable(thirdUuid, false);
+			firstRecordsSize = journal.GetSize();
+			journal.AppendDelete(firstUuid);
+			journal.Flush();
+		}
+
+		std::vector<char> data;
+		ReadFile(data);
+		ASSERT_LT(firstRecordsSize, data.size());
+
+		tex::RuleSet expected = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+		WriteFile(std::vector<char>(data.begin(), data.begin() + size_t(firstRecordsSize)));
+		ASSERT_EQ(2u, Replay(expected));
+		const std::wstring expectedXml = GetXml(expected);
+
+		// each possible size of the partially written last record
+		for (size_t size = size_t(firstRecordsSize) + 1; size < data.size(); ++size) {
+			WriteFile(std::vector<char>(data.begin(), data.begin() + size));
+			tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+			EXPECT_EQ(2u, Replay(ruleSet)) << "Size: " << size;
+			EXPECT_EQ(expectedXml, GetXml(ruleSet)) << "Size: " << size;
+		}
+
+		{
+			// damaged last record of full size
+			std::vector<char> damaged = data;
+			damaged.back() ^= 0x01;
+			WriteFile(damaged);
+			tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+			EXPECT_EQ(2u, Replay(ruleSet));
+			EXPECT_EQ(expectedXml, GetXml(ruleSet));
+		}
+
+	}
+
+	TEST_F(RuleSetJournal, AppendAfterTornRecord) {
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			journal.AppendUpdate(
+				CreateRuleSet(secondUuid, L"Changed second", thirdUuid, L"Third"));
+			journal.Flush();
+		}
+		std::vector<char> data;
+		ReadFile(data);
+		const size_t validSize = data.size();
+		// partially written record header and data
+		data.insert(data.end(), 7, char(0x7F));
+		WriteFile(data);
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			EXPECT_EQ(validSize, journal.GetSize());
+			journal.AppendEnable(thirdUuid, false);
+			journal.AppendDelete(firstUuid);
+			journal.Flush();
+		}
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+		EXPECT_EQ(3u, Replay(ruleSet));
+		CheckRecordsApplied(ruleSet);
+	}
+
+	TEST_F(RuleSetJournal, Compaction) {
+
+		tex::RuleSetJournal journal(GetFilePath());
+		journal.AppendUpdate(
+			CreateRuleSet(secondUuid, L"Changed second", thirdUuid, L"Third"));
+		journal.Flush();
+
+		journal.StartCompaction();
+		EXPECT_EQ(0u, journal.GetSize());
+		EXPECT_TRUE(IsCompactionFileExists());
+
+		// records appended while the owner saves full rule set
+		journal.AppendEnable(thirdUuid, false);
+		journal.AppendDelete(firstUuid);
+		journal.Flush();
+
+		{
+			// compaction records are replayed first
+			tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+			EXPECT_EQ(3u, Replay(ruleSet));
+			CheckRecordsApplied(ruleSet);
+		}
+
+		journal.CompleteCompaction();
+		EXPECT_FALSE(IsCompactionFileExists());
+
+		{
+			// full rule set has been saved with the compacted records
+			tex::RuleSet ruleSet = CreateRuleSet(
+				firstUuid, L"First",
+				secondUuid, L"Changed second");
+			ruleSet.GetTunnels().Append(
+				CreateRuleSet(thirdUuid, L"Third").GetTunnels()[0]);
+			EXPECT_EQ(2u, Replay(ruleSet));
+			CheckRecordsApplied(ruleSet);
+		}
+
+		journal.StartCompaction();
+		EXPECT_EQ(0u, journal.GetSize());
+		journal.CompleteCompaction();
+		// empty journal doesn't create compaction file
+		journal.StartCompaction();
+		EXPECT_FALSE(IsCompactionFileExists());
+		journal.CompleteCompaction();
+
+	}
+
+	TEST_F(RuleSetJournal, InterruptedCompaction) {
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			journal.AppendUpdate(
+				CreateRuleSet(secondUuid, L"Changed second", thirdUuid, L"Third"));
+			journal.Flush();
+			journal.StartCompaction();
+			// full rule set is not saved, compaction is not completed
+		}
+		{
+			tex::RuleSetJournal journal(GetFilePath());
+			journal.AppendEnable(thirdUuid, false);
+			journal.Flush();
+			journal.StartCompaction();
+			journal.AppendDelete(firstUuid);
+			journal.Flush();
+		}
+		EXPECT_TRUE(IsCompactionFileExists());
+		tex::RuleSet ruleSet = CreateRuleSet(firstUuid, L"First", secondUuid, L"Second");
+		EXPECT_EQ(3u, Replay(ruleSet));
+		CheckRecordsApplied(ruleSet);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,356 @@
+/**************************************************************************
+ *   Created: 2026/10/20 16:05
+ *    Author: Eugene V. Palchukovsky
+ *    E-mail: eugene@palchukovsky.com
+ * -------------------------------------------------------------------
+ *   Project: TunnelEx
+ *       URL: http://tunnelex.net
+ **************************************************************************/
+
+#include "Prec.h"
+
+#include "Core/RuleSetSnapshot.hpp"
+#include "Core/Rule.hpp"
+#include "Core/String.hpp"
+
+namespace tex = TunnelEx;
+namespace fs = boost::filesystem;
+
+namespace {
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const wchar_t *const ruleSetXml
+		=	L"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+			L"<RuleSet Version=\"2.1\">"
+			L"	<ServiceRule Name=\"Service rule\" Uuid=\"12355577-E705-4805-BAE9-D16D522DB726\" ErrorsTreatment=\"error\" IsEnabled=\"true\">"
+			L"		<Service Name=\"Service name\" Uuid=\"43215577-E705-4805-BAE9-D16D522DB726\">1234567</Service>"
+			L"		<Service Name=\"Service without param\" Uuid=\"41233333-3344-4805-BAE9-D16D522DB726\" />"
+			L"	</ServiceRule>"
+			L"	<TunnelRule Name=\"Combined rule\" Uuid=\"AC055577-E705-4805-BAE9-D16D522DB726\" ErrorsTreatment=\"warning\" IsEnabled=\"false\">"
+			L"		<FilterSet>"
+			L"			<Filter Name=\"some filter name\" />"
+			L"		</FilterSet>"
+			L"		<InputSet>"
+			L"			<Endpoint Uuid=\"AC055577-E705-480a-BAE9-D11D522DB726\">"
+			L"				<PreListener Name=\"PreListener\">Pre listener param</PreListener>"
+			L"				<PostListener Name=\"PostListener\">Post listener param</PostListener>"
+			L"				<CombinedAddress ResourceIdentifier=\"tcp://*:755\" IsAcceptor=\"true\" />"
+			L"			</Endpoint>"
+			L"		</InputSet>"
+			L"		<DestinationSet>"
+			L"			<Endpoint Uuid=\"AC055577-E705-480a-BAE9-D13D522DB726\">"
+			L"				<CombinedAddress ResourceIdentifier=\"tcp://212.213.214.3:80\" />"
+			L"			</Endpoint>"
+			L"		</DestinationSet>"
+			L"	</TunnelRule>"
+			L"	<TunnelRule Name=\"Split rule\" Uuid=\"AC055577-E705-480a-BAE9-D16D522DB727\" ErrorsTreatment=\"information\" IsEnabled=\"true\">"
+			L"		<FilterSet />"
+			L"		<InputSet>"
+			L"			<Endpoint Uuid=\"AC055577-E705-480a-BAE9-D15D522DB726\">"
+			L"				<SplitAddress Acceptor=\"reader\" ReadResourceIdentifier=\"tcp://*:234\" WriteResourceIdentifier=\"tcp://zx:233\" />"
+			L"			</Endpoint>"
+			L"		</InputSet>"
+			L"		<DestinationSet>"
+			L"			<Endpoint Uuid=\"AC055577-E705-4809-BAE9-D16D522DB726\">"
+			L"				<SplitAddress ReadResourceIdentifier=\"tcp://212.213.214.5:80\" WriteResourceIdentifier=\"tcp://212.213.214.9:81\" />"
+			L"			</Endpoint>"
+			L"		</DestinationSet>"
+			L"	</TunnelRule>"
+			L"</RuleSet>";
+
+	//! Rule set which should stay untouched by failed loading.
+	const wchar_t *const otherRuleSetXml
+		=	L"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+			L"<RuleSet Version=\"2.1\">"
+			L"	<ServiceRule Name=\"Other rule\" Uuid=\"99955577-E705-4805-BAE9-D16D522DB726\" ErrorsTreatment=\"warning\" IsEnabled=\"true\">"
+			L"		<Service Name=\"Other service\" Uuid=\"99915577-E705-4805-BAE9-D16D522DB726\">param</Service>"
+			L"	</ServiceRule>"
+			L"</RuleSet>";
+
+	std::wstring GetXml(const tex::RuleSet &ruleSet) {
+		tex::WString result;
+		ruleSet.GetXml(result, false);
+		return result.GetCStr();
+	}
+
+	std::vector<char> Serialize(const tex::RuleSet &ruleSet) {
+		std::vector<char> result;
+		tex::RuleSetSnapshot::Serialize(ruleSet, result);
+		return result;
+	}
+
+	//! Returns offset of the first service rule errors treatment.
+	size_t GetFirstErrorsTreatmentOffset() {
+		const size_t uuidLength = 36;
+		const size_t nameLength = wcslen(L"Service rule");
+		return
+			sizeof(unsigned long) // service rules number
+			+ sizeof(unsigned long) + (uuidLength + 1) * sizeof(wchar_t)
+			+ sizeof(unsigned long) + (nameLength + 1) * sizeof(wchar_t);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	TEST(RuleSetSnapshot, RoundTrip) {
+		const tex::RuleSet original(ruleSetXml);
+		const std::vector<char> data = Serialize(original);
+		ASSERT_FALSE(data.empty());
+		tex::RuleSet restored;
+		ASSERT_TRUE(
+			tex::RuleSetSnapshot::Deserialize(&data[0], data.size(), restored));
+		EXPECT_EQ(GetXml(original), GetXml(restored));
+		ASSERT_EQ(1u, restored.GetServices().GetSize());
+		ASSERT_EQ(2u, restored.GetTunnels().GetSize());
+		EXPECT_TRUE(restored.GetTunnels()[1].GetName() == L"Split rule");
+		EXPECT_TRUE(
+			restored.GetTunnels()[1].GetErrorsTreatment()
+				== tex::Rule::ERRORS_TREATMENT_INFO);
+		ASSERT_EQ(1u, restored.GetTunnels()[1].GetInputs().GetSize());
+		EXPECT_TRUE(
+			restored.GetTunnels()[1].GetInputs()[0].GetReadWriteAcceptor()
+				== tex::Endpoint::ACCEPTOR_READER);
+		// same data from the restored rule set
+		EXPECT_TRUE(data == Serialize(restored));
+	}
+
+	TEST(RuleSetSnapshot, RoundTripEmpty) {
+		const std::vector<char> data = Serialize(tex::RuleSet());
+		tex::RuleSet restored(otherRuleSetXml);
+		ASSERT_TRUE(
+			tex::RuleSetSnapshot::Deserialize(&data[0], data.size(), restored));
+		EXPECT_EQ(0u, restored.GetServices().GetSize());
+		EXPECT_EQ(0u, restored.GetTunnels().GetSize());
+	}
+
+	TEST(RuleSetSnapshot, Truncated) {
+		const std::vector<char> data = Serialize(tex::RuleSet(ruleSetXml));
+		tex::RuleSet result(otherRuleSetXml);
+		const std::wstring resultXml = GetXml(result);
+		for (size_t size = 0; size < data.size(); ++size) {
+			EXPECT_FALSE(
+					tex::RuleSetSnapshot::Deserialize(&data[0], size, result))
+				<< "Size: " << size;
+		}
+		EXPECT_EQ(resultXml, GetXml(result));
+	}
+
+	TEST(RuleSetSnapshot, TrailingData) {
+		std::vector<char> data = Serialize(tex::RuleSet(ruleSetXml));
+		data.push_back(0);
+		tex::RuleSet result(otherRuleSetXml);
+		const std::wstring resultXml = GetXml(result);
+		EXPECT_FALSE(
+			tex::RuleSetSnapshot::Deserialize(&data[0], data.size(), result));
+		EXPECT_EQ(resultXml, GetXml(result));
+	}
+
+	TEST(RuleSetSnapshot, Corrupted) {
+
+		const std::vector<char> original = Serialize(tex::RuleSet(ruleSetXml));
+		tex::RuleSet result(otherRuleSetXml);
+		const std::wstring resultXml = GetXml(result);
+
+		{
+			// rule set size more than data could contain
+			std::vector<char> data = original;
+			data[sizeof(unsigned long) - 1] = char(0x7F);
+			EXPECT_FALSE(
+				tex::RuleSetSnapshot::Deserialize(&data[0], data.size(), result));
+		}
+
+		{
+			// string without terminating zero
+			std::vector<char> data = original;
+			const size_t uuidEnd = sizeof(unsigned long) * 2 + 36 * sizeof(wchar_t);
+			data[uuidEnd] = 'x';
+			EXPECT_FALSE(
+				tex::RuleSetSnapshot::Deserialize(&data[0], data.size(), result));
+		}
+
+		{
+			// zero inside string
+			std::vector<char> data = original;
+			memset(&data[sizeof(unsigned long) * 2], 0, sizeof(wchar_t));
+			EXPECT_FALSE(
+				tex::RuleSetSnapshot::Deserialize(&data[0], data.size(), result));
+		}
+
+		{
+			// unknown errors treatment
+			std::vector<char> data = original;
+			const size_t offset = GetFirstErrorsTreatmentOffset();
+			ASSERT_EQ(
+				char(tex::Rule::ERRORS_TREATMENT_ERROR),
+				data[offset]);
+			data[offset] = char(0xFF);
+			EXPECT_FALSE(
+				tex::RuleSetSnapshot::Deserialize(&data[0], data.size(), result));
+		}
+
+		EXPECT_EQ(resultXml, GetXml(result));
+
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class RuleSetSnapshotFile : public testing::Test {
+
+	protected:
+
+		virtual void SetUp() {
+			const fs::wpath dir = tex::Helpers::GetModuleFilePath().branch_path();
+			m_xmlFilePath = dir / L"RuleSetSnapshotTest.xml";
+			m_snapshotFilePath = dir / L"RuleSetSnapshotTest.snapshot";
+			RemoveFiles();
+			WriteXmlFile(ruleSetXml);
+		}
+
+		virtual void TearDown() {
+			RemoveFiles();
+		}
+
+	protected:
+
+		tex::WString GetXmlFilePath() const {
+			return m_xmlFilePath.string().c_str();
+		}
+
+		tex::WString GetSnapshotFilePath() const {
+			return m_snapshotFilePath.string().c_str();
+		}
+
+		void WriteXmlFile(const wchar_t *xml) const {
+			std::ofstream file(m_xmlFilePath.string().c_str(), std::ios::trunc);
+			ASSERT_TRUE(file ? true : false);
+			file << tex::ConvertString<tex::String>(tex::WString(xml)).GetCStr();
+		}
+
+		void ReadSnapshotFile(std::vector<char> &result) const {
+			std::ifstream file(
+				m_snapshotFilePath.string().c_str(),
+				std::ios::binary);
+			ASSERT_TRUE(file ? true : false);
+			result.assign(
+				std::istreambuf_iterator<char>(file),
+				std::istreambuf_iterator<char>());
+		}
+
+		void WriteSnapshotFile(const std::vector<char> &data) const {
+			std::ofstream file(
+				m_snapshotFilePath.string().c_str(),
+				std::ios::binary | std::ios::trunc);
+			ASSERT_TRUE(file ? true : false);
+			file.write(&data[0], data.size());
+		}
+
+		bool Load(tex::RuleSet &result) const {
+			return tex::RuleSetSnapshot::Load(
+				GetXmlFilePath(),
+				GetSnapshotFilePath(),
+				result);
+		}
+
+	private:
+
+		void RemoveFiles() {
+			fs::remove(m_xmlFilePath);
+			fs::remove(m_snapshotFilePath);
+			fs::remove(fs::wpath(m_snapshotFilePath.string() + L".tmp"));
+		}
+
+	private:
+
+		fs::wpath m_xmlFilePath;
+		fs::wpath m_snapshotFilePath;
+
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	TEST_F(RuleSetSnapshotFile, SaveAndLoad) {
+		const tex::RuleSet original(ruleSetXml);
+		tex::RuleSetSnapshot::Save(original, GetXmlFilePath(), GetSnapshotFilePath());
+		EXPECT_FALSE(fs::exists(fs::wpath(GetSnapshotFilePath().GetCStr() + std::wstring(L".tmp"))));
+		tex::RuleSet restored;
+		ASSERT_TRUE(Load(restored));
+		EXPECT_EQ(GetXml(original), GetXml(restored));
+	}
+
+	TEST_F(RuleSetSnapshotFile, NotExists) {
+		tex::RuleSet result(otherRuleSetXml);
+		const std::wstring resultXml = GetXml(result);
+		EXPECT_FALSE(Load(result));
+		EXPECT_EQ(resultXml, GetXml(result));
+	}
+
+	TEST_F(RuleSetSnapshotFile, Stale) {
+		tex::RuleSetSnapshot::Save(
+			tex::RuleSet(ruleSetXml),
+			GetXmlFilePath(),
+			GetSnapshotFilePath());
+		WriteXmlFile(otherRuleSetXml);
+		tex::RuleSet result(otherRuleSetXml);
+		const std::wstring resultXml = GetXml(result);
+		EXPECT_FALSE(Load(result));
+		EXPECT_EQ(resultXml, GetXml(result));
+	}
+
+	TEST_F(RuleSetSnapshotFile, Truncated) {
+		tex::RuleSetSnapshot::Save(
+			tex::RuleSet(ruleSetXml),
+			GetXmlFilePath(),
+			GetSnapshotFilePath());
+		std::vector<char> original;
+		ReadSnapshotFile(original);
+		ASSERT_LT(40u, original.size());
+		tex::RuleSet result(otherRuleSetXml);
+		const std::wstring resultXml = GetXml(result);
+		const size_t sizes[] = {1, 39, 40, 41, original.size() - 1};
+		foreach (const size_t size, sizes) {
+			WriteSnapshotFile(std::vector<char>(original.begin(), original.begin() + size));
+			EXPECT_FALSE(Load(result)) << "Size: " << size;
+		}
+		EXPECT_EQ(resultXml, GetXml(result));
+	}
+
+	TEST_F(RuleSetSnapshotFile, Corrupted) {
+		tex::RuleSetSnapshot::Save(
+			tex::RuleSet(ruleSetXml),
+			GetXmlFilePath(),
+			GetSnapshotFilePath());
+		std::vector<char> original;
+		ReadSnapshotFile(original);
+		ASSERT_LT(40u, original.size());
+		tex::RuleSet result(otherRuleSetXml);
+		const std::wstring resultXml = GetXml(result);
+		{
+			// data damage, detected by checksum
+			std::vector<char> data = original;
+			data[original.size() / 2 + 20] ^= 0x01;
+			WriteSnapshotFile(data);
+			EXPECT_FALSE(Load(result));
+		}
+		{
+			// signature
+			std::vector<char> data = original;
+			data[0] = 'X';
+			WriteSnapshotFile(data);
+			EXPECT_FALSE(Load(result));
+		}
+		{
+			// format version
+			std::vector<char> data = original;
+			++data[8];
+			WriteSnapshotFile(data);
+			EXPECT_FALSE(Load(result));
+		}
+		EXPECT_EQ(resultXml, GetXml(result));
+		// valid snapshot still loads after all
+		WriteSnapshotFile(original);
+		EXPECT_TRUE(Load(result));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+}
@@ -112,4 +112,63 @@ namespace {
 		EXPECT_TRUE(queryResult[0]->GetContent(buffer) == "started");
 	}
 
+	TEST(ServiceConfiguration, NameServers) {
+		fs::wpath configurationFile
+			= tex::Helpers::GetModuleFilePath().branch_path();
+		configurationFile /= L"DefaultServiceConfigurationTest.xml";
+		if (fs::exists(configurationFile)) {
+			ASSERT_TRUE(fs::remove(configurationFile));
+		}
+		{
+			boost::shared_ptr<::ServiceConfiguration> defaultConf(::ServiceConfiguration::GetDefault());
+			EXPECT_TRUE(defaultConf->GetNameServers().empty());
+			ASSERT_TRUE(defaultConf->Save(configurationFile.string().c_str()));
+		}
+		std::vector<std::string> servers;
+		servers.push_back("127.0.0.1");
+		servers.push_back("192.168.0.254");
+		{
+			::ServiceConfiguration configuration(configurationFile.string().c_str());
+			EXPECT_THROW(
+				configuration.SetNameServers(std::vector<std::string>(1, "256.0.0.1")),
+				::ServiceConfiguration::ConfigurationHasInvalidFormatException);
+			EXPECT_THROW(
+				configuration.SetNameServers(std::vector<std::string>(1, "dns.local")),
+				::ServiceConfiguration::ConfigurationHasInvalidFormatException);
+			EXPECT_TRUE(configuration.GetNameServers().empty());
+			EXPECT_NO_THROW(configuration.SetNameServers(servers));
+			EXPECT_TRUE(configuration.GetNameServers() == servers);
+			configuration.Save(configurationFile.string().c_str());
+		}
+		::ServiceConfiguration configuration(configurationFile.string().c_str());
+		EXPECT_TRUE(configuration.GetNameServers() == servers);
+	}
+
+	TEST(ServiceConfiguration, SslAesGcmPreference) {
+		fs::wpath configurationFile
+			= tex::Helpers::GetModuleFilePath().branch_path();
+		configurationFile /= L"DefaultServiceConfigurationTest.xml";
+		if (fs::exists(configurationFile)) {
+			ASSERT_TRUE(fs::remove(configurationFile));
+		}
+		{
+			boost::shared_ptr<::ServiceConfiguration> defaultConf(::ServiceConfiguration::GetDefault());
+			EXPECT_FALSE(defaultConf->IsSslAesGcmPreferred());
+			ASSERT_TRUE(defaultConf->Save(configurationFile.string().c_str()));
+		}
+		{
+			::ServiceConfiguration configuration(configurationFile.string().c_str());
+			EXPECT_FALSE(configuration.IsSslAesGcmPreferred());
+			EXPECT_NO_THROW(configuration.SetSslAesGcmPreference(true));
+			EXPECT_TRUE(configuration.IsSslAesGcmPreferred());
+			configuration.Save(configurationFile.string().c_str());
+		}
+		{
+			::ServiceConfiguration configuration(configurationFile.string().c_str());
+			EXPECT_TRUE(configuration.IsSslAesGcmPreferred());
+			EXPECT_NO_THROW(configuration.SetSslAesGcmPreference(false));
+			EXPECT_FALSE(configuration.IsSslAesGcmPreferred());
+		}
+	}
+
 }